@@ -6,6 +6,9 @@
 #include <boot/multiboot2.h>
 #include <debug/debug.h>
 #include <util/string.h>
+#include <memory/memory.h>
+#include <memory/bootmem.h>
+#include <memory/pmm.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -15,6 +18,7 @@
  * - Checksum doğrulaması yap
  * - XSDT (>=v2) varsa onu, yoksa RSDT'yi tara
  * - İlgi çekici tabloları (MADT/FADT/HPET/MCFG) bul ve adreslerini logla
+ * - Tabloları (DSDT dahil) bootmem'e kopyala ve ACPI_RECLAIMABLE belleği PMM'e ver
  * Not: Bu aşamada fiziksel->sanal eşleme yardımı yok; düşük bellek alanlarının
  *      kimlik eşlendiğini (identity map) varsayıyoruz.
  */
@@ -118,6 +122,85 @@ static void acpi_scan_rsdt_xsdt(const acpi_sdt_header* root, acpi_found_tables*
 	}
 }
 
+/* Tabloyu bootmem'e kopyalar; min_len'den kısa tabloların kalanı sıfırlanır */
+static acpi_sdt_header* acpi_copy_table(const acpi_sdt_header* hdr, size_t min_len)
+{
+	size_t len = hdr->Length > min_len ? hdr->Length : min_len;
+	uint8_t* copy = (uint8_t*)bootmem_alloc(len, 16);
+	if (!copy) return NULL;
+	memcpy(copy, hdr, hdr->Length);
+	if (len > hdr->Length) memset(copy + hdr->Length, 0, len - hdr->Length);
+	return (acpi_sdt_header*)copy;
+}
+
+static void acpi_fix_checksum(acpi_sdt_header* hdr)
+{
+	hdr->Checksum = 0;
+	hdr->Checksum = (uint8_t)(0x100 - acpi_checksum8(hdr, hdr->Length));
+}
+
+/*
+ * Kök tabloyu, gösterdiği tüm tabloları ve FADT'nin DSDT'sini kopyalar; kopyadaki
+ * işaretçiler kopyaları gösterir. Başarılı olursa orijinallere bir daha dokunulmaz
+ * ve ACPI_RECLAIMABLE bölgeler boş belleğe katılabilir.
+ */
+static bool acpi_relocate_tables(acpi_found_tables* t)
+{
+	const acpi_sdt_header* root = t->xsdt ? t->xsdt : t->rsdt;
+	if (!root || !acpi_validate_sdt(root)) return false;
+
+	bool is_xsdt = (root == t->xsdt);
+	size_t entry_size = is_xsdt ? 8 : 4;
+	acpi_sdt_header* root_copy = acpi_copy_table(root, 0);
+	if (!root_copy) return false;
+
+	size_t entry_count = (root_copy->Length - sizeof(acpi_sdt_header)) / entry_size;
+	uint8_t* entries = (uint8_t*)(root_copy + 1);
+	acpi_found_tables moved = *t;
+
+	for (size_t i = 0; i < entry_count; i++) {
+		uintptr_t phys = is_xsdt ? (uintptr_t)((uint64_t*)entries)[i] : (uintptr_t)((uint32_t*)entries)[i];
+		const acpi_sdt_header* hdr = (const acpi_sdt_header*)phys;
+		acpi_sdt_header* copy = NULL;
+
+		if (hdr && acpi_validate_sdt(hdr)) {
+			bool is_fadt = acpi_validate_signature(hdr->Signature, ACPI_SIG_FADT);
+			/* Eski FADT'ler kısa; X alanları okunduğunda sıfır görünsün */
+			copy = acpi_copy_table(hdr, is_fadt ? sizeof(acpi_fadt_unified) : 0);
+			if (!copy) return false;
+
+			if (is_fadt) {
+				acpi_fadt_unified* fadt = (acpi_fadt_unified*)copy;
+				const acpi_sdt_header* dsdt = (const acpi_sdt_header*)(uintptr_t)
+					(fadt->XDsdt ? fadt->XDsdt : fadt->Dsdt);
+				if (dsdt && acpi_validate_sdt(dsdt)) {
+					acpi_sdt_header* dsdt_copy = acpi_copy_table(dsdt, 0);
+					if (!dsdt_copy) return false;
+					if (fadt->XDsdt) fadt->XDsdt = (uint64_t)(uintptr_t)dsdt_copy;
+					if (fadt->Dsdt) fadt->Dsdt = (uint32_t)(uintptr_t)dsdt_copy;
+					acpi_fix_checksum(copy);
+				}
+			}
+		}
+
+		if (hdr == (const acpi_sdt_header*)t->madt) moved.madt = (const acpi_madt*)copy;
+		if (hdr == t->fadt) moved.fadt = copy;
+		if (hdr == (const acpi_sdt_header*)t->hpet) moved.hpet = (const acpi_hpet*)copy;
+		if (hdr == t->mcfg) moved.mcfg = copy;
+
+		/* Geçersiz girdiler (copy == NULL) geri kazanılan belleği göstermesin */
+		if (is_xsdt) ((uint64_t*)entries)[i] = (uint64_t)(uintptr_t)copy;
+		else ((uint32_t*)entries)[i] = (uint32_t)(uintptr_t)copy;
+	}
+
+	acpi_fix_checksum(root_copy);
+	if (is_xsdt) moved.xsdt = root_copy;
+	else moved.rsdt = root_copy;
+
+	*t = moved;
+	return true;
+}
+
 void acpi_init(void)
 {
 	/* Temiz başlangıç */
@@ -204,6 +287,14 @@ void acpi_init(void)
 	/* Kök tabloyu tara ve önemli tabloları keşfet */
 	acpi_scan_rsdt_xsdt(root, &found);
 
+	/* Kopyalar hazırsa firmware'in ACPI_RECLAIMABLE belleği artık bizim */
+	if (acpi_relocate_tables(&found)) {
+		size_t reclaimed = pmm_reclaim_regions(MemoryRegionType_ACPI_RECLAIMABLE);
+		LOG("ACPI: tables copied, %zu KiB of reclaimable memory returned", reclaimed / 1024);
+	} else {
+		WARN("ACPI: tables could not be copied; ACPI reclaimable memory stays reserved");
+	}
+
 	/* FADT ve MADT'yi global değişkenlere kopyala */
 	if (found.fadt) {
 		acpi_fadt_ptr = (void*)found.fadt;
@@ -5,6 +5,7 @@
 #include <boot/multiboot2.h>
 #include <efi/efi.h>
 #include <debug/debug.h>
+#include <storage/BlockCache.h>
 #include <arch.h>
 
 // ACPI PM1 Control register bit fields (ACPI 1.0 semantics)
@@ -184,6 +185,9 @@ void acpi_poweroff() {
 
     LOG("Shutdown process started!");
 
+    // Önbellekte bekleyen yazmalar güç kesilmeden diske
+    BlockCache_Sync(NULL);
+
     // // Is EFI boot?
     // if (mb2_is_efi_boot) {
     //     EFI_SYSTEM_TABLE* systab = efi_system_table;
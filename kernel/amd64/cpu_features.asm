@@ -26,3 +26,63 @@ detect_erms:
     movzx   eax, al            ; return 0/1 in EAX as well
     pop     rbx
     ret
+
+section .bss
+
+; SIMD level used by memcpy/memmove/memset: 0 = none, 1 = SSE2, 2 = AVX2
+global simd_level
+simd_level: resb 1
+
+section .text
+
+; void detect_simd(void)
+; - SSE2: CPUID.1:EDX[26] (+ FXSR EDX[24]) -> CR0.EM=0, CR0.MP=1, CR4.OSFXSR|OSXMMEXCPT
+; - AVX2: CPUID.1:ECX[26,27,28] (XSAVE, OSXSAVE, AVX) + CPUID.7:EBX[5]
+;         -> CR4.OSXSAVE, XCR0 |= x87|SSE|AVX
+; - Writes the result to simd_level and returns it in EAX
+global detect_simd
+detect_simd:
+    push    rbx
+    xor     r8d, r8d           ; r8d = level
+
+    mov     eax, 1
+    cpuid
+    mov     r9d, ecx           ; CPUID.1:ECX for the AVX check
+    bt      edx, 24            ; FXSR
+    jnc     .done
+    bt      edx, 26            ; SSE2
+    jnc     .done
+
+    mov     rax, cr0
+    and     rax, ~(1 << 2)     ; EM = 0
+    or      rax, (1 << 1)      ; MP = 1
+    mov     cr0, rax
+    mov     rax, cr4
+    or      rax, (1 << 9) | (1 << 10) ; OSFXSR | OSXMMEXCPT
+    mov     cr4, rax
+    mov     r8d, 1
+
+    bt      r9d, 26            ; XSAVE
+    jnc     .done
+    bt      r9d, 28            ; AVX
+    jnc     .done
+    mov     eax, 7
+    xor     ecx, ecx
+    cpuid
+    bt      ebx, 5             ; AVX2
+    jnc     .done
+
+    mov     rax, cr4
+    or      rax, (1 << 18)     ; OSXSAVE
+    mov     cr4, rax
+    xor     ecx, ecx
+    xgetbv                     ; EDX:EAX = XCR0
+    or      eax, 7             ; x87 | SSE | AVX
+    xsetbv
+    mov     r8d, 2
+
+.done:
+    mov     byte [rel simd_level], r8b
+    mov     eax, r8d
+    pop     rbx
+    ret
@@ -2,10 +2,40 @@ default rel
 section .text
 
 global memcpy
+global memmove
 extern erms_supported
+extern simd_level
 
 use64
 
+MEM_SIMD_MIN    equ 256             ; below this the vector setup is not worth it
+MEM_NT_MIN      equ 512 * 1024      ; above this, non-temporal stores (no cache pollution)
+MEM_SIMD_CHUNK  equ 4096            ; largest block copied with interrupts off
+
+; The vector loops run in MEM_SIMD_CHUNK pieces with interrupts off, so an IRQ
+; never lands mid-loop.
+; An interrupt has no caller: when memcpy/memset run in an IRQ (periodic tasks
+; call them from the timer IRQ) the interrupted code still expects its xmm
+; registers intact, and the ISR stubs save only the general registers. The
+; vector paths therefore keep xmm0-3 on the stack for their duration. Kernel C
+; is built without AVX, so ymm upper halves are only live inside the cli
+; windows below and vzeroupper loses nothing.
+%macro XMM_SAVE 0
+    sub     rsp, 64
+    movdqu  [rsp], xmm0
+    movdqu  [rsp + 16], xmm1
+    movdqu  [rsp + 32], xmm2
+    movdqu  [rsp + 48], xmm3
+%endmacro
+
+%macro XMM_RESTORE 0
+    movdqu  xmm0, [rsp]
+    movdqu  xmm1, [rsp + 16]
+    movdqu  xmm2, [rsp + 32]
+    movdqu  xmm3, [rsp + 48]
+    add     rsp, 64
+%endmacro
+
 memcpy:
     cld
     mov     rax, rdi            ; return dest
@@ -13,9 +43,32 @@ memcpy:
     test    rdx, rdx
     jz      .ret
 
+    cmp     byte [rel simd_level], 0
+    je      .no_simd
+
+    ; Large copies (e.g. a full frame to the framebuffer) use non-temporal stores
+    cmp     rdx, MEM_NT_MIN
+    jae     .nt
+
+    ; For mid sizes ERMS rep movsb is as fast as the vector loop
+    cmp     byte [rel erms_supported], 0
+    jne     .erms
+    cmp     rdx, MEM_SIMD_MIN
+    jb      .no_erms
+    xor     r8d, r8d
+    call    simd_copy_fwd
+    ret
+
+.nt:
+    mov     r8d, 1
+    call    simd_copy_fwd
+    ret
+
+.no_simd:
     ; If ERMS supported, prefer rep movsb for all sizes
     cmp     byte [rel erms_supported], 0
     je      .no_erms
+.erms:
     mov     rcx, rdx
     rep     movsb
     jmp     .ret
@@ -58,3 +111,188 @@ memcpy:
 
 .ret:
     ret
+
+; void* memmove(void* dest, const void* src, size_t n)
+; The forward memcpy paths are safe when dest < src. A backward copy is only
+; needed when src < dest < src + n.
+memmove:
+    cld
+    mov     rax, rdi
+
+    mov     rcx, rdi
+    sub     rcx, rsi            ; dest - src (unsigned)
+    jz      .ret                ; dest == src
+    cmp     rcx, rdx
+    jae     memcpy              ; no overlap, or dest < src
+
+    lea     rsi, [rsi + rdx]    ; backward: work from the end
+    lea     rdi, [rdi + rdx]
+
+    cmp     byte [rel simd_level], 0
+    je      .head
+    cmp     rdx, MEM_SIMD_MIN
+    jb      .head
+    XMM_SAVE
+
+.chunk:
+    cmp     rdx, 64
+    jb      .vec_done
+    mov     rcx, rdx
+    and     rcx, ~63
+    cmp     rcx, MEM_SIMD_CHUNK
+    jbe     .sized
+    mov     ecx, MEM_SIMD_CHUNK
+.sized:
+    sub     rdx, rcx
+    shr     rcx, 6
+
+    pushfq
+    cli
+.loop:
+    ; Each 64-byte block is fully loaded before it is stored, so dest > src overlap is safe
+    sub     rsi, 64
+    sub     rdi, 64
+    movdqu  xmm0, [rsi + 48]
+    movdqu  xmm1, [rsi + 32]
+    movdqu  xmm2, [rsi + 16]
+    movdqu  xmm3, [rsi]
+    movdqu  [rdi + 48], xmm0
+    movdqu  [rdi + 32], xmm1
+    movdqu  [rdi + 16], xmm2
+    movdqu  [rdi], xmm3
+    dec     rcx
+    jnz     .loop
+    popfq
+    jmp     .chunk
+
+.vec_done:
+    XMM_RESTORE
+
+.head:
+    ; Remaining bytes at the start (all of them on the scalar path). The ISR
+    ; stubs do not clear DF, so DF=1 is only held with interrupts off, in
+    ; MEM_SIMD_CHUNK pieces like the vector loop.
+    test    rdx, rdx
+    jz      .ret
+    dec     rsi
+    dec     rdi
+.head_chunk:
+    mov     rcx, rdx
+    cmp     rcx, MEM_SIMD_CHUNK
+    jbe     .head_sized
+    mov     ecx, MEM_SIMD_CHUNK
+.head_sized:
+    sub     rdx, rcx
+    pushfq
+    cli
+    std
+    rep     movsb
+    cld
+    popfq
+    test    rdx, rdx
+    jnz     .head_chunk
+
+.ret:
+    ret
+
+; Forward vector copy.
+; In: rdi = dest, rsi = src, rdx = n (>= MEM_SIMD_MIN), r8d = 1 for non-temporal stores
+; rax is preserved; rcx, rdx, rsi, rdi are clobbered
+simd_copy_fwd:
+    XMM_SAVE
+
+    ; Align the destination to 32 bytes (the aligned stores require it)
+    mov     rcx, rdi
+    neg     rcx
+    and     rcx, 31
+    sub     rdx, rcx
+    rep     movsb
+
+.chunk:
+    cmp     rdx, 64
+    jb      .tail
+    mov     rcx, rdx
+    and     rcx, ~63
+    cmp     rcx, MEM_SIMD_CHUNK
+    jbe     .sized
+    mov     ecx, MEM_SIMD_CHUNK
+.sized:
+    sub     rdx, rcx
+    shr     rcx, 6              ; 64-byte blocks
+
+    pushfq
+    cli
+    cmp     byte [rel simd_level], 2
+    jb      .sse
+    test    r8d, r8d
+    jnz     .avx_nt
+
+.avx:
+    vmovdqu ymm0, [rsi]
+    vmovdqu ymm1, [rsi + 32]
+    vmovdqa [rdi], ymm0
+    vmovdqa [rdi + 32], ymm1
+    add     rsi, 64
+    add     rdi, 64
+    dec     rcx
+    jnz     .avx
+    vzeroupper
+    jmp     .chunk_done
+
+.avx_nt:
+    vmovdqu ymm0, [rsi]
+    vmovdqu ymm1, [rsi + 32]
+    vmovntdq [rdi], ymm0
+    vmovntdq [rdi + 32], ymm1
+    add     rsi, 64
+    add     rdi, 64
+    dec     rcx
+    jnz     .avx_nt
+    vzeroupper
+    jmp     .chunk_done
+
+.sse:
+    test    r8d, r8d
+    jnz     .sse_nt
+.sse_loop:
+    movdqu  xmm0, [rsi]
+    movdqu  xmm1, [rsi + 16]
+    movdqu  xmm2, [rsi + 32]
+    movdqu  xmm3, [rsi + 48]
+    movdqa  [rdi], xmm0
+    movdqa  [rdi + 16], xmm1
+    movdqa  [rdi + 32], xmm2
+    movdqa  [rdi + 48], xmm3
+    add     rsi, 64
+    add     rdi, 64
+    dec     rcx
+    jnz     .sse_loop
+    jmp     .chunk_done
+
+.sse_nt:
+    movdqu  xmm0, [rsi]
+    movdqu  xmm1, [rsi + 16]
+    movdqu  xmm2, [rsi + 32]
+    movdqu  xmm3, [rsi + 48]
+    movntdq [rdi], xmm0
+    movntdq [rdi + 16], xmm1
+    movntdq [rdi + 32], xmm2
+    movntdq [rdi + 48], xmm3
+    add     rsi, 64
+    add     rdi, 64
+    dec     rcx
+    jnz     .sse_nt
+
+.chunk_done:
+    popfq
+    jmp     .chunk
+
+.tail:
+    XMM_RESTORE
+    test    r8d, r8d
+    jz      .tail_copy
+    sfence                      ; order the non-temporal stores before later stores
+.tail_copy:
+    mov     rcx, rdx
+    rep     movsb
+    ret
@@ -0,0 +1,159 @@
+default rel
+section .text
+
+global memset
+extern erms_supported
+extern simd_level
+
+use64
+
+MEM_SIMD_MIN    equ 256
+MEM_NT_MIN      equ 512 * 1024
+MEM_SIMD_CHUNK  equ 4096
+
+; Same as memcpy.asm: xmm0 is saved around the vector path, which may run in
+; an IRQ where the interrupted code still holds it
+%macro XMM_SAVE 0
+    sub     rsp, 16
+    movdqu  [rsp], xmm0
+%endmacro
+
+%macro XMM_RESTORE 0
+    movdqu  xmm0, [rsp]
+    add     rsp, 16
+%endmacro
+
+; void* memset(void* ptr, int value, size_t n)
+; Same dispatch as memcpy (see memcpy.asm): the vector loop runs in
+; MEM_SIMD_CHUNK pieces with interrupts off.
+memset:
+    cld
+    mov     r11, rdi            ; return ptr
+
+    test    rdx, rdx
+    jz      .ret
+
+    movzx   eax, sil
+    mov     r9, 0x0101010101010101
+    imul    rax, r9             ; byte -> 8-byte pattern (al stays the value)
+
+    cmp     byte [rel simd_level], 0
+    je      .no_simd
+    cmp     rdx, MEM_NT_MIN
+    jae     .nt
+    cmp     byte [rel erms_supported], 0
+    jne     .bytes
+    cmp     rdx, MEM_SIMD_MIN
+    jb      .no_erms
+    xor     r8d, r8d
+    jmp     .simd
+.nt:
+    mov     r8d, 1
+
+.simd:
+    XMM_SAVE
+
+    ; Align the destination to 32 bytes
+    mov     rcx, rdi
+    neg     rcx
+    and     rcx, 31
+    sub     rdx, rcx
+    rep     stosb
+
+.chunk:
+    cmp     rdx, 64
+    jb      .tail
+    mov     rcx, rdx
+    and     rcx, ~63
+    cmp     rcx, MEM_SIMD_CHUNK
+    jbe     .sized
+    mov     ecx, MEM_SIMD_CHUNK
+.sized:
+    sub     rdx, rcx
+    shr     rcx, 6
+
+    pushfq
+    cli
+    cmp     byte [rel simd_level], 2
+    jb      .sse
+    vmovq   xmm0, rax
+    vpbroadcastq ymm0, xmm0
+    test    r8d, r8d
+    jnz     .avx_nt
+.avx:
+    vmovdqa [rdi], ymm0
+    vmovdqa [rdi + 32], ymm0
+    add     rdi, 64
+    dec     rcx
+    jnz     .avx
+    vzeroupper
+    jmp     .chunk_done
+.avx_nt:
+    vmovntdq [rdi], ymm0
+    vmovntdq [rdi + 32], ymm0
+    add     rdi, 64
+    dec     rcx
+    jnz     .avx_nt
+    vzeroupper
+    jmp     .chunk_done
+
+.sse:
+    movq    xmm0, rax
+    punpcklqdq xmm0, xmm0
+    test    r8d, r8d
+    jnz     .sse_nt
+.sse_loop:
+    movdqa  [rdi], xmm0
+    movdqa  [rdi + 16], xmm0
+    movdqa  [rdi + 32], xmm0
+    movdqa  [rdi + 48], xmm0
+    add     rdi, 64
+    dec     rcx
+    jnz     .sse_loop
+    jmp     .chunk_done
+.sse_nt:
+    movntdq [rdi], xmm0
+    movntdq [rdi + 16], xmm0
+    movntdq [rdi + 32], xmm0
+    movntdq [rdi + 48], xmm0
+    add     rdi, 64
+    dec     rcx
+    jnz     .sse_nt
+
+.chunk_done:
+    popfq
+    jmp     .chunk
+
+.tail:
+    XMM_RESTORE
+    test    r8d, r8d
+    jz      .bytes
+    sfence
+    jmp     .bytes
+
+.no_simd:
+    cmp     byte [rel erms_supported], 0
+    jne     .bytes
+
+.no_erms:
+    cmp     rdx, 32
+    jb      .bytes
+
+    ; Align to 8, then qword stores, then the tail
+    mov     rcx, rdi
+    neg     rcx
+    and     rcx, 7
+    sub     rdx, rcx
+    rep     stosb
+    mov     rcx, rdx
+    shr     rcx, 3
+    rep     stosq
+    and     rdx, 7
+
+.bytes:
+    mov     rcx, rdx
+    rep     stosb
+
+.ret:
+    mov     rax, r11
+    ret
@@ -1,5 +1,6 @@
-// AMD64 identity paging (now 4KiB granularity) with attribute hooks
+// AMD64 paging: large-page identity map of the low 4GiB, on-demand page tables and attribute hooks
 #include <arch.h>
+#include <memory/pmm.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -50,22 +51,29 @@ static inline void wbinvd(void)
 #define PTE_PS  (1ull << 7)  // Page Size (in PD: 2 MiB)
 #define PTE_G   (1ull << 8)  // Global
 
-// Statically allocated and 4KiB-aligned top-level tables
+#define PTE_PAT_4K    (1ull << 7)   // PAT bit in a 4 KiB PTE
+#define PTE_PAT_LARGE (1ull << 12)  // PAT bit in a 2 MiB PDE / 1 GiB PDPTE
+#define PTE_ADDR_MASK 0x000FFFFFFFFFF000ull
+#define PTE_CACHE_4K    (PTE_PWT | PTE_PCD | PTE_PAT_4K)
+#define PTE_CACHE_LARGE (PTE_PWT | PTE_PCD | PTE_PAT_LARGE)
+
+#define PAGE_SIZE_4K 0x1000ull
+#define PAGE_SIZE_2M 0x200000ull
+#define PAGE_SIZE_1G 0x40000000ull
+
+// Statically allocated top-level tables; the low 4 GiB identity map uses
+// 1 GiB pages (CPUID Page1GB) or, failing that, 2 MiB pages.
 static uint64_t pml4[512] __attribute__((aligned(4096)));
 static uint64_t pdpt[512] __attribute__((aligned(4096)));
-static uint64_t pd0[512]  __attribute__((aligned(4096))); // covers 0..1GiB
-static uint64_t pd1[512]  __attribute__((aligned(4096))); // covers 1..2GiB
-static uint64_t pd2[512]  __attribute__((aligned(4096))); // covers 2..3GiB
-static uint64_t pd3[512]  __attribute__((aligned(4096))); // covers 3..4GiB
-
-// For full 4KiB mapping we need 512 page tables per 1GiB (512 * 2MiB / 4KiB = 512).
-// We'll allocate them statically: 4 * 512 tables = 2048 PTs.
-// Each PT has 512 entries (4KiB * 512 = 2MiB).
-// Naming convention: pt_g<GB index>_<PT index within that GB>
-static uint64_t pt_g0[512][512] __attribute__((aligned(4096))); // 0..1GiB
-static uint64_t pt_g1[512][512] __attribute__((aligned(4096))); // 1..2GiB
-static uint64_t pt_g2[512][512] __attribute__((aligned(4096))); // 2..3GiB
-static uint64_t pt_g3[512][512] __attribute__((aligned(4096))); // 3..4GiB
+
+// Page tables needed before the PMM is up (identity-map PDs when 1 GiB pages
+// are missing, ranges with mixed MTRR types, 2 MiB splits for LAPIC/IOAPIC,
+// early MMIO). After that, tables come from the physical allocator.
+#define EARLY_TABLE_COUNT 20
+static uint64_t early_tables[EARLY_TABLE_COUNT][512] __attribute__((aligned(4096)));
+static size_t early_tables_used = 0;
+
+static bool g_gbpages = false; // CPUID 0x80000001 EDX[26]
 
 static inline void write_cr3(uint64_t phys)
 {
@@ -313,6 +321,34 @@ bool arch_mtrr_set_range(uintptr_t phys_start, size_t length, arch_paging_memtyp
 	return true;
 }
 
+// Is the MTRR type constant over [base, base + size)? size is a power of two and
+// base is aligned to it. A large page spanning several MTRR types has an
+// undefined memory type, so such ranges get smaller pages.
+static bool mtrr_range_uniform(uint64_t base, uint64_t size)
+{
+	size_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+	arch_cpuid(0x00000001u, &eax, &ebx, &ecx, &edx);
+	if ((edx & (1u << 12)) == 0) return true;
+	arch_mtrr_init(); // variable slot count and physical address width
+
+	uint64_t def_type = rdmsr(IA32_MTRR_DEF_TYPE_MSR);
+	if ((def_type & IA32_MTRR_DEF_ENABLE) == 0) return true; // everything UC
+	// The fixed ranges split the first 1 MiB into 4-64 KiB pieces
+	if (base < 0x100000ull && (def_type & IA32_MTRR_DEF_FIXED)) return false;
+
+	uint64_t phys_mask = mtrr_phys_mask_bits();
+	for (uint8_t i = 0; i < g_mtrr_var_count; ++i) {
+		uint64_t mask = rdmsr(IA32_MTRR_PHYSMASK(i));
+		if ((mask & 0x800ull) == 0) continue;
+		mask &= phys_mask;
+		// Mask bits below size: the slot covers part of the range, or none of it
+		if ((mask & (size - 1)) == 0) continue;
+		uint64_t high = mask & ~(size - 1);
+		if ((base & high) == (rdmsr(IA32_MTRR_PHYSBASE(i)) & high)) return false;
+	}
+	return true;
+}
+
 void arch_tlb_flush_one(void* addr) {
 	asm volatile ("invlpg (%0)" :: "r"(addr) : "memory");
 }
@@ -322,41 +358,141 @@ void arch_tlb_flush_all(void) {
 	asm volatile ("mov %0, %%cr3" :: "r"(cr3) : "memory");
 }
 
-static inline uint64_t* __get_pml4e(uintptr_t va) { (void)va; return &pml4[0]; }
-static inline uint64_t* __get_pdpte(uintptr_t va) { return &pdpt[(va >> 30) & 0x1FFull]; }
-static inline uint64_t* __get_pde(uintptr_t va) {
-	uint64_t gb = (va >> 30) & 0x3ull; // 0..3
-	uint64_t pd_index = (va >> 21) & 0x1FFull;
-	uint64_t* pd = (gb==0?pd0:gb==1?pd1:gb==2?pd2:pd3);
-	return &pd[pd_index];
+/* -------------------------------------------------------------------------- */
+/* Page-table walking with on-demand table allocation                          */
+/* -------------------------------------------------------------------------- */
+
+static uint64_t* __alloc_table(void)
+{
+	uint64_t* table = NULL;
+	if (early_tables_used < EARLY_TABLE_COUNT) {
+		table = early_tables[early_tables_used++];
+	} else {
+		// PMM blokları identity map içinde (< 4 GiB), doğrudan yazılabilir
+		table = (uint64_t*)pmm_pcp_alloc(0);
+	}
+	if (!table) return NULL;
+	for (int i = 0; i < 512; ++i) table[i] = 0;
+	return table;
 }
-static inline uint64_t* __get_pte(uintptr_t va) {
-	uint64_t gb = (va >> 30) & 0x3ull;
-	uint64_t pt_index = (va >> 21) & 0x1FFull; // which PT inside that GB
-	uint64_t entry_index = (va >> 12) & 0x1FFull; // which PTE inside PT
-	uint64_t (*pt_block)[512] = (gb==0?pt_g0:gb==1?pt_g1:gb==2?pt_g2:pt_g3);
-	return &pt_block[pt_index][entry_index];
+
+static inline uint64_t* __entry_table(uint64_t entry)
+{
+	return (uint64_t*)(uintptr_t)(entry & PTE_ADDR_MASK);
 }
 
-static void __apply_type_to_pte(uint64_t* pte, arch_paging_memtype_t type) {
-	// Clear PWT, PCD, PAT bit (bit 7 in 4KiB PTE high part -> actually bit 7 overall is PS for PDE; here normal PTE so bit7 is PAT)
-	*pte &= ~(PTE_PWT | PTE_PCD | (1ull << 7));
+// Paging levels: 4 = PML4E, 3 = PDPTE (1 GiB leaf), 2 = PDE (2 MiB leaf), 1 = PTE (4 KiB)
+static inline uint64_t __level_size(int level)
+{
+	return PAGE_SIZE_4K << (9 * (level - 1));
+}
+
+static inline size_t __level_index(uintptr_t va, int level)
+{
+	return (size_t)((va >> (12 + 9 * (level - 1))) & 0x1FFull);
+}
+
+// Replace a large leaf at `level` with a table of 512 leaves one level down
+static bool __split_large(uint64_t* entry, int level)
+{
+	uint64_t* table = __alloc_table();
+	if (!table) return false;
+
+	uint64_t old = *entry;
+	uint64_t size = __level_size(level);
+	uint64_t child = __level_size(level - 1);
+	uint64_t base = old & PTE_ADDR_MASK & ~(size - 1);
+	uint64_t flags = old & (PTE_RW | PTE_US | PTE_PWT | PTE_PCD | PTE_G);
+
+	if (level - 1 == 1) {
+		if (old & PTE_PAT_LARGE) flags |= PTE_PAT_4K;
+	} else {
+		flags |= PTE_PS | (old & PTE_PAT_LARGE);
+	}
+
+	for (int i = 0; i < 512; ++i) {
+		table[i] = (base + (uint64_t)i * child) | PTE_P | flags;
+	}
+
+	*entry = ((uint64_t)(uintptr_t)table) | PTE_P | PTE_RW | (old & PTE_US);
+	arch_tlb_flush_all();
+	return true;
+}
+
+// Returns the entry for va at `level`. With create=true, missing tables are
+// allocated and larger pages covering va are split down to that level.
+static uint64_t* __walk(uintptr_t va, int level, bool create)
+{
+	uint64_t* table = pml4;
+	for (int cur = 4; cur > level; --cur) {
+		uint64_t* entry = &table[__level_index(va, cur)];
+		if (!(*entry & PTE_P)) {
+			if (!create) return NULL;
+			uint64_t* next = __alloc_table();
+			if (!next) return NULL;
+			*entry = ((uint64_t)(uintptr_t)next) | PTE_P | PTE_RW;
+		} else if (cur <= 3 && (*entry & PTE_PS)) {
+			if (!create || !__split_large(entry, cur)) return NULL;
+		}
+		table = __entry_table(*entry);
+	}
+	return &table[__level_index(va, level)];
+}
+
+// Present leaf entry for va without modifying tables; *level receives its level
+static uint64_t* __lookup_leaf(uintptr_t va, int* level)
+{
+	uint64_t* table = pml4;
+	for (int cur = 4; cur >= 1; --cur) {
+		uint64_t* entry = &table[__level_index(va, cur)];
+		if (!(*entry & PTE_P)) return NULL;
+		if (cur == 1 || (cur <= 3 && (*entry & PTE_PS))) {
+			*level = cur;
+			return entry;
+		}
+		table = __entry_table(*entry);
+	}
+	return NULL;
+}
+
+static inline uint64_t __leaf_phys(uint64_t entry, int level, uintptr_t va)
+{
+	uint64_t size = __level_size(level);
+	return (entry & PTE_ADDR_MASK & ~(size - 1)) | (va & (size - 1));
+}
+
+static uint64_t __type_bits(arch_paging_memtype_t type, uint64_t pat_bit) {
 	switch (type) {
-		case ARCH_PAGING_MT_WB: /* nothing */ break;
-		case ARCH_PAGING_MT_WT: *pte |= PTE_PWT; break;
-		case ARCH_PAGING_MT_UC: *pte |= (PTE_PWT | PTE_PCD); break;
-		case ARCH_PAGING_MT_UC_MINUS: *pte |= PTE_PCD; break;
-		case ARCH_PAGING_MT_WC: *pte |= (1ull << 7); break; // PAT index with PAT=1, PWT=0, PCD=0
-		case ARCH_PAGING_MT_WP: *pte |= (1ull << 7) | PTE_PWT; break; // placeholder mapping
+		case ARCH_PAGING_MT_WB: return 0;
+		case ARCH_PAGING_MT_WT: return PTE_PWT;
+		case ARCH_PAGING_MT_UC: return PTE_PWT | PTE_PCD;
+		case ARCH_PAGING_MT_UC_MINUS: return PTE_PCD;
+		case ARCH_PAGING_MT_WC: return pat_bit; // PAT index with PAT=1, PWT=0, PCD=0
+		case ARCH_PAGING_MT_WP: return pat_bit | PTE_PWT; // placeholder mapping
 	}
+	return 0;
+}
+
+static void __apply_type_to_pte(uint64_t* pte, arch_paging_memtype_t type) {
+	*pte = (*pte & ~PTE_CACHE_4K) | __type_bits(type, PTE_PAT_4K);
+}
+
+static void __apply_type_to_large(uint64_t* pde, arch_paging_memtype_t type) {
+	*pde = (*pde & ~PTE_CACHE_LARGE) | __type_bits(type, PTE_PAT_LARGE);
+}
+
+static void __apply_type_to_leaf(uint64_t* entry, int level, arch_paging_memtype_t type) {
+	if (level == 1) __apply_type_to_pte(entry, type);
+	else __apply_type_to_large(entry, type);
 }
 
 arch_paging_memtype_t arch_paging_get_memtype(uintptr_t virt_addr) {
-	uint64_t* pte = __get_pte(virt_addr);
-	if (!(*pte & PTE_P)) return ARCH_PAGING_MT_UC;
-	bool pat = (*pte & (1ull<<7)) != 0;
-	bool pcd = (*pte & PTE_PCD) != 0;
-	bool pwt = (*pte & PTE_PWT) != 0;
+	int level;
+	uint64_t* entry = __lookup_leaf(virt_addr, &level);
+	if (!entry) return ARCH_PAGING_MT_UC;
+	bool pat = (*entry & (level > 1 ? PTE_PAT_LARGE : PTE_PAT_4K)) != 0;
+	bool pcd = (*entry & PTE_PCD) != 0;
+	bool pwt = (*entry & PTE_PWT) != 0;
 	if (!pat && !pcd && !pwt) return ARCH_PAGING_MT_WB;
 	if (!pat && !pcd &&  pwt) return ARCH_PAGING_MT_WT;
 	if (!pat &&  pcd && !pwt) return ARCH_PAGING_MT_UC_MINUS;
@@ -368,82 +504,186 @@ arch_paging_memtype_t arch_paging_get_memtype(uintptr_t virt_addr) {
 
 bool arch_paging_set_memtype(uintptr_t phys_start, size_t length, arch_paging_memtype_t type) {
 	if (length == 0) return true;
-	const uintptr_t page_size = 4096u;
-	uintptr_t start = phys_start & ~(page_size - 1);
-	uintptr_t end   = (phys_start + length + page_size - 1) & ~(page_size - 1);
-	size_t count = (end - start) / page_size;
-	size_t changed = 0;
-	for (size_t i = 0; i < count; ++i) {
-		uintptr_t cur = start + i * page_size;
-		uint64_t* pte = __get_pte(cur); // identity virt==phys
-		if (!(*pte & PTE_P)) continue; // skip unmapped
-		__apply_type_to_pte(pte, type);
+	uintptr_t start = phys_start & ~(PAGE_SIZE_4K - 1);
+	uintptr_t end   = (phys_start + length + PAGE_SIZE_4K - 1) & ~(PAGE_SIZE_4K - 1);
+	bool ok = true;
+	uintptr_t cur = start;
+	while (cur < end) {
+		int level;
+		uint64_t* entry = __lookup_leaf(cur, &level); // identity virt==phys
+		if (!entry) { ok = false; cur += PAGE_SIZE_4K; continue; } // skip unmapped
+
+		// Split large leaves only down to the size the range still covers
+		uint64_t size = __level_size(level);
+		while (level > 1 && ((cur & (size - 1)) != 0 || end - cur < size)) {
+			level--;
+			size = __level_size(level);
+			entry = __walk(cur, level, true);
+			if (!entry) break;
+		}
+		if (!entry) { ok = false; cur += PAGE_SIZE_4K; continue; }
+
+		__apply_type_to_leaf(entry, level, type);
 		arch_tlb_flush_one((void*)cur);
-		changed++;
+		cur += size;
 	}
-	return changed == count;
+	return ok;
 }
 
 bool arch_paging_map_with_type(uintptr_t phys_start, uintptr_t virt_start, size_t length,
 							   uint64_t base_flags, arch_paging_memtype_t type) {
 	if (length == 0) return true;
-	const uintptr_t page_size = 4096u;
-	uintptr_t phys = phys_start & ~(page_size - 1);
-	uintptr_t virt = virt_start & ~(page_size - 1);
-	uintptr_t end  = (phys_start + length + page_size - 1) & ~(page_size - 1);
-	size_t count = (end - phys) / page_size;
-	for (size_t i = 0; i < count; ++i) {
-		uintptr_t p = phys + i * page_size;
-		uintptr_t v = virt + i * page_size;
-		uint64_t* pte = __get_pte(v);
-		if (!(*pte & PTE_P)) {
-			*pte = (p & 0x000FFFFFFFFFF000ULL) | PTE_P | PTE_RW | (base_flags & (PTE_US|PTE_G));
+	uintptr_t phys = phys_start & ~(PAGE_SIZE_4K - 1);
+	uintptr_t virt = virt_start & ~(PAGE_SIZE_4K - 1);
+	uintptr_t end  = (phys_start + length + PAGE_SIZE_4K - 1) & ~(PAGE_SIZE_4K - 1);
+	uintptr_t offset = 0;
+	while (phys + offset < end) {
+		uintptr_t p = phys + offset;
+		uintptr_t v = virt + offset;
+		uintptr_t remaining = end - p;
+
+		// Existing leaf mapping the same frame with the same type: skip it whole
+		int level;
+		uint64_t* leaf = __lookup_leaf(v, &level);
+		if (leaf && __leaf_phys(*leaf, level, v) == p && arch_paging_get_memtype(v) == type) {
+			uint64_t size = __level_size(level);
+			uint64_t step = size - (v & (size - 1));
+			offset += (step < remaining) ? step : remaining;
+			continue;
+		}
+
+		if (leaf) {
+			// Existing leaf: keep the largest page that both addresses and the length
+			// still allow, splitting only at the range edges (as in set_memtype)
+			uint64_t size = __level_size(level);
+			while (level > 1 && (((p | v) & (size - 1)) != 0 || remaining < size)) {
+				level--;
+				size = __level_size(level);
+				leaf = __walk(v, level, true);
+				if (!leaf) return false; // out of page-table memory
+			}
+			if (__leaf_phys(*leaf, level, v) != p) {
+				*leaf = (p & PTE_ADDR_MASK) | PTE_P | PTE_RW | (level > 1 ? PTE_PS : 0) | (base_flags & (PTE_US|PTE_G));
+			}
+			__apply_type_to_leaf(leaf, level, type);
+			arch_tlb_flush_one((void*)v);
+			offset += size;
+			continue;
 		}
-		__apply_type_to_pte(pte, type);
+
+		// Fresh mappings use the largest page both addresses and the length allow
+		int target = 1;
+		if (g_gbpages && ((p | v) & (PAGE_SIZE_1G - 1)) == 0 && remaining >= PAGE_SIZE_1G) target = 3;
+		else if (((p | v) & (PAGE_SIZE_2M - 1)) == 0 && remaining >= PAGE_SIZE_2M) target = 2;
+
+		uint64_t* entry = __walk(v, target, true);
+		if (entry && target > 1 && (*entry & PTE_P)) {
+			// Slot already holds a lower-level table with other mappings
+			target = 1;
+			entry = __walk(v, target, true);
+		}
+		if (!entry) return false; // out of page-table memory
+		if (target > 1) {
+			*entry = (p & PTE_ADDR_MASK) | PTE_P | PTE_RW | PTE_PS | (base_flags & (PTE_US|PTE_G));
+		} else if (!(*entry & PTE_P)) {
+			*entry = (p & PTE_ADDR_MASK) | PTE_P | PTE_RW | (base_flags & (PTE_US|PTE_G));
+		}
+		__apply_type_to_leaf(entry, target, type);
 		arch_tlb_flush_one((void*)v);
+		offset += __level_size(target);
 	}
 	return true;
 }
 
-// Build identity 4KiB page tables for 0..4GiB
+bool arch_paging_unmap(uintptr_t virt_start, size_t length) {
+	if (length == 0) return true;
+	uintptr_t virt = virt_start & ~(PAGE_SIZE_4K - 1);
+	uintptr_t end  = (virt_start + length + PAGE_SIZE_4K - 1) & ~(PAGE_SIZE_4K - 1);
+	uintptr_t v = virt;
+	while (v < end) {
+		int level;
+		uint64_t* entry = __lookup_leaf(v, &level);
+		if (!entry) { v += PAGE_SIZE_4K; continue; }
+
+		// Split large pages only when the range covers part of them
+		uint64_t size = __level_size(level);
+		while (level > 1 && ((v & (size - 1)) != 0 || end - v < size)) {
+			level--;
+			size = __level_size(level);
+			entry = __walk(v, level, true);
+			if (!entry) return false;
+		}
+
+		*entry = 0;
+		arch_tlb_flush_one((void*)v);
+		v += size;
+	}
+	return true;
+}
+
+uintptr_t arch_paging_virt_to_phys(uintptr_t virt_addr) {
+	int level;
+	uint64_t* entry = __lookup_leaf(virt_addr, &level);
+	if (!entry) return 0;
+	return (uintptr_t)__leaf_phys(*entry, level, virt_addr);
+}
+
+// Build identity map for 0..4GiB with 1GiB pages when supported, 2MiB otherwise.
+// Ranges whose MTRR type is not uniform (the first 1 MiB, parts of the MMIO
+// hole) drop to the next page size.
 void amd64_map_identity_low_4g(void)
 {
 	static bool done = false;
 	if (done) return;
 	done = true;
 
-    // Zero top structures
-    for (int i=0;i<512;i++){ pml4[i]=0; pdpt[i]=0; pd0[i]=0; pd1[i]=0; pd2[i]=0; pd3[i]=0; }
-
-    // Link PML4 -> PDPT
-    pml4[0] = ((uint64_t)(uintptr_t)pdpt) | PTE_P | PTE_RW;
-
-    // Link PDPT to PDs
-    pdpt[0] = ((uint64_t)(uintptr_t)pd0) | PTE_P | PTE_RW;
-    pdpt[1] = ((uint64_t)(uintptr_t)pd1) | PTE_P | PTE_RW;
-    pdpt[2] = ((uint64_t)(uintptr_t)pd2) | PTE_P | PTE_RW;
-    pdpt[3] = ((uint64_t)(uintptr_t)pd3) | PTE_P | PTE_RW;
-
-    // Each PD entry points to a 4KiB PT (remove use of large pages)
-    for (int gb=0; gb<4; ++gb) {
-        uint64_t *pd = (gb==0?pd0:gb==1?pd1:gb==2?pd2:pd3);
-        uint64_t (*pt_block)[512] = (gb==0?pt_g0:gb==1?pt_g1:gb==2?pt_g2:pt_g3);
-        for (int pt_index=0; pt_index<512; ++pt_index) {
-            pd[pt_index] = ((uint64_t)(uintptr_t)pt_block[pt_index]) | PTE_P | PTE_RW; // PS=0
-            // Fill the PT
-            uint64_t base_phys = ((uint64_t)gb * 1024ull * 1024ull * 1024ull) + ((uint64_t)pt_index * 2ull * 1024ull * 1024ull);
-            for (int e=0; e<512; ++e) {
-                uint64_t phys = base_phys + ((uint64_t)e * 4096ull);
-                pt_block[pt_index][e] = phys | PTE_P | PTE_RW; // default WB
-            }
-        }
-    }
-
-    // Mark IOAPIC & LAPIC pages uncacheable
-    uint64_t ioapic_phys = 0xFEC00000ull;
-    uint64_t lapic_phys  = 0xFEE00000ull;
-    arch_paging_set_memtype(ioapic_phys, 4096, ARCH_PAGING_MT_UC);
-    arch_paging_set_memtype(lapic_phys,  4096, ARCH_PAGING_MT_UC);
-
-    write_cr3((uint64_t)(uintptr_t)pml4);
+	size_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+	arch_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx);
+	if (eax >= 0x80000001u) {
+		arch_cpuid(0x80000001u, &eax, &ebx, &ecx, &edx);
+		g_gbpages = (edx & (1u << 26)) != 0; // Page1GB
+	}
+
+	// Zero top structures
+	for (int i = 0; i < 512; i++) { pml4[i] = 0; pdpt[i] = 0; }
+
+	// Link PML4 -> PDPT
+	pml4[0] = ((uint64_t)(uintptr_t)pdpt) | PTE_P | PTE_RW;
+
+	// PDs first: the early pool always has room for them, PTs take what is left
+	bool uniform[4];
+	uint64_t* pd_low[4] = { NULL, NULL, NULL, NULL };
+	for (int gb = 0; gb < 4; ++gb) {
+		uniform[gb] = mtrr_range_uniform((uint64_t)gb << 30, PAGE_SIZE_1G);
+		if (!g_gbpages || !uniform[gb]) pd_low[gb] = __alloc_table();
+	}
+
+	for (int gb = 0; gb < 4; ++gb) {
+		uint64_t base = (uint64_t)gb << 30;
+		uint64_t* pd = pd_low[gb];
+		if (!pd) {
+			pdpt[gb] = base | PTE_P | PTE_RW | PTE_PS; // default WB
+			continue;
+		}
+		// Link PDPT to PDs, each PD entry maps a 2 MiB page (default WB)
+		pdpt[gb] = ((uint64_t)(uintptr_t)pd) | PTE_P | PTE_RW;
+		for (int i = 0; i < 512; ++i) {
+			uint64_t phys = base + ((uint64_t)i * PAGE_SIZE_2M);
+			uint64_t* pt = (uniform[gb] || mtrr_range_uniform(phys, PAGE_SIZE_2M)) ? NULL : __alloc_table();
+			if (!pt) { // uniform MTRR type (or no early table left): one 2 MiB page
+				pd[i] = phys | PTE_P | PTE_RW | PTE_PS;
+				continue;
+			}
+			for (int j = 0; j < 512; ++j) pt[j] = (phys + (uint64_t)j * PAGE_SIZE_4K) | PTE_P | PTE_RW;
+			pd[i] = ((uint64_t)(uintptr_t)pt) | PTE_P | PTE_RW;
+		}
+	}
+
+	write_cr3((uint64_t)(uintptr_t)pml4);
+
+	// Mark IOAPIC & LAPIC pages uncacheable (splits only the pages containing them)
+	uint64_t ioapic_phys = 0xFEC00000ull;
+	uint64_t lapic_phys  = 0xFEE00000ull;
+	arch_paging_set_memtype(ioapic_phys, 4096, ARCH_PAGING_MT_UC);
+	arch_paging_set_memtype(lapic_phys,  4096, ARCH_PAGING_MT_UC);
 }
@@ -10,6 +10,7 @@ extern idt_init
 extern idt_ptr
 extern __boot_kernel_start
 extern detect_erms
+extern detect_simd
 extern amd64_map_identity_low_4g
 
 _start:
@@ -43,6 +44,7 @@ _start:
 
     ; Detect CPU features (ERMS) after segmentation set up
     call detect_erms
+    call detect_simd ; SSE2/AVX2 -> simd_level (memcpy/memset dispatch)
 
     ; Ensure low 4GiB identity-mapped with 2MiB pages (MMIO reachable)
     call amd64_map_identity_low_4g
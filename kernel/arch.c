@@ -28,3 +28,30 @@ void arch_bios_int(uint8_t int_no, arch_processor_regs_t* in, arch_processor_reg
         #endif
     }
 }
+
+size_t arch_irq_save(void)
+{
+    size_t flags;
+    asm volatile ("pushf; pop %0; cli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+void arch_irq_restore(size_t flags)
+{
+    if (flags & (1u << 9)) // IF
+        asm volatile ("sti" : : : "memory");
+}
+
+bool arch_irq_wait(size_t flags)
+{
+    if (!(flags & (1u << 9))) return false; // kesmeler kapalıydı; uyanacak bir şey yok
+    // sti'nin etkisi bir komut gecikir: koşul denetimi ile hlt arasında kesme kaçmaz
+    asm volatile ("sti; hlt" : : : "memory");
+    return true;
+}
+
+uint32_t arch_cpu_index(void)
+{
+    // Şimdilik yalnızca BSP çalışıyor
+    return 0;
+}
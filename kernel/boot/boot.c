@@ -11,6 +11,7 @@
 #include <pci/PCI.h>
 #include <memory/memory.h>
 #include <gfxterm/gfxterm.h>
+#include <arch.h>
 
 extern DriverBase pic8259_driver;
 extern DriverBase ps2kbd_driver;
@@ -28,14 +29,19 @@ extern void heap_init();
 extern void acpi_poweroff(); // ACPI power off function
 extern void acpi_restart(); 
 extern void efi_init();
+extern void efi_exit_boot_services();
 extern void bios_init();
 extern void pmm_init();
+extern void dma_init();
 extern bool apic_supported();
 extern void screen_init();
 extern void gfx_init();
 extern void acpi_init();
 extern void gfx_draw_task();
 extern void i386_processor_exceptions_init();
+extern void heap_bench_run();
+extern void fb_bench_run();
+extern void heap_stats_dump_start(size_t interval_ms);
 
 extern uint32_t mb2_signature;
 extern uint32_t mb2_tagptr;
@@ -89,13 +95,32 @@ void __boot_kernel_start(void)
     pmm_init();
     LOG("Physical Memory Manager initialized");
 
+    if (mb2_is_efi_boot)
+    {
+        efi_exit_boot_services(); // Boot services bölgeleri buddy'ye katılır
+    }
+
+    dma_init(); // Depolama sürücüleri için bounce tamponları
+
     acpi_init();
     LOG("ACPI initialized");
 
     if (mb2_framebuffer->framebuffer_addr > 0xFFFFFFFF)
     {
+#ifdef ARCH_AMD
+        // Identity map yalnızca ilk 4GB'ı kapsar; sayfa tablolarını VMM'e açtır
+        uintptr_t fb_phys = (uintptr_t)mb2_framebuffer->framebuffer_addr;
+        size_t fb_size = (size_t)mb2_framebuffer->framebuffer_pitch * mb2_framebuffer->framebuffer_height;
+        if (!arch_paging_map_with_type(fb_phys, fb_phys, fb_size, 0, ARCH_PAGING_MT_WB))
+        {
+            ERROR("Failed to map framebuffer above 4GB, cannot continue");
+            acpi_poweroff();
+        }
+        LOG("Framebuffer above 4GB mapped at %p", (void*)fb_phys);
+#else
         ERROR("Framebuffer address is above 4GB limit, cannot continue");
         acpi_poweroff();
+#endif
     }
 
     void* large_alloc = malloc(1024 * 1024 * 10); // 10 MB test
@@ -157,11 +182,17 @@ void __boot_kernel_start(void)
 
     asm volatile ("sti"); // Enable interrupts
 
+    heap_bench_run(); // uptimeMs artık sayıyor
+
     gfx_init();
 
+    fb_bench_run(); // gfx_draw_task periyodik göreve bağlanmadan önce
+
     gfxTask = periodic_task_create("gfx_draw_task", gfx_draw_task, NULL, 16);
     periodic_task_start(gfxTask);
 
+    heap_stats_dump_start(60000); // Uzun açık kalan sistemlerde sızıntı/parçalanma takibi için
+
     dbgGFXTermStream.Open();
     dbgGFXTerm.Open();
 
@@ -2,6 +2,8 @@
 #include "memory/heap.h"
 #include "memory/memory.h"
 
+#define BUFFER_POOL_GROW 16
+
 // Create a new buffer with default data size
 Buffer* buffer_create(size_t default_data_size) {
     Buffer* buffer = (Buffer*)malloc(sizeof(Buffer));
@@ -14,6 +16,12 @@ Buffer* buffer_create(size_t default_data_size) {
     buffer->count = 0;
     buffer->total_size = 0;
     buffer->default_data_size = default_data_size;
+
+    if (!object_pool_init(&buffer->node_pool, "BufferNode", sizeof(BufferNode) + default_data_size,
+                          BUFFER_POOL_GROW, true)) {
+        free(buffer);
+        return NULL;
+    }
     
     return buffer;
 }
@@ -23,6 +31,7 @@ void buffer_destroy(Buffer* buffer) {
     if (!buffer) return;
     
     buffer_clear(buffer);
+    object_pool_destroy(&buffer->node_pool);
     free(buffer);
 }
 
@@ -33,7 +42,7 @@ void buffer_clear(Buffer* buffer) {
     BufferNode* current = buffer->head;
     while (current) {
         BufferNode* next = current->next;
-        free(current);
+        object_pool_free(&buffer->node_pool, current);
         current = next;
     }
     
@@ -49,13 +58,14 @@ int buffer_push(Buffer* buffer, const void* data) {
     
     size_t data_size = buffer->default_data_size;
     
-    // Node + veri için yer ayır (flexible array member)
-    BufferNode* new_node = (BufferNode*)malloc(sizeof(BufferNode) + data_size);
+    // Node + veri buffer'ın havuzundan gelir (flexible array member)
+    BufferNode* new_node = (BufferNode*)object_pool_alloc(&buffer->node_pool);
     if (!new_node) {
         return -1;
     }
     
     new_node->next = NULL;
+    new_node->pool = &buffer->node_pool;
     new_node->data_size = data_size;
     
     // Veriyi node'un data alanına kopyala
@@ -100,7 +110,7 @@ void* buffer_pop(Buffer* buffer) {
     buffer->total_size -= data_size;
     
     // Not: Veri pointer'ını döndürüyoruz ama node'u silmiyoruz
-    // Kullanıcı veriyi aldıktan sonra buffer_free_node() çağırmalı
+    // Kullanıcı veriyi aldıktan sonra buffer_free_data() çağırmalı
     return data;
 }
 
@@ -164,10 +174,15 @@ BufferNode* buffer_pop_node(Buffer* buffer) {
 // Free a buffer node
 void buffer_free_node(BufferNode* node) {
     if (node) {
-        free(node);
+        object_pool_free(node->pool, node);
     }
 }
 
+void buffer_free_data(void* data) {
+    if (!data) return;
+    buffer_free_node((BufferNode*)((uint8_t*)data - offsetof(BufferNode, data)));
+}
+
 // Iterator functions
 BufferNode* buffer_iterator_begin(Buffer* buffer) {
     return buffer ? buffer->head : NULL;
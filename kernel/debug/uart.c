@@ -308,6 +308,15 @@ static const acpi_spcr* uart_find_spcr_in_root(const acpi_sdt_header* root, bool
 
 static const acpi_spcr* uart_find_spcr(void)
 {
+    // acpi_init tabloları kopyalayıp firmware'in ACPI_RECLAIMABLE belleğini geri
+    // verir; o andan sonra yalnızca kopyalar okunabilir
+    const acpi_sdt_header* xsdt = acpi_get_xsdt();
+    const acpi_sdt_header* rsdt = acpi_get_rsdt();
+    if (xsdt || rsdt) {
+        return xsdt ? uart_find_spcr_in_root(xsdt, true) : uart_find_spcr_in_root(rsdt, false);
+    }
+
+    // ACPI henüz kurulmadı: firmware tabloları yerinde
     const acpi_rsdp_v2* rsdp_v2 = NULL;
     const acpi_rsdp_v1* rsdp_v1 = uart_find_rsdp(&rsdp_v2);
     if (!rsdp_v1) {
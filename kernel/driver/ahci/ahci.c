@@ -7,8 +7,11 @@
 #include <stddef.h>
 #include <memory/memory.h>
 #include <memory/heap.h>
+#include <memory/dma.h>
 #include <storage/BlockDevice.h>
 #include <irq/IRQ.h>
+#include <arch.h>
+#include <time/timer.h>
 
 // Local helpers
 static const char* sig_to_str(uint32_t sig)
@@ -22,35 +25,77 @@ static const char* sig_to_str(uint32_t sig)
     }
 }
 
+// Slot başına tamamlanma durumu (bounce kopyası slot toplanırken yapılır)
+typedef struct {
+    void* buf;
+    uint32_t bytes;
+    bool is_write;
+    DmaBuffer bounce;
+    BlockRequest* req; // asenkron isteğin komutuysa sahibi
+} ahci_slot_t;
+
 typedef struct {
     volatile hba_port_t* port;
     uint8_t port_no;
-    void* clb_mem; // 1K aligned
-    void* fb_mem;  // 256B aligned
-    void* ctba0;   // command table for slot 0 (aligned 128B+)
+    DmaBuffer clb;   // 1K aligned
+    DmaBuffer fb;    // 256B aligned
+    DmaBuffer ctba;  // slot başına bir komut tablosu, AHCI_CMD_TABLE_STRIDE aralıklı
     BlockDevice* blk; // registered block device
-    volatile uint32_t irq_events; // last PxIS observed by IRQ handler
+    uint8_t slot_count;            // CAP.NCS
+    uint32_t slot_mask;            // Kullanılabilir slotlar (NCQ'da cihaz kuyruk derinliği)
+    bool ncq;                      // READ/WRITE FPDMA QUEUED
+    volatile uint32_t slots_busy;   // Ayrılmış slotlar
+    volatile uint32_t slots_active; // Donanıma verilmiş, henüz toplanmamış
+    volatile uint32_t slots_queued; // slots_active içinde NCQ ile verilenler (PxSACT)
+    volatile uint32_t slots_failed; // Hata ya da zaman aşımıyla biten
+    ahci_slot_t slots[32];
+    BlockRequest* queue_head;      // Komutları henüz tam verilmemiş istekler (FIFO)
+    BlockRequest* queue_tail;
+    volatile uint32_t sync_waiters; // Kuyruksuz senkron komut bekleyenler; kuyruk durur
+    uint64_t progress_ms;           // Son slot tamamlanması ya da boş porta ilk komut (zaman aşımı)
+    volatile bool recover_pending;  // ISR TFES gördü; port görev bağlamında yeniden başlatılır
+    uint32_t error_is;              // TFES anındaki PxIS/PxTFD (günlük için)
+    uint32_t error_tfd;
 } ahci_port_ctx_t;
 
 static volatile hba_mem_t* s_hba = NULL;
 static ahci_port_ctx_t s_ports[32];
 static uint8_t s_ahci_irq_line = 0xFF; // legacy INTx line (0..15)
+static uint64_t s_ahci_dma_limit = DMA_ADDR_32BIT; // CAP.S64A yoksa HBA yalnızca 4 GiB altını adresler
 
-void ahci_irq_isr(void)
+static volatile uint32_t s_ahci_irq_count = 0; // probe sırasında hattın çalıştığını doğrulamak için
+static bool s_ahci_irq_live = false; // tamamlanmalar kesmeyle gelir; bekleyenler uyur
+
+#define AHCI_CMD_TIMEOUT_MS    5000u // ilerleme olmadan geçebilecek en uzun süre
+#define AHCI_ENGINE_TIMEOUT_MS  500u // PxCMD.CR/FR geçişleri
+#define AHCI_BOHC_TIMEOUT_MS   2000u // BIOS devri (BOHC.BB ile uzayabilir)
+#define AHCI_LINK_TIMEOUT_MS     10u // COMRESET sonrası PHY iletişimi
+
+// Zaman aşımları uptimeMs'e göredir; saat kesmeyle ilerlediğinden bekleyen
+// yollar kesmeler açıkken çağrılır.
+static inline uint64_t ahci_now(void)
 {
-    if (!s_hba || s_ahci_irq_line == 0xFF) return;
-    uint32_t his = s_hba->is;
-    if (his) {
-        for (uint8_t pi = 0; pi < 32; ++pi) {
-            if ((his & (1u << pi)) == 0) continue;
-            volatile hba_port_t* pp = &s_hba->ports[pi];
-            uint32_t pis = pp->is;
-            pp->is = pis; // write-to-clear
-            if (pi < 32) s_ports[pi].irq_events |= pis;
-        }
-        s_hba->is = his; // write-to-clear summary
+    size_t flags = arch_irq_save(); // i386'da 64-bit okuma iki parçadır
+    uint64_t now = uptimeMs;
+    arch_irq_restore(flags);
+    return now;
+}
+
+// (*reg & mask) == value olana ya da timeout_ms dolana kadar bekler
+static bool ahci_wait_reg(volatile uint32_t* reg, uint32_t mask, uint32_t value, uint32_t timeout_ms)
+{
+    uint64_t start = ahci_now();
+    while ((*reg & mask) != value) {
+        if (ahci_now() - start > timeout_ms) return (*reg & mask) == value;
+        asm volatile ("pause");
     }
-    if (irq_controller && irq_controller->acknowledge) irq_controller->acknowledge(s_ahci_irq_line);
+    return true;
+}
+
+static void ahci_delay_ms(uint32_t ms)
+{
+    uint64_t start = ahci_now();
+    while (ahci_now() - start <= ms) asm volatile ("pause");
 }
 
 static inline void mmio_wmb(void) { (void)s_hba->is; }
@@ -77,18 +122,12 @@ static void ahci_port_stop(volatile hba_port_t* p)
     // Clear ST
     p->cmd &= ~HBA_PxCMD_ST;
     // Wait until CR cleared
-    {
-        uint32_t spin = 1000000;
-        while ((p->cmd & HBA_PxCMD_CR) && spin--) {asm volatile ("hlt");}
-        if (p->cmd & HBA_PxCMD_CR) WARN("AHCI: port stop timeout (CR still set)");
-    }
+    if (!ahci_wait_reg(&p->cmd, HBA_PxCMD_CR, 0, AHCI_ENGINE_TIMEOUT_MS))
+        WARN("AHCI: port stop timeout (CR still set)");
     // Clear FRE and wait FR cleared
     p->cmd &= ~HBA_PxCMD_FRE;
-    {
-        uint32_t spin = 1000000;
-        while ((p->cmd & HBA_PxCMD_FR) && spin--) {asm volatile ("hlt"); }
-        if (p->cmd & HBA_PxCMD_FR) WARN("AHCI: port stop timeout (FR still set)");
-    }
+    if (!ahci_wait_reg(&p->cmd, HBA_PxCMD_FR, 0, AHCI_ENGINE_TIMEOUT_MS))
+        WARN("AHCI: port stop timeout (FR still set)");
 }
 
 static void ahci_port_start(volatile hba_port_t* p)
@@ -99,19 +138,13 @@ static void ahci_port_start(volatile hba_port_t* p)
 
     // Enable FIS receive and wait FR asserts
     p->cmd |= HBA_PxCMD_FRE;
-    {
-        uint32_t spin = 1000000;
-        while (((p->cmd & HBA_PxCMD_FR) == 0) && spin--) {asm volatile ("hlt"); }
-        if ((p->cmd & HBA_PxCMD_FR) == 0) WARN("AHCI: PxCMD.FR did not assert after FRE");
-    }
+    if (!ahci_wait_reg(&p->cmd, HBA_PxCMD_FR, HBA_PxCMD_FR, AHCI_ENGINE_TIMEOUT_MS))
+        WARN("AHCI: PxCMD.FR did not assert after FRE");
 
     // Start command processing and wait CR reflects engine state
     p->cmd |= HBA_PxCMD_ST;
-    {
-        uint32_t spin = 1000000;
-        while (((p->cmd & HBA_PxCMD_CR) == 0) && spin--) { asm volatile ("hlt"); }
-        // If CR doesn't set immediately it's still ok on some controllers
-    }
+    // If CR doesn't set immediately it's still ok on some controllers
+    (void)ahci_wait_reg(&p->cmd, HBA_PxCMD_CR, HBA_PxCMD_CR, AHCI_ENGINE_TIMEOUT_MS);
 }
 
 static void ahci_port_comreset(volatile hba_port_t* p)
@@ -121,9 +154,8 @@ static void ahci_port_comreset(volatile hba_port_t* p)
     // Issue COMRESET: set DET=1 then 0
     uint32_t sctl = p->sctl;
     sctl &= ~0x0Fu; sctl |= 0x1u; p->sctl = sctl;
-    for (volatile int i=0;i<200000;i++) (void)p->ssts;
+    ahci_delay_ms(1); // DET=1 en az 1 ms tutulur
     sctl &= ~0x0Fu; p->sctl = sctl;
-    for (volatile int i=0;i<200000;i++) (void)p->ssts;
 }
 
 static void ahci_port_recover(ahci_port_ctx_t* ctx, const char* tag)
@@ -135,354 +167,672 @@ static void ahci_port_recover(ahci_port_ctx_t* ctx, const char* tag)
     p->serr = 0xFFFFFFFFu;
     mmio_wmb();
     // Short settle
-    for (volatile int i = 0; i < 200000; ++i) (void)p->ssts;
+    ahci_delay_ms(1);
 
     // If bus appears wedged (CI still set later), perform light engine restart
     uint32_t cmd = p->cmd;
     if ((cmd & (HBA_PxCMD_ST | HBA_PxCMD_FRE)) != 0) {
         // Stop engine
         p->cmd &= ~HBA_PxCMD_ST;
-        {
-            uint32_t spin = 1000000; while ((p->cmd & HBA_PxCMD_CR) && spin--) { asm volatile ("hlt"); }
-        }
+        (void)ahci_wait_reg(&p->cmd, HBA_PxCMD_CR, 0, AHCI_ENGINE_TIMEOUT_MS);
         p->cmd &= ~HBA_PxCMD_FRE;
-        {
-            uint32_t spin = 1000000; while ((p->cmd & HBA_PxCMD_FR) && spin--) { asm volatile ("hlt"); }
-        }
+        (void)ahci_wait_reg(&p->cmd, HBA_PxCMD_FR, 0, AHCI_ENGINE_TIMEOUT_MS);
         // Restart
         p->is = 0xFFFFFFFFu; p->serr = 0xFFFFFFFFu; mmio_wmb();
-        for (volatile int i = 0; i < 100000; ++i) (void)p->ssts;
         p->cmd |= HBA_PxCMD_FRE;
         p->cmd |= HBA_PxCMD_ST;
     }
     ahci_dump_port(p, ctx->port_no, "after-recover");
 }
 
-static bool ahci_port_configure(ahci_port_ctx_t* ctx)
+static inline hba_cmd_header_t* ahci_slot_header(ahci_port_ctx_t* ctx, uint32_t slot)
+{
+    return (hba_cmd_header_t*)ctx->clb.virt + slot;
+}
+
+static inline hba_cmd_table_t* ahci_slot_table(ahci_port_ctx_t* ctx, uint32_t slot)
+{
+    return (hba_cmd_table_t*)((uint8_t*)ctx->ctba.virt + slot * AHCI_CMD_TABLE_STRIDE);
+}
+
+// Boş slot yoksa -1
+static int ahci_slot_alloc(ahci_port_ctx_t* ctx)
+{
+    size_t flags = arch_irq_save();
+    uint32_t avail = ctx->slot_mask & ~ctx->slots_busy;
+    if (!avail) {
+        arch_irq_restore(flags);
+        return -1;
+    }
+    uint32_t slot = (uint32_t)__builtin_ctz(avail);
+    ctx->slots_busy |= 1u << slot;
+    arch_irq_restore(flags);
+    return (int)slot;
+}
+
+static void ahci_slot_free(ahci_port_ctx_t* ctx, uint32_t mask)
+{
+    size_t flags = arch_irq_save();
+    ctx->slots_busy &= ~mask;
+    ctx->slots_failed &= ~mask;
+    arch_irq_restore(flags);
+}
+
+// Bekleyen tüm komutları başarısız sayar ve portu yeniden başlatır (ST=0, CI/SACT temizlenir).
+// Görev bağlamında çağrılır; kurtarma sürerken ISR yeni komut vermez.
+static void ahci_port_abort(ahci_port_ctx_t* ctx, const char* tag)
+{
+    size_t flags = arch_irq_save();
+    ctx->slots_failed |= ctx->slots_active;
+    ctx->slots_active = 0;
+    ctx->slots_queued = 0;
+    ctx->recover_pending = true;
+    arch_irq_restore(flags);
+    ahci_port_recover(ctx, tag);
+    ctx->recover_pending = false;
+}
+
+// PxSACT/PxCI'de biti düşmüş slotları toplar; kesme bağlamından da çağrılır.
+// TFES'te HBA durur; NCQ'da hatalı etiketi bulmak READ LOG EXT gerektirdiğinden
+// bekleyenlerin hepsi başarısız sayılır. Portu yeniden başlatmak beklemeli
+// olduğundan ahci_port_recover_pending'e bırakılır.
+static void ahci_port_reap(ahci_port_ctx_t* ctx)
 {
     volatile hba_port_t* p = ctx->port;
-    ahci_port_stop(p);
+    size_t flags = arch_irq_save();
+    uint32_t is = p->is;
+    if (is) p->is = is; // write-to-clear
+    uint32_t sact = p->sact; // SACT önce: bit önce CI'dan, sonra SACT'tan düşer
+    uint32_t pending = (sact | p->ci) & ctx->slots_active;
+    if (pending != ctx->slots_active) ctx->progress_ms = uptimeMs;
+    ctx->slots_active = pending;
+    ctx->slots_queued &= pending;
+    if ((is & HBA_PxIS_TFES) && !ctx->recover_pending) {
+        ctx->error_is = is;
+        ctx->error_tfd = p->tfd;
+        ctx->slots_failed |= pending;
+        ctx->slots_active = 0;
+        ctx->slots_queued = 0;
+        ctx->recover_pending = true;
+    }
+    arch_irq_restore(flags);
+}
 
-    // Allocate CLB (1K aligned) and FB (256B aligned)
-    ctx->clb_mem = heap_aligned_alloc(1024, 1024);
-    ctx->fb_mem  = heap_aligned_alloc(256, 256);
-    if (!ctx->clb_mem || !ctx->fb_mem) return false;
-    memset(ctx->clb_mem, 0, 1024);
-    memset(ctx->fb_mem, 0, 256);
-    uintptr_t clb = (uintptr_t)ctx->clb_mem;
-    uintptr_t fb  = (uintptr_t)ctx->fb_mem;
-    p->clb = (uint32_t)((uint64_t)clb & 0xFFFFFFFFu);
-    p->clbu = (uint32_t)(((uint64_t)clb >> 32) & 0xFFFFFFFFu);
-    p->fb  = (uint32_t)((uint64_t)fb & 0xFFFFFFFFu);
-    p->fbu = (uint32_t)(((uint64_t)fb >> 32) & 0xFFFFFFFFu);
-
-    // Command header for slot 0
-    hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-    memset(hdr, 0, sizeof(hba_cmd_header_t));
-    hdr->prdtl = 1; // single PRDT
-
-    // Command table (align to 128)
-    ctx->ctba0 = heap_aligned_alloc(128, sizeof(hba_cmd_table_t));
-    if (!ctx->ctba0) return false;
-    memset(ctx->ctba0, 0, sizeof(hba_cmd_table_t));
-    uintptr_t ctba = (uintptr_t)ctx->ctba0;
-    hdr->ctba = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-    hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
+// Ertelenmiş TFES kurtarması; görev bağlamında, kesmeler açıkken
+static void ahci_port_recover_pending(ahci_port_ctx_t* ctx)
+{
+    if (!ctx->recover_pending) return;
+    WARN("AHCI: TFES on port %u (IS=0x%08x TFD=0x%08x)", ctx->port_no, ctx->error_is, ctx->error_tfd);
+    ahci_port_recover(ctx, "TFES");
+    ctx->recover_pending = false;
+}
 
-    // Clear pending interrupts
-    p->is = 0xFFFFFFFFu;
+// Bekleyen komut varken AHCI_CMD_TIMEOUT_MS boyunca hiçbiri bitmediyse portu sıfırlar
+static bool ahci_port_check_timeout(ahci_port_ctx_t* ctx, const char* what)
+{
+    size_t flags = arch_irq_save();
+    uint32_t active = ctx->slots_active;
+    bool expired = active && uptimeMs - ctx->progress_ms > AHCI_CMD_TIMEOUT_MS;
+    arch_irq_restore(flags);
+    if (!expired) return false;
 
-    ahci_port_start(p);
-    ahci_dump_port(p, ctx->port_no, "after-start");
+    volatile hba_port_t* p = ctx->port;
+    ERROR("AHCI: %s timeout on port %u (slots=0x%08x SACT=0x%08x CI=0x%08x IS=0x%08x TFD=0x%08x)",
+          what, ctx->port_no, active, p->sact, p->ci, p->is, p->tfd);
+    ahci_port_abort(ctx, what);
     return true;
 }
 
-static bool ahci_read_sector(ahci_port_ctx_t* ctx, uint64_t lba, uint32_t count, void* buf)
+// mask'teki slotlardan biri bitene ya da bir kesme gelene kadar uyur. Koşul
+// kesmeler kapalıyken denetlenir; arch_irq_wait uyanmayı kaçırmaz. 1 ms'lik saat
+// kesmesi de uyandırdığından kaybolan bir AHCI kesmesi yalnızca gecikme olur.
+// Kesme hattı yoksa ya da kesmeler kapalıysa yoklamaya döner.
+static void ahci_port_sleep(ahci_port_ctx_t* ctx, uint32_t mask)
 {
-    if (count == 0) return true;
-    volatile hba_port_t* p = ctx->port;
-    // Wait if busy (bounded)
-    {
-        uint32_t spin = 1000000;
-        while ((p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) && spin--) { asm volatile ("pause"); }
-        if (p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) {
-            ERROR("AHCI: Port %u busy before READ DMA (TFD=0x%08x)", ctx->port_no, p->tfd);
-            return false;
-        }
+    size_t flags = arch_irq_save();
+    if (s_ahci_irq_live && (ctx->slots_active & mask) && arch_irq_wait(flags)) return;
+    arch_irq_restore(flags);
+    asm volatile ("pause");
+}
+
+// DMA parçalarını PRDT'ye yazar; son girdi kesme ister
+static void ahci_prdt_write(hba_cmd_table_t* tbl, const DmaSegment* segs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        tbl->prdt[i].dba = (uint32_t)(segs[i].phys & 0xFFFFFFFFu);
+        tbl->prdt[i].dbau = (uint32_t)((segs[i].phys >> 32) & 0xFFFFFFFFu);
+        tbl->prdt[i].rsv0 = 0;
+        tbl->prdt[i].dbc_i = (segs[i].length - 1) & 0x003FFFFFu;
+    }
+    if (count) tbl->prdt[count - 1].dbc_i |= 1u << 31; // ioc=1
+}
+
+// PRD adresi ve uzunluğu çift olmalıdır (dba bit 0 ve dbc bit 0 ayrılmış)
+static bool ahci_segs_aligned(const DmaSegment* segs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        if ((segs[i].phys | segs[i].length) & 1u) return false;
+    return true;
+}
+
+// buf'u fiziksel parçalarına bölüp PRDT'yi kurar. PRDT'ye sığmıyorsa, HBA'nın
+// adresleyemediği yerdeyse ya da hizasızsa bounce tamponu kullanılır (yazmada
+// veri önce kopyalanır). Kurulan PRD sayısı; 0: bounce da olmadı.
+static uint32_t ahci_prdt_setup(hba_cmd_table_t* tbl, void* buf, uint32_t bytes, bool is_write, DmaBuffer* bounce)
+{
+    DmaSegment segs[AHCI_PRDT_MAX];
+    bounce->virt = NULL;
+    uint32_t count = (uint32_t)dma_map_segments(buf, bytes, 0, AHCI_PRD_MAX_BYTES, s_ahci_dma_limit, segs, AHCI_PRDT_MAX);
+    if (count == 0 || !ahci_segs_aligned(segs, count)) {
+        if (bytes > DMA_BOUNCE_SIZE || !dma_bounce_acquire(bounce)) return 0;
+        if (is_write) memcpy(bounce->virt, buf, bytes);
+        segs[0].phys = bounce->phys;
+        segs[0].length = bytes;
+        count = 1;
     }
+    ahci_prdt_write(tbl, segs, count);
+    return count;
+}
+
+// Okumada bounce verisini kullanıcı tamponuna taşır ve bounce'u geri verir
+static void ahci_prdt_finish(void* buf, uint32_t bytes, bool is_write, bool ok, DmaBuffer* bounce)
+{
+    if (!bounce->virt) return;
+    if (ok && !is_write) memcpy(buf, bounce->virt, bytes);
+    dma_bounce_release(bounce);
+}
 
-    // Build command in slot 0
-    hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-    // Program CTBA in case controller expects it each time
-    uintptr_t ctba = (uintptr_t)ctx->ctba0;
-    hdr->ctba  = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-    hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
+// Slot'un başlığını hazırlar ve tablonun CFIS/ACMD kısmını temizler
+static hba_cmd_table_t* ahci_cmd_setup(ahci_port_ctx_t* ctx, uint32_t slot, bool atapi, bool is_write)
+{
+    hba_cmd_header_t* hdr = ahci_slot_header(ctx, slot);
     hdr->cfl = sizeof(fis_reg_h2d_t) / 4; // FIS length in dwords
-    hdr->a = 0; // ATA
-    hdr->w = 0; // read
-    hdr->prdtl = 1;
+    hdr->a = atapi ? 1 : 0;
+    hdr->w = is_write ? 1 : 0;
+    hdr->c = 0;
+    hdr->prdtl = 0;
     hdr->prdbc = 0;
 
-    hba_cmd_table_t* tbl = (hba_cmd_table_t*)ctx->ctba0;
-    memset(tbl, 0, sizeof(hba_cmd_table_t));
+    hba_cmd_table_t* tbl = ahci_slot_table(ctx, slot);
+    memset(tbl, 0, offsetof(hba_cmd_table_t, prdt));
 
-    // PRDT sized by logical block size (default 512 when unknown)
-    uintptr_t bufp = (uintptr_t)buf;
-    tbl->prdt[0].dba = (uint32_t)((uint64_t)bufp & 0xFFFFFFFFu);
-    tbl->prdt[0].dbau = (uint32_t)(((uint64_t)bufp >> 32) & 0xFFFFFFFFu);
-    uint32_t bsz = (ctx->blk && ctx->blk->logical_block_size) ? ctx->blk->logical_block_size : 512u;
-    uint32_t byte_count = count * bsz;
-    tbl->prdt[0].dbc_i = ((byte_count - 1) & 0x003FFFFFu) | (1u << 31); // ioc=1
+    ahci_slot_t* s = &ctx->slots[slot];
+    s->buf = NULL;
+    s->bytes = 0;
+    s->is_write = is_write;
+    s->bounce.virt = NULL;
+    return tbl;
+}
 
-    // CFIS: READ DMA EXT (0x25)
-    fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)tbl->cfis;
-    memset(cfis, 0, sizeof(*cfis));
-    cfis->fis_type = FIS_TYPE_REG_H2D;
-    cfis->c = 1;
-    cfis->command = 0x25; // READ DMA EXT
-    cfis->device = 1 << 6; // LBA mode
-    // LBA48
-    cfis->lba0 = (uint8_t)(lba & 0xFF);
-    cfis->lba1 = (uint8_t)((lba >> 8) & 0xFF);
-    cfis->lba2 = (uint8_t)((lba >> 16) & 0xFF);
-    cfis->lba3 = (uint8_t)((lba >> 24) & 0xFF);
-    cfis->lba4 = (uint8_t)((lba >> 32) & 0xFF);
-    cfis->lba5 = (uint8_t)((lba >> 40) & 0xFF);
-    cfis->countl = (uint8_t)(count & 0xFF);
-    cfis->counth = (uint8_t)((count >> 8) & 0xFF);
+// Slot'u tek tamponluk komut için hazırlar; CFIS'i çağıran doldurur. Tampon
+// DMA'ya uygun değilse ve bounce havuzu boşsa false döner.
+static bool ahci_cmd_prepare(ahci_port_ctx_t* ctx, uint32_t slot, bool atapi, bool is_write, void* buf, uint32_t bytes)
+{
+    hba_cmd_table_t* tbl = ahci_cmd_setup(ctx, slot, atapi, is_write);
+    if (!bytes) return true;
+
+    ahci_slot_t* s = &ctx->slots[slot];
+    s->buf = buf;
+    s->bytes = bytes;
+    uint32_t prds = ahci_prdt_setup(tbl, buf, bytes, is_write, &s->bounce);
+    ahci_slot_header(ctx, slot)->prdtl = (uint16_t)prds;
+    return prds != 0;
+}
 
-    // Issue command on slot 0
-    p->is = 0xFFFFFFFFu; // clear
-    mmio_wmb();
-    p->ci = 1u; // slot 0
-
-    // Wait for completion: prefer IRQ event, fall back to CI polling
-    {
-        uint32_t spin = 5000000; // generous spin
-        while (spin--) {
-            if ((p->ci & 1u) == 0) break; // done
-            if (ctx->irq_events) break;   // IRQ signaled
-            if (p->is & HBA_PxIS_TFES) {
-                ERROR("AHCI: TFES error on port %u (IS=0x%08x TFD=0x%08x)", ctx->port_no, p->is, p->tfd);
-                return false;
-            }
-            asm volatile ("pause");  
+// İsteğin verilmemiş kısmından PRDT'nin alabildiği kadar bloğu, scatter
+// listesinin parçaları arasında geçerek eşler. İlk blok doğrudan eşlenemiyorsa
+// bir bounce tamponu kadarı kopyalanarak aktarılır. Kapsanan blok; 0: bounce havuzu dolu.
+static uint32_t ahci_cmd_prepare_req(ahci_port_ctx_t* ctx, uint32_t slot, BlockRequest* req)
+{
+    bool is_write = req->op == BLKREQ_WRITE;
+    hba_cmd_table_t* tbl = ahci_cmd_setup(ctx, slot, false, is_write);
+    hba_cmd_header_t* hdr = ahci_slot_header(ctx, slot);
+    uint32_t bsz = req->device->logical_block_size;
+    uint32_t max_blocks = req->count - req->issued;
+    if (max_blocks > AHCI_MAX_SECTORS) max_blocks = AHCI_MAX_SECTORS;
+
+    DmaSegment segs[AHCI_PRDT_MAX];
+    uint32_t count = 0;
+    uint32_t blocks = 0;
+    while (blocks < max_blocks && count < AHCI_PRDT_MAX) {
+        uint32_t avail = 0;
+        void* buf = BlockRequest_BufferAt(req, req->issued + blocks, &avail);
+        if (!buf) break;
+        if (avail > max_blocks - blocks) avail = max_blocks - blocks;
+
+        size_t mapped = 0;
+        uint32_t got = (uint32_t)dma_map_partial(buf, (size_t)avail * bsz, 0, AHCI_PRD_MAX_BYTES, s_ahci_dma_limit,
+                                                 segs + count, AHCI_PRDT_MAX - count, &mapped);
+        // Yalnızca tam bloklar alınır; son parça blok sınırında kesilir
+        uint32_t whole = (uint32_t)(mapped / bsz);
+        size_t keep = (size_t)whole * bsz;
+        size_t acc = 0;
+        uint32_t used = 0;
+        while (used < got && acc < keep) {
+            DmaSegment* seg = &segs[count + used++];
+            if (acc + seg->length > keep) seg->length = (uint32_t)(keep - acc);
+            acc += seg->length;
         }
-        // Clear any latched irq events
-        ctx->irq_events = 0;
-        if (p->ci & 1u) {
-            ERROR("AHCI: READ DMA timeout on port %u (IS=0x%08x TFD=0x%08x)", ctx->port_no, p->is, p->tfd);
+        if (!ahci_segs_aligned(segs + count, used)) break;
+
+        count += used;
+        blocks += whole;
+        if (whole < avail) break;
+    }
+
+    if (blocks) {
+        ahci_prdt_write(tbl, segs, count);
+        hdr->prdtl = (uint16_t)count;
+        return blocks;
+    }
+
+    uint32_t avail = 0;
+    void* buf = BlockRequest_BufferAt(req, req->issued, &avail);
+    uint32_t n = DMA_BOUNCE_SIZE / bsz;
+    if (n > avail) n = avail;
+    if (n > max_blocks) n = max_blocks;
+    if (!buf || n == 0) return 0;
+
+    ahci_slot_t* s = &ctx->slots[slot];
+    s->buf = buf;
+    s->bytes = n * bsz;
+    uint32_t prds = ahci_prdt_setup(tbl, buf, s->bytes, is_write, &s->bounce);
+    hdr->prdtl = (uint16_t)prds;
+    return prds ? n : 0;
+}
+
+// NCQ ve kuyruksuz komutlar karışamaz: karşı türden bekleyen varsa true
+static inline bool ahci_cmd_conflicts(ahci_port_ctx_t* ctx, bool queued)
+{
+    return queued ? (ctx->slots_active & ~ctx->slots_queued) != 0 : ctx->slots_queued != 0;
+}
+
+static void ahci_cmd_start(ahci_port_ctx_t* ctx, uint32_t slot, bool queued)
+{
+    volatile hba_port_t* p = ctx->port;
+    uint32_t bit = 1u << slot;
+    size_t flags = arch_irq_save();
+    if (!ctx->slots_active) ctx->progress_ms = uptimeMs; // boş porttan zaman aşımı sayacı başlar
+    ctx->slots_active |= bit;
+    if (queued) {
+        ctx->slots_queued |= bit;
+        p->sact = bit; // SACT, CI'dan önce
+    }
+    mmio_wmb();
+    p->ci = bit;
+    arch_irq_restore(flags);
+}
+
+// Senkron yol: karşı türden bekleyenler önce boşaltılır
+static bool ahci_cmd_issue(ahci_port_ctx_t* ctx, uint32_t slot, bool queued)
+{
+    volatile hba_port_t* p = ctx->port;
+    for (;;) {
+        ahci_port_reap(ctx);
+        ahci_port_recover_pending(ctx);
+        if (!ahci_cmd_conflicts(ctx, queued)) break;
+        if (ahci_port_check_timeout(ctx, "drain")) break;
+        ahci_port_sleep(ctx, ctx->slots_active);
+    }
+
+    // Kuyruksuz komut boş bir porta verilirken cihazın hazır olması beklenir
+    if (!queued && !ctx->slots_active) {
+        if (!ahci_wait_reg(&p->tfd, HBA_PxTFD_BSY | HBA_PxTFD_DRQ, 0, AHCI_CMD_TIMEOUT_MS)) {
+            ERROR("AHCI: Port %u busy before command (TFD=0x%08x)", ctx->port_no, p->tfd);
             return false;
         }
     }
-    // success
+
+    ahci_cmd_start(ctx, slot, queued);
     return true;
 }
 
-static bool ahci_issue_flush(ahci_port_ctx_t* ctx, uint8_t opcode)
+// mask'teki slotlar bitene kadar uyur, bounce verisini taşır ve slotları bırakır.
+// Slotları kesme varsa ISR toplar; her uyanışta yine de yoklanır.
+static bool ahci_cmd_wait(ahci_port_ctx_t* ctx, uint32_t mask, const char* what)
 {
-    volatile hba_port_t* p = ctx->port;
-    // Wait if busy
-    {
-        uint32_t spin = 1000000;
-        while ((p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) && spin--) { asm volatile ("pause"); }
-        if (p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) return false;
-    }
-
-    hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-    uintptr_t ctba = (uintptr_t)ctx->ctba0;
-    hdr->ctba  = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-    hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
-    hdr->cfl = sizeof(fis_reg_h2d_t) / 4;
-    hdr->a = 0; // ATA
-    hdr->w = 0;
-    hdr->prdtl = 0; // no data
-    hdr->prdbc = 0;
+    for (;;) {
+        ahci_port_reap(ctx);
+        if (!(ctx->slots_active & mask)) break;
+        if (ahci_port_check_timeout(ctx, what)) break;
+        ahci_port_sleep(ctx, mask);
+    }
+    ahci_port_recover_pending(ctx);
+
+    bool ok = true;
+    for (uint32_t m = mask; m; m &= m - 1) {
+        uint32_t slot = (uint32_t)__builtin_ctz(m);
+        ahci_slot_t* s = &ctx->slots[slot];
+        bool slot_ok = (ctx->slots_failed & (1u << slot)) == 0;
+        ahci_prdt_finish(s->buf, s->bytes, s->is_write, slot_ok, &s->bounce);
+        if (!slot_ok) ok = false;
+    }
+    ahci_slot_free(ctx, mask);
+    return ok;
+}
 
-    hba_cmd_table_t* tbl = (hba_cmd_table_t*)ctx->ctba0;
-    memset(tbl, 0, sizeof(hba_cmd_table_t));
+static void ahci_fis_lba48(fis_reg_h2d_t* cfis, uint64_t lba)
+{
+    cfis->lba0 = (uint8_t)(lba & 0xFF);
+    cfis->lba1 = (uint8_t)((lba >> 8) & 0xFF);
+    cfis->lba2 = (uint8_t)((lba >> 16) & 0xFF);
+    cfis->lba3 = (uint8_t)((lba >> 24) & 0xFF);
+    cfis->lba4 = (uint8_t)((lba >> 32) & 0xFF);
+    cfis->lba5 = (uint8_t)((lba >> 40) & 0xFF);
+    cfis->device = 1 << 6; // LBA mode
+}
 
-    fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)tbl->cfis;
-    memset(cfis, 0, sizeof(*cfis));
+static void ahci_fis_rw(fis_reg_h2d_t* cfis, uint64_t lba, uint32_t count, bool is_write, bool queued, uint32_t slot)
+{
     cfis->fis_type = FIS_TYPE_REG_H2D;
     cfis->c = 1;
-    cfis->command = opcode; // 0xEA FLUSH CACHE EXT or 0xE7 FLUSH CACHE
-    cfis->device = 1 << 6; // LBA mode
+    ahci_fis_lba48(cfis, lba);
+    if (queued) {
+        cfis->command = is_write ? 0x61 : 0x60; // WRITE/READ FPDMA QUEUED
+        cfis->featurel = (uint8_t)(count & 0xFF); // sektör sayısı FEATURE alanında
+        cfis->featureh = (uint8_t)((count >> 8) & 0xFF);
+        cfis->countl = (uint8_t)(slot << 3);      // NCQ etiketi = slot
+    } else {
+        cfis->command = is_write ? 0x35 : 0x25; // WRITE/READ DMA EXT
+        cfis->countl = (uint8_t)(count & 0xFF);
+        cfis->counth = (uint8_t)((count >> 8) & 0xFF);
+    }
+}
 
-    p->is = 0xFFFFFFFFu;
-    mmio_wmb();
-    p->ci = 1u;
+// ---- Asynchronous request queue ----
+// Aşağıdakiler kesmeler kapalıyken çağrılır.
+#define AHCI_REQ_NOQUEUE 0x1u // NCQ hatasından sonra kuyruksuz yeniden deneme
 
-    uint32_t spin = 5000000;
-    while (spin--) {
-        if ((p->ci & 1u) == 0) break;
-        if (ctx->irq_events) break;
-        if (p->is & HBA_PxIS_TFES) return false;
-        asm volatile ("pause"); 
+static void ahci_queue_remove(ahci_port_ctx_t* ctx, BlockRequest* req)
+{
+    BlockRequest* prev = NULL;
+    for (BlockRequest* it = ctx->queue_head; it; prev = it, it = it->next) {
+        if (it != req) continue;
+        if (prev) prev->next = it->next;
+        else ctx->queue_head = it->next;
+        if (ctx->queue_tail == it) ctx->queue_tail = prev;
+        it->next = NULL;
+        return;
     }
-    ctx->irq_events = 0;
-    if (p->ci & 1u) return false;
-    return true;
 }
 
-static bool ahci_blk_read(struct BlockDevice* bdev, uint64_t lba, uint32_t count, void* buffer)
+// Komutu kalmayan isteği bitirir. NCQ hatasında hangi parçanın bozulduğu
+// bilinmediğinden istek bir kez baştan, kuyruksuz olarak yeniden verilir.
+static void ahci_req_settle(ahci_port_ctx_t* ctx, BlockRequest* req)
 {
-    ahci_port_ctx_t* ctx = (ahci_port_ctx_t*)bdev->driver_ctx;
-    // Read in chunks if count is large (limit to 128 sectors per command)
-    uint8_t* out = (uint8_t*)buffer;
-    while (count) {
-        uint32_t n = (count > 128) ? 128 : count;
-        if (!ahci_read_sector(ctx, lba, n, out)) return false;
-        lba += n; out += n * 512; count -= n;
-        asm volatile ("pause"); 
+    if (req->inflight) return;
+    if (!req->error && req->issued < req->count) return;
+    ahci_queue_remove(ctx, req);
+
+    if (req->error && ctx->ncq && !(req->driver_flags & AHCI_REQ_NOQUEUE)) {
+        WARN("AHCI: Port %u queued %s at LBA %llu failed; retrying without NCQ",
+             ctx->port_no, req->op == BLKREQ_WRITE ? "write" : "read", (unsigned long long)req->lba);
+        req->error = false;
+        req->issued = 0;
+        req->driver_flags |= AHCI_REQ_NOQUEUE;
+        req->next = ctx->queue_head;
+        ctx->queue_head = req;
+        if (!ctx->queue_tail) ctx->queue_tail = req;
+        return;
     }
-    return true;
+    if (req->error) {
+        ERROR("AHCI: Port %u %s of %u blocks at LBA %llu failed", ctx->port_no,
+              req->op == BLKREQ_WRITE ? "write" : "read", req->count, (unsigned long long)req->lba);
+    }
+    BlockRequest_Complete(req, !req->error);
 }
 
-static bool ahci_blk_write(struct BlockDevice* bdev, uint64_t lba, uint32_t count, const void* buffer)
+// Kuyruğun başındaki istekten boş slot kaldıkça komut verir; her komut PRDT'nin
+// ve AHCI_MAX_SECTORS'ın izin verdiği kadar blok taşır. NCQ'da cihaz bunları
+// kendi sırasıyla işler.
+static void ahci_queue_kick(ahci_port_ctx_t* ctx)
 {
-    ahci_port_ctx_t* ctx = (ahci_port_ctx_t*)bdev->driver_ctx;
-    // Write in chunks (limit to 128 sectors per command)
-    const uint8_t* in = (const uint8_t*)buffer;
-    while (count) {
-        uint32_t n = (count > 128) ? 128 : count;
-        // Issue WRITE DMA EXT
-        if (!ctx) return false;
-        volatile hba_port_t* p = ctx->port;
-
-        // Wait if busy
-        {
-            uint32_t spin = 1000000;
-            while ((p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) && spin--) { asm volatile ("hlt"); }
-            if (p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) {
-                ERROR("AHCI: Port %u busy before WRITE DMA (TFD=0x%08x)", ctx->port_no, p->tfd);
-                return false;
-            }
+    while (ctx->queue_head && !ctx->sync_waiters && !ctx->recover_pending) {
+        BlockRequest* req = ctx->queue_head;
+        if (req->error) return; // kalan komutları bitince ahci_req_settle tamamlar
+        bool queued = ctx->ncq && !(req->driver_flags & AHCI_REQ_NOQUEUE);
+        if (ahci_cmd_conflicts(ctx, queued)) return;
+
+        int slot = ahci_slot_alloc(ctx);
+        if (slot < 0) return;
+        bool is_write = req->op == BLKREQ_WRITE;
+        uint32_t n = ahci_cmd_prepare_req(ctx, (uint32_t)slot, req);
+        if (n == 0) {
+            ahci_slot_free(ctx, 1u << slot);
+            if (ctx->slots_active) return; // bounce havuzu dolu; biten komutlar bırakır
+            ERROR("AHCI: Port %u request at LBA %llu is not DMA-able and no bounce buffer is free",
+                  ctx->port_no, (unsigned long long)(req->lba + req->issued));
+            req->error = true;
+            ahci_req_settle(ctx, req);
+            continue;
         }
 
-        hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-        // Ensure CTBA is programmed (some controllers require this per command)
-        uintptr_t ctba = (uintptr_t)ctx->ctba0;
-        hdr->ctba  = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-        hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
-        hdr->cfl = sizeof(fis_reg_h2d_t) / 4; // 5 dwords
-        hdr->w = 1; // write
-        hdr->a = 0; // ATA
-        hdr->prdtl = 1;
-        hdr->prdbc = 0;
-
-        hba_cmd_table_t* tbl = (hba_cmd_table_t*)ctx->ctba0;
-        memset(tbl, 0, sizeof(hba_cmd_table_t));
-
-        // PRDT sized by logical block size (default 512 when unknown)
-        uintptr_t bufp = (uintptr_t)in;
-        tbl->prdt[0].dba = (uint32_t)((uint64_t)bufp & 0xFFFFFFFFu);
-        tbl->prdt[0].dbau = (uint32_t)(((uint64_t)bufp >> 32) & 0xFFFFFFFFu);
-        uint32_t bsz = (ctx->blk && ctx->blk->logical_block_size) ? ctx->blk->logical_block_size : 512u;
-        uint32_t byte_count = n * bsz;
-        tbl->prdt[0].dbc_i = ((byte_count - 1) & 0x003FFFFFu) | (1u << 31); // ioc=1
-
-        // CFIS: WRITE DMA EXT (0x35)
-        fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)tbl->cfis;
-        memset(cfis, 0, sizeof(*cfis));
-        cfis->fis_type = FIS_TYPE_REG_H2D;
-        cfis->c = 1;
-        cfis->command = 0x35; // WRITE DMA EXT
-        cfis->device = 1 << 6; // LBA mode
-        // LBA48
-        cfis->lba0 = (uint8_t)(lba & 0xFF);
-        cfis->lba1 = (uint8_t)((lba >> 8) & 0xFF);
-        cfis->lba2 = (uint8_t)((lba >> 16) & 0xFF);
-        cfis->lba3 = (uint8_t)((lba >> 24) & 0xFF);
-        cfis->lba4 = (uint8_t)((lba >> 32) & 0xFF);
-        cfis->lba5 = (uint8_t)((lba >> 40) & 0xFF);
-        cfis->countl = (uint8_t)(n & 0xFF);
-        cfis->counth = (uint8_t)((n >> 8) & 0xFF);
-
-        // Issue command
-        p->is = 0xFFFFFFFFu; // clear
-        mmio_wmb();
-        p->ci = 1u; // slot 0
-
-        // Wait for completion
-        {
-            uint32_t spin = 5000000;
-            while (spin--) {
-                if ((p->ci & 1u) == 0) break;
-                if (ctx->irq_events) break;
-                if (p->is & HBA_PxIS_TFES) {
-                    ERROR("AHCI: TFES error on WRITE port %u (IS=0x%08x TFD=0x%08x)", ctx->port_no, p->is, p->tfd);
-                    return false;
-                }
-                asm volatile ("pause"); 
-            }
-            ctx->irq_events = 0;
-            if (p->ci & 1u) {
-                ERROR("AHCI: WRITE DMA timeout on port %u (IS=0x%08x TFD=0x%08x)", ctx->port_no, p->is, p->tfd);
-                return false;
+        ahci_fis_rw((fis_reg_h2d_t*)ahci_slot_table(ctx, (uint32_t)slot)->cfis,
+                    req->lba + req->issued, n, is_write, queued, (uint32_t)slot);
+        ctx->slots[slot].req = req;
+        req->inflight++;
+        req->issued += n;
+        if (req->issued == req->count) ahci_queue_remove(ctx, req);
+        ahci_cmd_start(ctx, (uint32_t)slot, queued);
+    }
+}
+
+// Toplanmış slotların sahibi olan istekleri ilerletir
+static void ahci_queue_complete(ahci_port_ctx_t* ctx)
+{
+    for (uint32_t m = ctx->slots_busy & ~ctx->slots_active; m; m &= m - 1) {
+        uint32_t slot = (uint32_t)__builtin_ctz(m);
+        ahci_slot_t* s = &ctx->slots[slot];
+        BlockRequest* req = s->req;
+        if (!req) continue; // senkron komut; sahibi ahci_cmd_wait
+
+        bool ok = (ctx->slots_failed & (1u << slot)) == 0;
+        ahci_prdt_finish(s->buf, s->bytes, s->is_write, ok, &s->bounce);
+        s->req = NULL;
+        ahci_slot_free(ctx, 1u << slot);
+
+        req->inflight--;
+        if (!ok) req->error = true;
+        ahci_req_settle(ctx, req);
+    }
+}
+
+// Biten komutları toplar, istekleri tamamlar ve kuyruğu yeniden doldurur.
+// Görev bağlamındaki karşılığı; ertelenmiş kurtarma ve zaman aşımı burada işlenir.
+static void ahci_port_service(ahci_port_ctx_t* ctx)
+{
+    ahci_port_reap(ctx);
+    ahci_port_recover_pending(ctx);
+    (void)ahci_port_check_timeout(ctx, "command");
+
+    size_t flags = arch_irq_save();
+    ahci_queue_complete(ctx);
+    ahci_queue_kick(ctx);
+    arch_irq_restore(flags);
+}
+
+// Kuyruktaki tüm istekler bitene kadar bekler
+static void ahci_queue_drain(ahci_port_ctx_t* ctx)
+{
+    while (ctx->queue_head || ctx->slots_busy) {
+        ahci_port_service(ctx);
+        ahci_port_sleep(ctx, ctx->slots_active);
+    }
+}
+
+void ahci_irq_isr(void)
+{
+    if (!s_hba || s_ahci_irq_line == 0xFF) return;
+    uint32_t his = s_hba->is;
+    if (his) {
+        s_ahci_irq_count++;
+        for (uint8_t pi = 0; pi < 32; ++pi) {
+            if ((his & (1u << pi)) == 0) continue;
+            ahci_port_ctx_t* ctx = &s_ports[pi];
+            if (ctx->port) {
+                // Biten slotlar toplanır, istekler tamamlanır ve boşalan slotlara
+                // kuyruktan yeni komut verilir; senkron bekleyen hlt'den uyanır
+                ahci_port_reap(ctx);
+                ahci_queue_complete(ctx);
+                ahci_queue_kick(ctx);
+            } else {
+                volatile hba_port_t* pp = &s_hba->ports[pi];
+                pp->is = pp->is; // write-to-clear
             }
         }
+        s_hba->is = his; // write-to-clear summary (port IS'lerinden sonra)
+    }
+    if (irq_controller && irq_controller->acknowledge) irq_controller->acknowledge(s_ahci_irq_line);
+}
+
+// Tek slotluk kuyruksuz komut: ayır, hazırla, CFIS'i doldur, bekle.
+// Beklerken kuyruk yeni komut vermez; dolu slotlar bitip boşalır.
+static int ahci_cmd_begin(ahci_port_ctx_t* ctx, bool atapi, bool is_write, void* buf, uint32_t bytes)
+{
+    ctx->sync_waiters++;
+    uint64_t start = ahci_now();
+    int slot;
+    while ((slot = ahci_slot_alloc(ctx)) < 0 && ahci_now() - start <= AHCI_CMD_TIMEOUT_MS) {
+        ahci_port_service(ctx);
+        ahci_port_sleep(ctx, ctx->slots_active);
+    }
+    if (slot < 0) {
+        ERROR("AHCI: Port %u has no free command slot", ctx->port_no);
+        ctx->sync_waiters--;
+        return -1;
+    }
+    if (!ahci_cmd_prepare(ctx, (uint32_t)slot, atapi, is_write, buf, bytes)) {
+        ERROR("AHCI: buffer %p (%u bytes) is not DMA-able and no bounce buffer is free", buf, bytes);
+        ahci_slot_free(ctx, 1u << slot);
+        ctx->sync_waiters--;
+        return -1;
+    }
+    return slot;
+}
 
-        lba += n; in += n * bsz; count -= n;
+static bool ahci_cmd_exec(ahci_port_ctx_t* ctx, uint32_t slot, const char* what)
+{
+    bool ok;
+    if (ahci_cmd_issue(ctx, slot, false)) {
+        ok = ahci_cmd_wait(ctx, 1u << slot, what);
+    } else {
+        ahci_slot_t* s = &ctx->slots[slot];
+        ahci_prdt_finish(s->buf, s->bytes, s->is_write, false, &s->bounce);
+        ahci_slot_free(ctx, 1u << slot);
+        ok = false;
     }
+    ctx->sync_waiters--;
+    if (ctx->queue_head) ahci_port_service(ctx);
+    return ok;
+}
+
+static bool ahci_port_configure(ahci_port_ctx_t* ctx)
+{
+    volatile hba_port_t* p = ctx->port;
+    ahci_port_stop(p);
+
+    // Allocate CLB (1K aligned) and FB (256B aligned)
+    if (!ctx->clb.virt && !dma_alloc(&ctx->clb, 1024, 1024, 0, s_ahci_dma_limit)) return false;
+    if (!ctx->fb.virt && !dma_alloc(&ctx->fb, 256, 256, 0, s_ahci_dma_limit)) return false;
+    memset(ctx->clb.virt, 0, 1024);
+    memset(ctx->fb.virt, 0, 256);
+    uint64_t clb = ctx->clb.phys;
+    uint64_t fb  = ctx->fb.phys;
+    p->clb = (uint32_t)(clb & 0xFFFFFFFFu);
+    p->clbu = (uint32_t)((clb >> 32) & 0xFFFFFFFFu);
+    p->fb  = (uint32_t)(fb & 0xFFFFFFFFu);
+    p->fbu = (uint32_t)((fb >> 32) & 0xFFFFFFFFu);
+
+    // Command tables for every implemented slot (align to 128)
+    size_t tables = (size_t)ctx->slot_count * AHCI_CMD_TABLE_STRIDE;
+    if (!ctx->ctba.virt && !dma_alloc(&ctx->ctba, tables, 128, 0, s_ahci_dma_limit)) return false;
+    memset(ctx->ctba.virt, 0, tables);
+    for (uint32_t slot = 0; slot < ctx->slot_count; ++slot) {
+        hba_cmd_header_t* hdr = ahci_slot_header(ctx, slot);
+        uint64_t ctba = ctx->ctba.phys + slot * AHCI_CMD_TABLE_STRIDE;
+        hdr->ctba = (uint32_t)(ctba & 0xFFFFFFFFu);
+        hdr->ctbau = (uint32_t)((ctba >> 32) & 0xFFFFFFFFu);
+    }
+    ctx->slot_mask = (ctx->slot_count >= 32) ? 0xFFFFFFFFu : ((1u << ctx->slot_count) - 1u);
+    ctx->ncq = false;
+    ctx->slots_busy = ctx->slots_active = ctx->slots_queued = ctx->slots_failed = 0;
+    ctx->queue_head = ctx->queue_tail = NULL;
+    ctx->sync_waiters = 0;
+    ctx->progress_ms = 0;
+    ctx->recover_pending = false;
+
+    // Clear pending interrupts
+    p->is = 0xFFFFFFFFu;
+
+    ahci_port_start(p);
+    ahci_dump_port(p, ctx->port_no, "after-start");
+    return true;
+}
+
+static bool ahci_issue_flush(ahci_port_ctx_t* ctx, uint8_t opcode)
+{
+    int slot = ahci_cmd_begin(ctx, false, false, NULL, 0);
+    if (slot < 0) return false;
+
+    fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)ahci_slot_table(ctx, (uint32_t)slot)->cfis;
+    cfis->fis_type = FIS_TYPE_REG_H2D;
+    cfis->c = 1;
+    cfis->command = opcode; // 0xEA FLUSH CACHE EXT or 0xE7 FLUSH CACHE
+    cfis->device = 1 << 6; // LBA mode
+
+    return ahci_cmd_exec(ctx, (uint32_t)slot, "FLUSH CACHE");
+}
+
+static bool ahci_blk_submit(struct BlockDevice* bdev, BlockRequest* req)
+{
+    ahci_port_ctx_t* ctx = (ahci_port_ctx_t*)bdev->driver_ctx;
+    if (!ctx) return false;
+
+    size_t flags = arch_irq_save();
+    req->next = NULL;
+    if (ctx->queue_tail) ctx->queue_tail->next = req;
+    else ctx->queue_head = req;
+    ctx->queue_tail = req;
+    ahci_queue_kick(ctx);
+    arch_irq_restore(flags);
     return true;
 }
 
+static void ahci_blk_poll(struct BlockDevice* bdev)
+{
+    ahci_port_ctx_t* ctx = (ahci_port_ctx_t*)bdev->driver_ctx;
+    if (ctx) ahci_port_service(ctx);
+}
+
 static bool ahci_blk_flush(struct BlockDevice* bdev)
 {
     ahci_port_ctx_t* ctx = (ahci_port_ctx_t*)bdev->driver_ctx;
     if (!ctx) return false;
+    // Önce kuyruktaki yazmalar biter; flush bir bariyerdir
+    ahci_queue_drain(ctx);
     // Try FLUSH CACHE EXT first; fall back to FLUSH CACHE if needed.
     if (ahci_issue_flush(ctx, 0xEA)) return true;
     return ahci_issue_flush(ctx, 0xE7);
 }
 
 static const BlockDeviceOps s_ahci_blk_ops = {
-    .read = ahci_blk_read,
-    .write = ahci_blk_write,
+    .read = BlockDevice_SyncRead,
+    .write = BlockDevice_SyncWrite,
     .flush = ahci_blk_flush,
+    .submit = ahci_blk_submit,
+    .poll = ahci_blk_poll,
 };
 
 // ---- AHCI ATAPI (CD/DVD) support (READ(12), 2048B sectors) ----
 static bool ahci_atapi_packet_cmd(ahci_port_ctx_t* ctx, const uint8_t* cdb, uint32_t cdb_len, void* buf, uint32_t byte_count, bool is_write)
 {
-    volatile hba_port_t* p = ctx->port;
-    // Wait if busy
-    {
-        uint32_t spin = 1000000;
-        while ((p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) && spin--) { asm volatile ("pause"); }
-        if (p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) {
-            ERROR("AHCI: ATAPI busy before PACKET (TFD=0x%08x)", p->tfd);
-            return false;
-        }
-    }
-
-    hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-    // Do NOT clear the header entirely, CTBA must remain valid.
-    // Ensure CTBA points to our command table.
-    uintptr_t ctba = (uintptr_t)ctx->ctba0;
-    hdr->ctba  = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-    hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
-    hdr->cfl = sizeof(fis_reg_h2d_t) / 4; // 5 dwords
-    hdr->a = 1; // ATAPI
-    hdr->w = is_write ? 1 : 0;
-    hdr->c = 1; // clear BSY on R_OK (safer for some controllers)
-    hdr->prdtl = (byte_count > 0) ? 1 : 0;
-    hdr->prdbc = 0;
-
-    hba_cmd_table_t* tbl = (hba_cmd_table_t*)ctx->ctba0;
-    memset(tbl, 0, sizeof(hba_cmd_table_t));
-
-    if (byte_count) {
-        uintptr_t bufp = (uintptr_t)buf;
-        tbl->prdt[0].dba = (uint32_t)((uint64_t)bufp & 0xFFFFFFFFu);
-        tbl->prdt[0].dbau = (uint32_t)(((uint64_t)bufp >> 32) & 0xFFFFFFFFu);
-        tbl->prdt[0].dbc_i = ((byte_count - 1) & 0x003FFFFFu) | (1u << 31);
-    }
+    int slot = ahci_cmd_begin(ctx, true, is_write, buf, byte_count);
+    if (slot < 0) return false;
+    ahci_slot_header(ctx, (uint32_t)slot)->c = 1; // clear BSY on R_OK (safer for some controllers)
 
     // PACKET CFIS
+    hba_cmd_table_t* tbl = ahci_slot_table(ctx, (uint32_t)slot);
     fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)tbl->cfis;
-    memset(cfis, 0, sizeof(*cfis));
     cfis->fis_type = FIS_TYPE_REG_H2D;
     cfis->c = 1;
     cfis->command = 0xA0; // PACKET
@@ -493,31 +843,8 @@ static bool ahci_atapi_packet_cmd(ahci_port_ctx_t* ctx, const uint8_t* cdb, uint
     // Copy CDB (12 or 10 bytes typical)
     memcpy(tbl->acmd, cdb, cdb_len);
 
-    // Issue command
-    p->is = 0xFFFFFFFFu;
-    mmio_wmb();
-    p->ci = 1u; // slot 0
-    LOG("AHCI: ATAPI PACKET issued (byte_count=%u, opcode=0x%02x CI=0x%08x)", byte_count, cdb ? cdb[0] : 0xFF, p->ci);
-
-    // Completion: prefer IRQ event
-    {
-        uint32_t spin = 5000000;
-        while (spin--) {
-            if ((p->ci & 1u) == 0) break;
-            if (ctx->irq_events) break;
-            if (p->is & HBA_PxIS_TFES) {
-                WARN("AHCI: ATAPI TFES (IS=0x%08x TFD=0x%08x)", p->is, p->tfd);
-                return false;
-            }
-            asm volatile ("pause");
-        }
-        ctx->irq_events = 0;
-        if (p->ci & 1u) {
-            ERROR("AHCI: ATAPI PACKET timeout (IS=0x%08x TFD=0x%08x PRDBC=%u)", p->is, p->tfd, hdr->prdbc);
-            return false;
-        }
-    }
-    return true;
+    LOG("AHCI: ATAPI PACKET issued (byte_count=%u, opcode=0x%02x slot=%d)", byte_count, cdb ? cdb[0] : 0xFF, slot);
+    return ahci_cmd_exec(ctx, (uint32_t)slot, "ATAPI PACKET");
 }
 
 static void ahci_atapi_request_sense(ahci_port_ctx_t* ctx)
@@ -587,59 +914,24 @@ static bool ahci_atapi_blk_read(struct BlockDevice* bdev, uint64_t lba, uint32_t
 
 static const BlockDeviceOps s_ahci_atapi_ops = {
     .read = ahci_atapi_blk_read,
-    .write = ahci_blk_write, // not supported for CDROM
+    .write = NULL, // not supported for CDROM
     .flush = ahci_blk_flush,
 };
 
 // ---- Geometry helpers ----
 static bool ahci_identify_ata(ahci_port_ctx_t* ctx, uint16_t* id512)
 {
-    volatile hba_port_t* p = ctx->port;
-    // Wait if busy
-    {
-        uint32_t spin = 1000000;
-        while ((p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) && spin--) { asm volatile ("hlt"); }
-        if (p->tfd & (HBA_PxTFD_BSY | HBA_PxTFD_DRQ)) return false;
-    }
-
-    hba_cmd_header_t* hdr = (hba_cmd_header_t*)ctx->clb_mem;
-    uintptr_t ctba = (uintptr_t)ctx->ctba0;
-    hdr->ctba  = (uint32_t)((uint64_t)ctba & 0xFFFFFFFFu);
-    hdr->ctbau = (uint32_t)(((uint64_t)ctba >> 32) & 0xFFFFFFFFu);
-    hdr->cfl = sizeof(fis_reg_h2d_t) / 4;
-    hdr->a = 0; // ATA
-    hdr->w = 0;
-    hdr->c = 1;
-    hdr->prdtl = 1;
-    hdr->prdbc = 0;
-
-    hba_cmd_table_t* tbl = (hba_cmd_table_t*)ctx->ctba0;
-    memset(tbl, 0, sizeof(hba_cmd_table_t));
+    int slot = ahci_cmd_begin(ctx, false, false, id512, 512);
+    if (slot < 0) return false;
+    ahci_slot_header(ctx, (uint32_t)slot)->c = 1;
 
-    uintptr_t bufp = (uintptr_t)id512;
-    tbl->prdt[0].dba = (uint32_t)((uint64_t)bufp & 0xFFFFFFFFu);
-    tbl->prdt[0].dbau = (uint32_t)(((uint64_t)bufp >> 32) & 0xFFFFFFFFu);
-    tbl->prdt[0].dbc_i = (512 - 1) | (1u << 31);
-
-    fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)tbl->cfis;
-    memset(cfis, 0, sizeof(*cfis));
+    fis_reg_h2d_t* cfis = (fis_reg_h2d_t*)ahci_slot_table(ctx, (uint32_t)slot)->cfis;
     cfis->fis_type = FIS_TYPE_REG_H2D;
     cfis->c = 1;
     cfis->command = 0xEC; // IDENTIFY DEVICE
     cfis->device = 1 << 6; // LBA mode
 
-    p->is = 0xFFFFFFFFu;
-    mmio_wmb();
-    p->ci = 1u;
-
-    uint32_t spin = 5000000;
-    while (spin--) {
-        if ((p->ci & 1u) == 0) break;
-        if (p->is & HBA_PxIS_TFES) return false;
-        asm volatile ("pause"); 
-    }
-    if (p->ci & 1u) return false;
-    return true;
+    return ahci_cmd_exec(ctx, (uint32_t)slot, "IDENTIFY");
 }
 
 static bool ahci_atapi_read_capacity(ahci_port_ctx_t* ctx, uint32_t* last_lba, uint32_t* block_len)
@@ -695,10 +987,8 @@ static void ahci_probe_controller(void)
     if (hba->bohc & HBA_BOHC_BOS) {
         LOG("AHCI: BOHC BIOS-owned detected; requesting OS ownership");
         hba->bohc |= HBA_BOHC_OOS;
-        // Spec allows BIOS up to 1 second typically; we spin bounded
-        uint32_t spin = 5000000; // ~ a few ms worth of MMIO polls
-        while ((hba->bohc & HBA_BOHC_BOS) && spin--) { asm volatile ("hlt"); }
-        if (hba->bohc & HBA_BOHC_BOS) {
+        // 25 ms içinde BIOS bırakmalı; BOHC.BB ile 2 saniyeye kadar uzayabilir
+        if (!ahci_wait_reg(&hba->bohc, HBA_BOHC_BOS, 0, AHCI_BOHC_TIMEOUT_MS)) {
             WARN("AHCI: BIOS did not release ownership; continuing anyway");
         } else {
             LOG("AHCI: BOHC ownership transferred to OS");
@@ -714,6 +1004,7 @@ static void ahci_probe_controller(void)
     uint32_t vs  = hba->vs;
     uint32_t pi  = hba->pi;
     LOG("AHCI: ABAR=%p CAP=0x%08x VS=%u.%u PI=0x%08x", (void*)hba, cap, (vs >> 16) & 0xFFFF, vs & 0xFFFF, pi);
+    s_ahci_dma_limit = (cap & HBA_CAP_S64A) ? DMA_ADDR_ANY : DMA_ADDR_32BIT;
 
     // Register legacy INTx interrupt handler (best-effort) before port scan
     uint8_t irq_line = PCI_ConfigRead8(dev->bus, dev->device, dev->function, 0x3C);
@@ -721,20 +1012,22 @@ static void ahci_probe_controller(void)
         s_ahci_irq_line = irq_line;
         extern void ahci_isr_stub(void);
         irq_controller->register_handler(irq_line, ahci_isr_stub);
-        irq_controller->disable(irq_line);
+        irq_controller->enable(irq_line);
+        s_ahci_irq_live = true;
         LOG("AHCI: Registered IRQ handler on IRQ%u", irq_line);
     } else {
         WARN("AHCI: No legacy IRQ line reported; continuing with polling");
     }
 
     // Iterate ports implemented
+    bool probed = false;
     for (uint8_t i = 0; i < 32; ++i) {
         if ((pi & (1u << i)) == 0) continue;
         volatile hba_port_t* p = &hba->ports[i];
 
         ahci_port_ctx_t* ctx = &s_ports[i];
         ctx->port = p; ctx->port_no = i; ctx->blk = NULL;
-        ctx->irq_events = 0;
+        ctx->slot_count = (uint8_t)HBA_CAP_NCS(cap);
         if (!ahci_port_configure(ctx)) {
             WARN("AHCI: Port %u configuration failed", i);
             continue;
@@ -744,7 +1037,7 @@ static void ahci_probe_controller(void)
 
         // Issue COMRESET and wait a bit for device detection
         ahci_port_comreset(p);
-        for (volatile int dly = 0; dly < 100000; ++dly) asm volatile ("pause"); // small settle
+        (void)ahci_wait_reg(&p->ssts, HBA_SSTS_DET_MASK, HBA_DET_PRESENT, AHCI_LINK_TIMEOUT_MS);
 
         uint32_t ssts = p->ssts;
         uint8_t det = (uint8_t)(ssts & HBA_SSTS_DET_MASK);
@@ -753,6 +1046,7 @@ static void ahci_probe_controller(void)
         uint32_t sig = p->sig;
         LOG("AHCI: Port %u SSTS=0x%08x DET=%u SPD=%u IPM=%u SIG=0x%08x (%s)", i, ssts, det, spd, ipm, sig, sig_to_str(sig));
         if (det != HBA_DET_PRESENT) continue;
+        probed = true;
 
         // Register BlockDevice for ATA disks
         if (sig == SATA_SIG_ATA) {
@@ -772,6 +1066,14 @@ static void ahci_probe_controller(void)
                 }
                 total = lba48 ? lba48_cnt : lba28;
                 LOG("AHCI: IDENTIFY -> sector=%u total=%u (lba48=%d)", bsz, (unsigned)total, (int)lba48);
+                // NCQ: word 76 bit 8 destek, word 75 [4:0] kuyruk derinliği - 1
+                uint32_t depth = ctx->slot_count;
+                if ((cap & HBA_CAP_SNCQ) && id[76] != 0xFFFF && (id[76] & (1u << 8))) {
+                    if ((uint32_t)(id[75] & 0x1F) + 1u < depth) depth = (uint32_t)(id[75] & 0x1F) + 1u;
+                    ctx->slot_mask = (depth >= 32) ? 0xFFFFFFFFu : ((1u << depth) - 1u);
+                    ctx->ncq = true;
+                }
+                LOG("AHCI: Port %u %s, %u command slots", i, ctx->ncq ? "NCQ enabled" : "no NCQ", depth);
             } else {
                 WARN("AHCI: IDENTIFY ATA failed; using defaults");
             }
@@ -779,6 +1081,15 @@ static void ahci_probe_controller(void)
             char* nm = (char*)malloc(8);
             if (nm) { nm[0]='a'; nm[1]='h'; nm[2]='c'; nm[3]='i'; nm[4]='0'+(i%10); nm[5]='\0'; }
             ctx->blk = BlockDevice_Register(nm ? nm : "ahci", BLKDEV_TYPE_DISK, bsz, total, &s_ahci_blk_ops, ctx);
+            if (ctx->blk) {
+                // Zamanlayıcı birleşik istekleri tek komuta sığacak kadar büyütür
+                ctx->blk->max_transfer_blocks = AHCI_MAX_SECTORS;
+                ctx->blk->max_segments = AHCI_PRDT_MAX;
+                ctx->blk->async_submit = true; // submit komutu verip döner
+                uint16_t depth = 0;
+                for (uint32_t m = ctx->slot_mask; m; m &= m - 1) depth++;
+                ctx->blk->queue_depth = depth;
+            }
         } else if (sig == SATA_SIG_ATAPI) {
             uint32_t last=0, blen=2048;
             (void)ahci_atapi_read_capacity(ctx, &last, &blen);
@@ -790,7 +1101,15 @@ static void ahci_probe_controller(void)
         }
     }
 
-    // (IRQ already registered earlier)
+    // Probe komutları hiç kesme getirmediyse hat yönlendirilmemiştir; yoklamaya dönülür
+    if (s_ahci_irq_live && s_ahci_irq_count == 0 && probed) {
+        WARN("AHCI: No interrupt seen on IRQ%u during probe; falling back to polling", s_ahci_irq_line);
+        s_ahci_irq_live = false;
+        irq_controller->disable(s_ahci_irq_line);
+    }
+    for (uint8_t i = 0; i < 32; ++i) {
+        if (s_ports[i].blk) s_ports[i].blk->irq_completion = s_ahci_irq_live;
+    }
 }
 
 bool ahci_init(void)
@@ -1,9 +1,10 @@
-// Legacy ATA (PATA/ATAPI) driver with PIO support for HDD/SSD and CD/DVD
+// Legacy ATA (PATA/ATAPI) driver: bus-master DMA for disks (PIO fallback), PIO for CD/DVD
 #include <driver/DriverBase.h>
 #include <driver/ata/ata.h>
 #include <arch.h>
 #include <debug/debug.h>
 #include <memory/memory.h>
+#include <memory/dma.h>
 #include <storage/BlockDevice.h>
 #include <pci/PCI.h>
 #include <irq/IRQ.h>
@@ -12,18 +13,33 @@ static ata_device_t s_ata_devs[4]; // primary: master/slave, secondary: master/s
 static BlockDevice* s_ata_blkdevs[4];
 static bool s_ata_controller_present = false;
 static volatile uint8_t s_ata_irq_event[2] = {0,0}; // [0]=primary (IRQ14), [1]=secondary (IRQ15)
+static volatile uint32_t s_ata_irq_count[2] = {0,0}; // probe sırasında hattın çalıştığını doğrulamak için
 
 typedef struct {
     uint16_t io_base;
     uint16_t ctrl_base;
     uint8_t  irq_compat; // 14 or 15 in compatibility mode; 0xFF otherwise
     uint16_t bm_base;     // Bus Master IDE base for this channel (0 if unavailable)
-    ata_prd_t* prdt;      // PRD table (virt == phys under identity mapping)
+    DmaBuffer prdt;       // PRD table (ATA_PRD_MAX entries, below 4 GiB)
+    BlockRequest* queue_head; // Bekleyen asenkron istekler (FIFO)
+    BlockRequest* queue_tail;
+    BlockRequest* dma_req;    // DMA'sı süren istek; NULL: kanal boşta
+    uint32_t dma_sects;
+    void* dma_buf;            // bounce kullanılıyorsa verinin asıl yeri
+    uint32_t dma_bytes;
+    bool dma_write;
+    DmaBuffer dma_bounce;
+    uint32_t dma_spin;
+    uint64_t dma_start_ms;
+    uint32_t pio_sects;       // DMA'sı başarısız baş parça; görev bağlamında PIO ile yinelenir
+    bool irq_live;            // DMA bitişi IRQ14/15'ten gelir; bekleyenler uyur
+    volatile bool busy;       // ata_channel_service çalışıyor ya da kanal PIO'ya ayrıldı
+    volatile bool rerun;      // meşgulken gelen servis isteği (kesme ya da submit)
 } ata_channel_t;
 
 static ata_channel_t s_channels[2] = {
-    { ATA_PRIM_IO, ATA_PRIM_CTRL, 14, 0, NULL },
-    { ATA_SEC_IO,  ATA_SEC_CTRL,  15, 0, NULL }
+    { .io_base = ATA_PRIM_IO, .ctrl_base = ATA_PRIM_CTRL, .irq_compat = 14 },
+    { .io_base = ATA_SEC_IO,  .ctrl_base = ATA_SEC_CTRL,  .irq_compat = 15 }
 };
 
 static uint16_t s_bmide_base = 0; // BAR4 (I/O)
@@ -37,6 +53,15 @@ static inline void ata_delay_400ns(uint16_t ctrl_base)
     (void)inb((uint16_t)(ctrl_base + ATA_REG_ALTSTATUS));
 }
 
+// i386'da 64-bit okuma iki parçadır
+static inline uint64_t ata_now(void)
+{
+    size_t flags = arch_irq_save();
+    uint64_t now = uptimeMs;
+    arch_irq_restore(flags);
+    return now;
+}
+
 static inline uint8_t ata_status(uint16_t io_base)
 {
     return inb((uint16_t)(io_base + ATA_REG_STATUS));
@@ -98,9 +123,11 @@ static void ata_setup_channels_from_pci(void)
         s_bmide_base = (uint16_t)ide->bars[4].address;
         s_channels[0].bm_base = s_bmide_base + 0x00;
         s_channels[1].bm_base = s_bmide_base + ATA_BM_CH_SECONDARY;
-        // Allocate small PRDT for each channel (up to 4 entries suffices for <= 256 KiB, 64KiB boundary aware)
-        s_channels[0].prdt = (ata_prd_t*)malloc_aligned(16, sizeof(ata_prd_t) * 4);
-        s_channels[1].prdt = (ata_prd_t*)malloc_aligned(16, sizeof(ata_prd_t) * 4);
+        // PRDT for each channel: dword aligned, must not cross a 64 KiB boundary, 32-bit address
+        for (int ch = 0; ch < 2; ++ch) {
+            if (!s_channels[ch].prdt.virt)
+                dma_alloc(&s_channels[ch].prdt, sizeof(ata_prd_t) * ATA_PRD_MAX, 4, DMA_BOUNDARY_64K, DMA_ADDR_32BIT);
+        }
         LOG("ATA: BMIDE present at %x (PRDT allocated)", s_bmide_base);
     } else {
         LOG("ATA: BMIDE (BAR4) not present; using PIO only");
@@ -111,52 +138,110 @@ static inline uint16_t ata_bm_reg_cmd(uint8_t ch)    { return (uint16_t)(s_chann
 static inline uint16_t ata_bm_reg_stat(uint8_t ch)   { return (uint16_t)(s_channels[ch].bm_base + ATA_BM_REG_STATUS); }
 static inline uint16_t ata_bm_reg_prdt(uint8_t ch)   { return (uint16_t)(s_channels[ch].bm_base + ATA_BM_REG_PRDT); }
 
-static uint32_t ata_build_prdt(uint8_t ch, void* buf, uint32_t bytes)
-{
-    ata_prd_t* prdt = s_channels[ch].prdt;
-    if (!prdt) return 0;
-    uint32_t built = 0;
-    uint32_t remaining = bytes;
-    uintptr_t p = (uintptr_t)buf; // phys==virt
-    int idx = 0;
-    while (remaining && idx < 4) {
-        // Do not cross 64 KiB boundary per PRD entry
-        uint32_t offset_in_64k = (uint32_t)(p & 0xFFFFu);
-        uint32_t space = 0x10000u - offset_in_64k;
-        uint32_t chunk = (remaining < space) ? remaining : space;
-        // PRD count: 0 means 64KiB
-        prdt[idx].base = (uint32_t)p;
-        prdt[idx].byte_count = (uint16_t)((chunk & 0xFFFFu) ? (chunk & 0xFFFFu) : 0);
-        prdt[idx].flags = 0x0000;
-        built += chunk;
-        remaining -= chunk;
-        p += chunk;
-        idx++;
-    }
-    if (idx == 0) return 0;
-    prdt[idx - 1].flags |= 0x8000; // EOT
-    return built;
-}
-
-static bool ata_dma_rw(ata_device_t* dev, uint64_t lba, uint16_t sects, void* buffer, bool is_write)
+// DMA parçalarını PRD tablosuna yazar; son girdi tabloyu bitirir
+static void ata_prdt_write(uint8_t ch, const DmaSegment* segs, uint32_t count)
 {
-    int ch = ata_channel_from_io(dev->io_base);
-    if (ch < 0) return false;
-    if (s_channels[ch].bm_base == 0 || s_channels[ch].prdt == NULL) return false;
+    ata_prd_t* prdt = (ata_prd_t*)s_channels[ch].prdt.virt;
+    for (uint32_t i = 0; i < count; ++i) {
+        prdt[i].base = (uint32_t)segs[i].phys;
+        prdt[i].byte_count = (uint16_t)(segs[i].length & 0xFFFFu); // 0: 64 KiB
+        prdt[i].flags = 0x0000;
+    }
+    if (count) prdt[count - 1].flags |= 0x8000; // EOT
+}
 
-    uint32_t bytes = (uint32_t)sects * 512u;
-    uint32_t prepared = ata_build_prdt((uint8_t)ch, buffer, bytes);
-    if (prepared != bytes) return false;
+// PRD adresi ve uzunluğu çift olmalıdır (bit 0 ayrılmış)
+static bool ata_segs_aligned(const DmaSegment* segs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        if ((segs[i].phys | segs[i].length) & 1u) return false;
+    return true;
+}
+
+// İsteğin verilmemiş kısmından PRD tablosunun alabildiği kadar bloğu (en fazla
+// ATA_DMA_MAX_SECTORS) scatter listesinin parçaları arasında geçerek eşler.
+// Parçalar 64 KiB sınırını geçmez ve 32-bit adreslenebilir. İlk blok doğrudan
+// eşlenemiyorsa (hizasız ya da 4 GiB üstü) bir bounce tamponu kadarı kopyalanarak
+// aktarılır. Kapsanan blok; 0: bounce havuzu boş.
+static uint32_t ata_prdt_setup_req(uint8_t ch, BlockRequest* req)
+{
+    ata_channel_t* c = &s_channels[ch];
+    bool is_write = req->op == BLKREQ_WRITE;
+    uint32_t max_blocks = req->count - req->issued;
+    if (max_blocks > ATA_DMA_MAX_SECTORS) max_blocks = ATA_DMA_MAX_SECTORS;
+
+    c->dma_bounce.virt = NULL;
+    c->dma_buf = NULL;
+    c->dma_bytes = 0;
+    c->dma_write = is_write;
+
+    DmaSegment segs[ATA_PRD_MAX];
+    uint32_t count = 0;
+    uint32_t blocks = 0;
+    while (blocks < max_blocks && count < ATA_PRD_MAX) {
+        uint32_t avail = 0;
+        void* buf = BlockRequest_BufferAt(req, req->issued + blocks, &avail);
+        if (!buf) break;
+        if (avail > max_blocks - blocks) avail = max_blocks - blocks;
+
+        size_t mapped = 0;
+        uint32_t got = (uint32_t)dma_map_partial(buf, (size_t)avail * 512u, DMA_BOUNDARY_64K, 0x10000u, DMA_ADDR_32BIT,
+                                                 segs + count, ATA_PRD_MAX - count, &mapped);
+        // Yalnızca tam bloklar alınır; son parça blok sınırında kesilir
+        uint32_t whole = (uint32_t)(mapped / 512u);
+        size_t keep = (size_t)whole * 512u;
+        size_t acc = 0;
+        uint32_t used = 0;
+        while (used < got && acc < keep) {
+            DmaSegment* seg = &segs[count + used++];
+            if (acc + seg->length > keep) seg->length = (uint32_t)(keep - acc);
+            acc += seg->length;
+        }
+        if (!ata_segs_aligned(segs + count, used)) break;
+
+        count += used;
+        blocks += whole;
+        if (whole < avail) break;
+    }
+
+    if (blocks) {
+        ata_prdt_write(ch, segs, count);
+        return blocks;
+    }
+
+    uint32_t avail = 0;
+    void* buf = BlockRequest_BufferAt(req, req->issued, &avail);
+    uint32_t n = DMA_BOUNCE_SIZE / 512u;
+    if (n > avail) n = avail;
+    if (n > max_blocks) n = max_blocks;
+    if (!buf || n == 0 || !dma_bounce_acquire(&c->dma_bounce)) return 0;
+
+    c->dma_buf = buf;
+    c->dma_bytes = n * 512u;
+    if (is_write) memcpy(c->dma_bounce.virt, buf, c->dma_bytes);
+    segs[0].phys = c->dma_bounce.phys;
+    segs[0].length = c->dma_bytes;
+    ata_prdt_write(ch, segs, 1);
+    return n;
+}
+
+// PRD tablosu hazırken DMA aktarımını başlatır ve hemen döner; bitişi IRQ ya da
+// ata_dma_poll bildirir, ata_dma_finish kapatır. sects 256'ya kadar (LBA28'de 0 = 256).
+static void ata_dma_start(ata_device_t* dev, uint8_t ch, uint64_t lba, uint16_t sects, bool is_write)
+{
+    ata_channel_t* c = &s_channels[ch];
+    c->dma_spin = 0;
+    c->dma_start_ms = ata_now();
 
     uint16_t io = dev->io_base;
     uint16_t ctl = dev->ctrl_base;
 
     // Program PRDT base
-    outl(ata_bm_reg_prdt((uint8_t)ch), (uint32_t)(uintptr_t)s_channels[ch].prdt);
+    outl(ata_bm_reg_prdt(ch), (uint32_t)c->prdt.phys);
 
     // Clear BM status (write 1 to clear IRQ and ERR)
-    uint8_t st = inb(ata_bm_reg_stat((uint8_t)ch));
-    outb(ata_bm_reg_stat((uint8_t)ch), (uint8_t)(st | ATA_BM_ST_IRQ | ATA_BM_ST_ERR));
+    uint8_t st = inb(ata_bm_reg_stat(ch));
+    outb(ata_bm_reg_stat(ch), (uint8_t)(st | ATA_BM_ST_IRQ | ATA_BM_ST_ERR));
 
     // Prepare drive registers
     if (dev->lba48_supported) {
@@ -184,13 +269,13 @@ static bool ata_dma_rw(ata_device_t* dev, uint64_t lba, uint16_t sects, void* bu
     }
 
     // Set BM command (direction + start)
-    uint8_t cmd = inb(ata_bm_reg_cmd((uint8_t)ch));
+    uint8_t cmd = inb(ata_bm_reg_cmd(ch));
     cmd &= ~ATA_BM_CMD_WRITE;
     if (is_write) cmd |= ATA_BM_CMD_WRITE; // direction
-    outb(ata_bm_reg_cmd((uint8_t)ch), cmd);
+    outb(ata_bm_reg_cmd(ch), cmd);
 
     // Start BM DMA engine
-    outb(ata_bm_reg_cmd((uint8_t)ch), (uint8_t)(cmd | ATA_BM_CMD_START));
+    outb(ata_bm_reg_cmd(ch), (uint8_t)(cmd | ATA_BM_CMD_START));
 
     // Issue ATA command
     if (dev->lba48_supported) {
@@ -198,26 +283,37 @@ static bool ata_dma_rw(ata_device_t* dev, uint64_t lba, uint16_t sects, void* bu
     } else {
         outb((uint16_t)(io + ATA_REG_COMMAND), is_write ? ATA_CMD_WRITE_DMA : ATA_CMD_READ_DMA);
     }
+}
 
-    // Wait for completion by polling BM status IRQ or ATA status
-    uint32_t spin = 5000000;
-    bool ok = false;
-    while (spin--) {
-        uint8_t bst = inb(ata_bm_reg_stat((uint8_t)ch));
-        if (bst & ATA_BM_ST_ERR) { ok = false; break; }
-        if (bst & ATA_BM_ST_IRQ) { ok = true; break; }
-    }
+// 0: sürüyor, 1: bitti, -1: BM hatası
+static int ata_dma_poll(uint8_t ch)
+{
+    uint8_t bst = inb(ata_bm_reg_stat(ch));
+    if (bst & ATA_BM_ST_ERR) return -1;
+    if (bst & ATA_BM_ST_IRQ) return 1;
+    return 0;
+}
+
+// Motoru durdurur, cihaz durumunu denetler ve bounce verisini taşır
+static bool ata_dma_finish(uint8_t ch, bool ok)
+{
+    ata_channel_t* c = &s_channels[ch];
 
     // Stop BM DMA engine
-    cmd = inb(ata_bm_reg_cmd((uint8_t)ch));
-    outb(ata_bm_reg_cmd((uint8_t)ch), (uint8_t)(cmd & ~ATA_BM_CMD_START));
+    uint8_t cmd = inb(ata_bm_reg_cmd(ch));
+    outb(ata_bm_reg_cmd(ch), (uint8_t)(cmd & ~ATA_BM_CMD_START));
 
     // Clear IRQ and check device status
-    uint8_t bst = inb(ata_bm_reg_stat((uint8_t)ch));
-    outb(ata_bm_reg_stat((uint8_t)ch), (uint8_t)(bst | ATA_BM_ST_IRQ | ATA_BM_ST_ERR));
+    uint8_t bst = inb(ata_bm_reg_stat(ch));
+    outb(ata_bm_reg_stat(ch), (uint8_t)(bst | ATA_BM_ST_IRQ | ATA_BM_ST_ERR));
 
-    uint8_t st2 = inb((uint16_t)(io + ATA_REG_STATUS));
+    uint8_t st2 = inb((uint16_t)(c->io_base + ATA_REG_STATUS));
     if (st2 & (ATA_SR_ERR | ATA_SR_DF)) ok = false;
+
+    if (c->dma_bounce.virt) {
+        if (ok && !c->dma_write) memcpy(c->dma_buf, c->dma_bounce.virt, c->dma_bytes);
+        dma_bounce_release(&c->dma_bounce);
+    }
     return ok;
 }
 
@@ -337,6 +433,55 @@ static bool ata_wait_drq_set(uint16_t io, uint32_t spin)
     return false;
 }
 
+static bool ata_set_features(ata_device_t* dev, uint8_t feature, uint8_t count)
+{
+    uint16_t io = dev->io_base;
+    uint16_t ctl = dev->ctrl_base;
+    outb((uint16_t)(io + ATA_REG_HDDEVSEL), (uint8_t)(0xA0 | (dev->drive << 4)));
+    ata_delay_400ns(ctl);
+    outb((uint16_t)(io + ATA_REG_FEATURES), feature);
+    outb((uint16_t)(io + ATA_REG_SECCOUNT0), count);
+    outb((uint16_t)(io + ATA_REG_COMMAND), ATA_CMD_SET_FEATURES);
+    ata_delay_400ns(ctl);
+    if (!ata_wait_not_busy(io, 1000000)) return false;
+    return (ata_status(io) & (ATA_SR_ERR | ATA_SR_DF)) == 0;
+}
+
+// IDENTIFY'dan cihazın ve kablonun desteklediği en hızlı DMA kipini seçer ve
+// SET FEATURES ile cihaza bildirir. Kanalın zamanlama yazmaçları denetleyiciye
+// özgüdür; firmware'in ayarı kullanılır. Kip kurulamazsa cihaz PIO'da kalır.
+static void ata_select_dma_mode(ata_device_t* dev, uint8_t ch)
+{
+    ata_channel_t* c = &s_channels[ch];
+    dev->dma_mode = ATA_DMA_MODE_NONE;
+    if (dev->type != ATA_TYPE_ATA || !c->bm_base || !c->prdt.virt) return;
+    const uint16_t* id = dev->identify;
+    if ((id[49] & (1u << 8)) == 0) return; // DMA desteklenmiyor
+
+    uint8_t mode = ATA_DMA_MODE_NONE;
+    if (id[53] & (1u << 2)) { // word 88 geçerli
+        uint8_t udma = (uint8_t)(id[88] & 0x7F);
+        if ((id[93] & (1u << 13)) == 0) udma &= 0x07; // UDMA3 ve üstü 80 damarlı kablo ister
+        for (int m = 6; m >= 0 && mode == ATA_DMA_MODE_NONE; --m)
+            if (udma & (1u << m)) mode = (uint8_t)(ATA_XFER_MODE_UDMA | m);
+    }
+    for (int m = 2; m >= 0 && mode == ATA_DMA_MODE_NONE; --m)
+        if (id[63] & (1u << m)) mode = (uint8_t)(ATA_XFER_MODE_MWDMA | m);
+    if (mode == ATA_DMA_MODE_NONE) return;
+
+    if (!ata_set_features(dev, ATA_FEATURE_SET_XFER_MODE, mode)) {
+        WARN("ATA: SET FEATURES transfer mode 0x%02x failed; using PIO", mode);
+        return;
+    }
+    dev->dma_mode = mode;
+    // Sürücünün DMA'ya hazır bitini işaretle (IRQ/ERR bitleri yazınca silinir, korunur)
+    uint8_t bst = inb((uint16_t)(c->bm_base + ATA_BM_REG_STATUS));
+    bst &= (uint8_t)~(ATA_BM_ST_IRQ | ATA_BM_ST_ERR);
+    outb((uint16_t)(c->bm_base + ATA_BM_REG_STATUS), (uint8_t)(bst | (dev->drive ? ATA_BM_ST_DRV1_DMA : ATA_BM_ST_DRV0_DMA)));
+    LOG("ATA: %s %s using %s%u", ch == 0 ? "primary" : "secondary", dev->drive == 0 ? "master" : "slave",
+        (mode & ATA_XFER_MODE_UDMA) ? "UDMA" : "MWDMA", mode & 0x07);
+}
+
 static bool ata_pio_read28(ata_device_t* dev, uint32_t lba, uint8_t count, void* buffer)
 {
     if (count == 0) return true;
@@ -466,19 +611,29 @@ static bool ata_pio_write48(ata_device_t* dev, uint64_t lba, uint16_t count, con
     return true;
 }
 
+static void ata_channel_service(uint8_t ch, bool task);
+
+// Status okunarak cihaz kesmesi onaylanır. DMA bitişi BM status'ta kalır; kanal
+// servisi onu görüp isteği tamamlar ve sıradaki parçayı verir.
+static void ata_channel_irq(uint8_t ch)
+{
+    ata_channel_t* c = &s_channels[ch];
+    (void)inb((uint16_t)(c->io_base + ATA_REG_STATUS));
+    s_ata_irq_event[ch] = 1;
+    s_ata_irq_count[ch]++;
+    if (c->irq_live) ata_channel_service(ch, false);
+}
+
 // IRQ handlers for primary (IRQ14) and secondary (IRQ15) channels
 void ata_irq14(void)
 {
-    // Read status to acknowledge device interrupt, then flag event
-    (void)inb((uint16_t)(ATA_PRIM_IO + ATA_REG_STATUS));
-    s_ata_irq_event[0] = 1;
+    ata_channel_irq(0);
     if (irq_controller && irq_controller->acknowledge) irq_controller->acknowledge(14);
 }
 
 void ata_irq15(void)
 {
-    (void)inb((uint16_t)(ATA_SEC_IO + ATA_REG_STATUS));
-    s_ata_irq_event[1] = 1;
+    ata_channel_irq(1);
     if (irq_controller && irq_controller->acknowledge) irq_controller->acknowledge(15);
 }
 
@@ -613,82 +768,235 @@ static bool ata_atapi_read_blocks(ata_device_t* dev, uint32_t lba, uint32_t bloc
     return false;
 }
 
-// BlockDevice ops wrappers
-static bool ata_blk_read(struct BlockDevice* bdev, uint64_t lba, uint32_t count, void* buf)
+// ---- Asynchronous request queue (ATA disks) ----
+// Kanal başına tek DMA komutu sürer; bitişi IRQ14/15 (hat yoksa yoklama) bildirir
+// ve sıradaki verilir. PIO yalnızca DMA kurulamayan (kip yok, bounce havuzu boş)
+// ya da hata alan parçalar için senkron kullanılır.
+static bool ata_pio_rw(ata_device_t* dev, uint64_t lba, uint32_t n, void* buf, bool is_write)
 {
-    ata_device_t* dev = (ata_device_t*)bdev->driver_ctx;
-    if (!dev) return false;
-    if (dev->type == ATA_TYPE_ATA) {
-        if (bdev->logical_block_size != 512) return false;
-        if ((lba >> 28) != 0 && !dev->lba48_supported) return false;
-        uint8_t* out = (uint8_t*)buf;
-        while (count) {
-            // Prefer BMIDE DMA when available; fall back to PIO
-            uint32_t nmax = dev->lba48_supported ? 65535u : 255u;
-            uint32_t n = (count > nmax) ? nmax : count;
-            if (s_bmide_base && ata_dma_rw(dev, lba, (uint16_t)n, out, false)) {
-                lba += n; out += n * 512u; count -= n;
-            } else {
-                if (dev->lba48_supported) {
-                    uint16_t nn = (uint16_t)n;
-                    if (!ata_pio_read48(dev, lba, nn, out)) return false;
-                    lba += nn; out += (uint32_t)nn * 512u; count -= nn;
+    uint32_t nmax = dev->lba48_supported ? 65535u : 255u;
+    uint8_t* p = (uint8_t*)buf;
+    while (n) {
+        uint32_t k = n > nmax ? nmax : n;
+        bool ok;
+        if (dev->lba48_supported) {
+            ok = is_write ? ata_pio_write48(dev, lba, (uint16_t)k, p)
+                          : ata_pio_read48(dev, lba, (uint16_t)k, p);
+        } else {
+            ok = is_write ? ata_pio_write28(dev, (uint32_t)lba, (uint8_t)k, p)
+                          : ata_pio_read28(dev, (uint32_t)lba, (uint8_t)k, p);
+        }
+        if (!ok) return false;
+        lba += k;
+        p += (size_t)k * 512u;
+        n -= k;
+    }
+    return true;
+}
+
+// İsteğin issued'dan başlayan n bloğunu scatter listesi boyunca PIO ile aktarır
+static bool ata_pio_req(ata_device_t* dev, BlockRequest* req, uint32_t n)
+{
+    uint32_t done = 0;
+    while (done < n) {
+        uint32_t avail = 0;
+        void* buf = BlockRequest_BufferAt(req, req->issued + done, &avail);
+        if (!buf) return false;
+        if (avail > n - done) avail = n - done;
+        if (!ata_pio_rw(dev, req->lba + req->issued + done, avail, buf, req->op == BLKREQ_WRITE)) return false;
+        done += avail;
+    }
+    return true;
+}
+
+// task false ise kesme bağlamı olabilir: yalnızca DMA başlatılır, PIO gereken parça
+// sıradaki görev bağlamı servisine (ata_blk_poll / BlockDevice_Wait) kalır
+static void ata_queue_kick(uint8_t ch, bool task)
+{
+    ata_channel_t* c = &s_channels[ch];
+    while (!c->dma_req && c->queue_head) {
+        BlockRequest* req = c->queue_head;
+        if (req->error || req->issued == req->count) {
+            size_t flags = arch_irq_save();
+            c->queue_head = req->next;
+            if (!c->queue_head) c->queue_tail = NULL;
+            req->next = NULL;
+            arch_irq_restore(flags);
+            if (req->error) {
+                ERROR("ATA: %s of %u sectors at LBA %llu failed", req->op == BLKREQ_WRITE ? "write" : "read",
+                      req->count, (unsigned long long)req->lba);
+            }
+            BlockRequest_Complete(req, !req->error);
+            continue;
+        }
+
+        ata_device_t* dev = (ata_device_t*)req->device->driver_ctx;
+        uint64_t lba = req->lba + req->issued;
+        if (!c->pio_sects && dev->dma_mode != ATA_DMA_MODE_NONE) {
+            uint32_t n = ata_prdt_setup_req(ch, req);
+            if (n) {
+                c->dma_req = req;
+                c->dma_sects = n;
+                ata_dma_start(dev, ch, lba, (uint16_t)n, req->op == BLKREQ_WRITE);
+                return;
+            }
+        }
+
+        if (!task) return;
+        uint32_t n = req->count - req->issued;
+        uint32_t nmax = dev->lba48_supported ? 65535u : 255u;
+        if (n > nmax) n = nmax;
+        if (c->pio_sects) n = c->pio_sects;
+        c->pio_sects = 0;
+        if (ata_pio_req(dev, req, n)) req->issued += n;
+        else req->error = true;
+    }
+}
+
+// Süren DMA'yı denetler ve kuyruğu ilerletir. Meşgulken (yeniden girişte, kesmeden
+// ya da kanal ayrılmışken) gelen çağrı kaybolmaz: sahibi kendi bağlamıyla bir tur
+// daha döner.
+static void ata_channel_service(uint8_t ch, bool task)
+{
+    ata_channel_t* c = &s_channels[ch];
+    size_t flags = arch_irq_save();
+    if (c->busy) {
+        c->rerun = true;
+        arch_irq_restore(flags);
+        return;
+    }
+    c->busy = true;
+    do {
+        c->rerun = false;
+        arch_irq_restore(flags);
+
+        if (c->dma_req) {
+            int r = ata_dma_poll(ch);
+            if (r == 0 && (++c->dma_spin > 5000000u || ata_now() - c->dma_start_ms > ATA_DMA_TIMEOUT_MS)) {
+                WARN("ATA: DMA timeout on channel %u (BM status 0x%02x)", ch, inb(ata_bm_reg_stat(ch)));
+                r = -1;
+            }
+            if (r != 0) {
+                BlockRequest* req = c->dma_req;
+                uint32_t n = c->dma_sects;
+                bool ok = ata_dma_finish(ch, r > 0);
+                c->dma_req = NULL;
+                // DMA hatasında parça PIO ile yeniden denenir (kick, görev bağlamında)
+                if (ok) {
+                    req->issued += n;
                 } else {
-                    uint32_t lba32 = (uint32_t)lba;
-                    uint8_t nn = (uint8_t)n;
-                    if (!ata_pio_read28(dev, lba32, nn, out)) return false;
-                    lba32 += nn; lba = lba32; out += (uint32_t)nn * 512u; count -= nn;
+                    WARN("ATA: DMA error on channel %u; retrying %u sectors at LBA %llu with PIO", ch, n,
+                         (unsigned long long)(req->lba + req->issued));
+                    c->pio_sects = n;
                 }
             }
         }
-        return true;
-    } else if (dev->type == ATA_TYPE_ATAPI) {
-        if (bdev->logical_block_size != 2048) return false;
-        uint8_t* out = (uint8_t*)buf;
-        while (count) {
-            uint32_t n = (count > 16) ? 16 : count; // reasonable chunk
-            if (!ata_atapi_read_blocks(dev, (uint32_t)lba, n, out)) return false;
-            lba += n; out += n * 2048u; count -= n;
+        ata_queue_kick(ch, task);
+
+        flags = arch_irq_save();
+    } while (c->rerun);
+    c->busy = false;
+    arch_irq_restore(flags);
+}
+
+// DMA bitene ya da bir kesme gelene kadar uyur; koşul kesmeler kapalıyken
+// denetlendiğinden uyanma kaçmaz. Kesme hattı yoksa yoklamaya döner.
+static void ata_channel_sleep(uint8_t ch)
+{
+    ata_channel_t* c = &s_channels[ch];
+    size_t flags = arch_irq_save();
+    if (c->irq_live && c->dma_req && arch_irq_wait(flags)) return;
+    arch_irq_restore(flags);
+    asm volatile ("pause");
+}
+
+static void ata_channel_drain(uint8_t ch)
+{
+    while (s_channels[ch].queue_head || s_channels[ch].dma_req) {
+        ata_channel_service(ch, true);
+        ata_channel_sleep(ch);
+    }
+}
+
+// Kanalı senkron PIO komutu için ayırır: kuyruk boşalır ve bırakılana kadar
+// servis (kesmeden gelen dahil) çalışmaz; bu arada gelen istekler kuyrukta bekler
+static void ata_channel_claim(uint8_t ch)
+{
+    ata_channel_t* c = &s_channels[ch];
+    for (;;) {
+        ata_channel_drain(ch);
+        size_t flags = arch_irq_save();
+        if (!c->busy && !c->queue_head && !c->dma_req) {
+            c->busy = true;
+            arch_irq_restore(flags);
+            return;
         }
-        return true;
+        arch_irq_restore(flags);
     }
-    return false;
 }
 
-static bool ata_blk_write(struct BlockDevice* bdev, uint64_t lba, uint32_t count, const void* buf)
+static void ata_channel_release(uint8_t ch)
+{
+    s_channels[ch].busy = false;
+    ata_channel_service(ch, true);
+}
+
+static bool ata_blk_submit(struct BlockDevice* bdev, BlockRequest* req)
 {
     ata_device_t* dev = (ata_device_t*)bdev->driver_ctx;
-    if (!dev) return false;
-    if (dev->type != ATA_TYPE_ATA) return false; // CDROM not supported
+    if (!dev || dev->type != ATA_TYPE_ATA) return false;
     if (bdev->logical_block_size != 512) return false;
-    if ((lba >> 28) != 0 && !dev->lba48_supported) return false;
-    const uint8_t* in = (const uint8_t*)buf;
-    while (count) {
-        uint32_t nmax = dev->lba48_supported ? 65535u : 255u;
-        uint32_t n = (count > nmax) ? nmax : count;
-        if (s_bmide_base && ata_dma_rw(dev, lba, (uint16_t)n, (void*)in, true)) {
-            lba += n; in += n * 512u; count -= n;
-        } else {
-            if (dev->lba48_supported) {
-                uint16_t nn = (uint16_t)n;
-                if (!ata_pio_write48(dev, lba, nn, in)) return false;
-                lba += nn; in += (uint32_t)nn * 512u; count -= nn;
-            } else {
-                uint32_t lba32 = (uint32_t)lba;
-                uint8_t nn = (uint8_t)n;
-                if (!ata_pio_write28(dev, lba32, nn, in)) return false;
-                lba32 += nn; lba = lba32; in += (uint32_t)nn * 512u; count -= nn;
-            }
-        }
-    }
+    if (((req->lba + req->count - 1) >> 28) != 0 && !dev->lba48_supported) return false;
+    int ch = ata_channel_from_io(dev->io_base);
+    if (ch < 0) return false;
+
+    ata_channel_t* c = &s_channels[ch];
+    size_t flags = arch_irq_save();
+    req->next = NULL;
+    if (c->queue_tail) c->queue_tail->next = req;
+    else c->queue_head = req;
+    c->queue_tail = req;
+    arch_irq_restore(flags);
+
+    // Kesmeden (flusher, tamamlanma geri çağrısı) gelinebilir; PIO beklemeye kalır
+    ata_channel_service((uint8_t)ch, false);
     return true;
 }
 
+static void ata_blk_poll(struct BlockDevice* bdev)
+{
+    ata_device_t* dev = (ata_device_t*)bdev->driver_ctx;
+    int ch = dev ? ata_channel_from_io(dev->io_base) : -1;
+    if (ch >= 0) ata_channel_service((uint8_t)ch, true);
+}
+
+// BlockDevice ops wrappers (ATAPI)
+static bool ata_blk_read(struct BlockDevice* bdev, uint64_t lba, uint32_t count, void* buf)
+{
+    ata_device_t* dev = (ata_device_t*)bdev->driver_ctx;
+    if (!dev || dev->type != ATA_TYPE_ATAPI) return false;
+    if (bdev->logical_block_size != 2048) return false;
+    int ch = ata_channel_from_io(dev->io_base);
+    if (ch >= 0) ata_channel_claim((uint8_t)ch);
+    uint8_t* out = (uint8_t*)buf;
+    bool ok = true;
+    while (count && ok) {
+        uint32_t n = (count > 16) ? 16 : count; // reasonable chunk
+        ok = ata_atapi_read_blocks(dev, (uint32_t)lba, n, out);
+        lba += n; out += n * 2048u; count -= n;
+    }
+    if (ch >= 0) ata_channel_release((uint8_t)ch);
+    return ok;
+}
+
 static bool ata_blk_flush(struct BlockDevice* bdev)
 {
     ata_device_t* dev = (ata_device_t*)bdev->driver_ctx;
     if (!dev) return false;
     if (dev->type != ATA_TYPE_ATA) return true; // nothing to flush on ATAPI
+    // Önce kuyruktaki yazmalar biter; flush bir bariyerdir
+    int ch = ata_channel_from_io(dev->io_base);
+    if (ch >= 0) ata_channel_claim((uint8_t)ch);
     uint16_t io = dev->io_base;
     uint16_t ctl = dev->ctrl_base;
 
@@ -700,14 +1008,22 @@ static bool ata_blk_flush(struct BlockDevice* bdev)
     outb((uint16_t)(io + ATA_REG_COMMAND), dev->lba48_supported ? ATA_CMD_FLUSH_CACHE_EXT : ATA_CMD_FLUSH_CACHE);
 
     // Poll until not busy and check errors
-    if (!ata_wait_not_busy(io, 2000000)) return false;
-    uint8_t st = inb((uint16_t)(io + ATA_REG_STATUS));
-    return (st & (ATA_SR_ERR | ATA_SR_DF)) == 0;
+    bool ok = ata_wait_not_busy(io, 2000000) && (inb((uint16_t)(io + ATA_REG_STATUS)) & (ATA_SR_ERR | ATA_SR_DF)) == 0;
+    if (ch >= 0) ata_channel_release((uint8_t)ch);
+    return ok;
 }
 
 static const BlockDeviceOps s_ata_blk_ops = {
+    .read = BlockDevice_SyncRead,
+    .write = BlockDevice_SyncWrite,
+    .flush = ata_blk_flush,
+    .submit = ata_blk_submit,
+    .poll = ata_blk_poll,
+};
+
+static const BlockDeviceOps s_ata_atapi_ops = {
     .read = ata_blk_read,
-    .write = ata_blk_write,
+    .write = NULL, // not supported for CDROM
     .flush = ata_blk_flush,
 };
 
@@ -747,6 +1063,22 @@ bool ata_init(void)
     ata_probe_channel(s_channels[0].io_base, s_channels[0].ctrl_base, 0);
     ata_probe_channel(s_channels[1].io_base, s_channels[1].ctrl_base, 1);
 
+    // DMA kiplerini seç. IDENTIFY kesme getirdiyse kanalın hattı çalışıyordur;
+    // getirmediyse (yönlendirilmemiş ya da kesmeler kapalı) DMA bitişi yoklanır.
+    for (uint8_t ch = 0; ch < 2; ++ch) {
+        bool dma = false;
+        for (uint8_t drv = 0; drv < 2; ++drv) {
+            ata_device_t* d = &s_ata_devs[ch * 2 + drv];
+            if (!d->present) continue;
+            ata_select_dma_mode(d, ch);
+            dma |= d->dma_mode != ATA_DMA_MODE_NONE;
+        }
+        if (!dma) continue;
+        s_channels[ch].irq_live = s_channels[ch].irq_compat != 0xFF && s_ata_irq_count[ch] != 0;
+        if (!s_channels[ch].irq_live)
+            WARN("ATA: No interrupt seen on %s channel; polling for DMA completion", ch == 0 ? "primary" : "secondary");
+    }
+
     // Register found devices as block devices (ATA disks + ATAPI CD/DVD)
     BlockDevice_InitRegistry();
     for (int i = 0; i < 4; ++i) {
@@ -757,6 +1089,16 @@ bool ata_init(void)
             uint32_t bsz = d->sector_size ? d->sector_size : 512;
             uint64_t total = d->total_sectors;
             s_ata_blkdevs[i] = BlockDevice_Register(name, BLKDEV_TYPE_DISK, bsz, total, &s_ata_blk_ops, d);
+            if (s_ata_blkdevs[i]) {
+                // Kanalda tek komut sürer. DMA komutu scatter listesi taşır; PIO tek tampon.
+                int ch = ata_channel_from_io(d->io_base);
+                bool dma = d->dma_mode != ATA_DMA_MODE_NONE;
+                s_ata_blkdevs[i]->max_transfer_blocks = dma ? ATA_DMA_MAX_SECTORS : (d->lba48_supported ? 65535u : 255u);
+                s_ata_blkdevs[i]->max_segments = dma ? ATA_PRD_MAX : 1;
+                s_ata_blkdevs[i]->queue_depth = 1;
+                s_ata_blkdevs[i]->irq_completion = dma && ch >= 0 && s_channels[ch].irq_live;
+                s_ata_blkdevs[i]->async_submit = dma; // PIO'lu aygıt işi görev bağlamında yapar
+            }
         } else if (d->type == ATA_TYPE_ATAPI) {
             // Discover capacity to report correct geometry
             uint32_t last=0, blen=2048;
@@ -764,7 +1106,7 @@ bool ata_init(void)
                 blen = 2048; last = 0; // still register; reads will work
             }
             const char* name = (i==0) ? "cd0" : (i==1) ? "cd1" : (i==2) ? "cd2" : "cd3";
-            s_ata_blkdevs[i] = BlockDevice_Register(name, BLKDEV_TYPE_CDROM, blen ? blen : 2048, (uint64_t)last + 1u, &s_ata_blk_ops, d);
+            s_ata_blkdevs[i] = BlockDevice_Register(name, BLKDEV_TYPE_CDROM, blen ? blen : 2048, (uint64_t)last + 1u, &s_ata_atapi_ops, d);
         }
     }
     return true; // not fatal if no devices
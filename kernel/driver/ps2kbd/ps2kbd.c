@@ -436,15 +436,17 @@ static int ps2kbd_stream_readChar(char* c) {
 
     KeyboardKeyEventData* event;
 
-    do {
+    for (;;) {
         event = (KeyboardKeyEventData*)buffer_pop(ps2_event_buffer);
         if (!event) {
             return -1;
         }
-    } while (event->isPressed == false || event->key == KEY_UNKNOWN);
+        if (event->isPressed && event->key != KEY_UNKNOWN) break;
+        buffer_free_data(event);
+    }
 
     *c = event->ascii;
-    free(event);
+    buffer_free_data(event);
     return 1;
 }
 
@@ -2,11 +2,13 @@
 #include <debug/debug.h>
 #include <machine/machine.h>
 #include <memory/pmm.h>
-#include <list.h>
 
 extern UINTN bs_map_key;
-
-extern List *memory_regions;
+extern UINTN bs_mr_memory_map_size;
+extern UINTN bs_mr_memory_map_capacity;
+extern EFI_MEMORY_DESCRIPTOR *bs_mr_memory_map;
+extern UINTN bs_mr_descriptor_size;
+extern uint32_t bs_mr_descriptor_version;
 
 EFI_SYSTEM_TABLE* efi_system_table = NULL;
 EFI_HANDLE efi_image_handle = NULL;
@@ -43,38 +45,48 @@ void efi_init(void) {
     LOG("EFI subsystem initialization complete");
 }
 
+// EFI BS code & data bölgeleri ExitBootServices'ten sonra boş bellektir
+static void efi_reclaim_boot_services_memory(void) {
+    size_t reclaimed = pmm_reclaim_regions(MemoryRegionType_EFI_BS_CODE);
+    reclaimed += pmm_reclaim_regions(MemoryRegionType_EFI_BS_DATA);
+    LOG("EFI boot services memory reclaimed: %zu KiB", reclaimed / 1024);
+}
+
 void efi_exit_boot_services() {
+    if (bs_map_key == 0) {
+        // Harita Multiboot2'den geldi; boot services'ten yükleyici çıkmış. EFI haritası
+        // etiketiyle geldiyse BS bölgeleri türleriyle durur ve yine geri kazanılır.
+        LOG("EFI boot services already exited by the loader");
+        efi_reclaim_boot_services_memory();
+        return;
+    }
+
     if (!efi_system_table || !efi_system_table->boot_services) {
         ERROR("Cannot exit EFI boot services: system table or boot services is NULL");
         return;
     }
 
-    if (bs_map_key == 0) {
-        ERROR("Cannot exit EFI boot services: map key is zero");
-        return;
+    EFI_BOOT_SERVICES* bs = efi_system_table->boot_services;
+    EFI_STATUS status = bs->exit_boot_services(efi_image_handle, bs_map_key);
+
+    if (status == EFI_INVALID_PARAMETER) {
+        // Harita bizim aldığımızdan beri değişmiş; spec'e göre yeniden al ve bir kez daha dene
+        bs_mr_memory_map_size = bs_mr_memory_map_capacity;
+        status = bs->get_memory_map(&bs_mr_memory_map_size, bs_mr_memory_map, &bs_map_key,
+                                    &bs_mr_descriptor_size, &bs_mr_descriptor_version);
+        if (status == EFI_SUCCESS)
+            status = bs->exit_boot_services(efi_image_handle, bs_map_key);
     }
 
-    EFI_STATUS status = efi_system_table->boot_services->exit_boot_services(
-        efi_image_handle, bs_map_key);
-    
     if (status != EFI_SUCCESS) {
+        // Firmware hâlâ bu bölgeleri kullanıyor; geri kazanma
         ERROR("Failed to exit EFI boot services: status code %lu", status);
-    } else {
-        LOG("Successfully exited EFI boot services");
+        return;
     }
+    LOG("Successfully exited EFI boot services");
 
     // After this point, boot services are no longer available
-    // After that set 'usable' EFI CODE & EFI DATA sections.
-
-    for (ListNode* node = memory_regions->head; node != NULL; node = node->next) {
-        MemoryRegion* region = (MemoryRegion*)node->data;
-        if (region->type == MemoryRegionType_EFI_BS_CODE || region->type == MemoryRegionType_EFI_BS_DATA) {
-            region->type = MemoryRegionType_USABLE;
-        }
-    }
-    
-    pmm_maintain(); // Rebuild free memory list after changes
-
+    efi_reclaim_boot_services_memory();
 }
 
 void efi_reset_system(EFI_RESET_TYPE reset_type) {
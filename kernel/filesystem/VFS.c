@@ -1,12 +1,15 @@
 #include <filesystem/VFS.h>
 #include <list.h>
 #include <memory/memory.h>
+#include <memory/objpool.h>
 #include <util/string.h>
 #include <debug/debug.h>
 #include <stream/FileStream.h>
+#include <storage/BlockCache.h>
 
 #define VFS_MAX_SEGMENTS (VFS_PATH_MAX / 2)
 #define VFS_DEFAULT_CACHE_CAPACITY 128
+#define VFS_CACHE_INLINE_PATH 96 // Bu uzunluğa kadar yollar entry içinde tutulur (strdup yok)
 
 struct VFSMount {
     char* path;
@@ -21,10 +24,12 @@ static List* s_mounts = NULL;
 static VFSMount* s_root_mount = NULL;
 
 typedef struct VFSCacheEntry {
-    char* path;
+    char* path;             // inline_path'i ya da uzun yollar için heap kopyasını gösterir
     VFSNode* node;
+    char inline_path[VFS_CACHE_INLINE_PATH];
 } VFSCacheEntry;
 
+static ObjectPool s_cache_entry_pool = OBJECT_POOL_STATIC(VFSCacheEntry, VFS_DEFAULT_CACHE_CAPACITY, true);
 static List* s_cache_entries = NULL;
 static size_t s_cache_capacity = VFS_DEFAULT_CACHE_CAPACITY;
 static size_t s_cache_hits = 0;
@@ -70,8 +75,8 @@ static bool vfs_cache_init(void)
 static void vfs_cache_cleanup_entry(VFSCacheEntry* entry)
 {
     if (!entry) return;
-    if (entry->path) free(entry->path);
-    free(entry);
+    if (entry->path && entry->path != entry->inline_path) free(entry->path);
+    object_pool_free(&s_cache_entry_pool, entry);
 }
 
 static void vfs_cache_clear(void)
@@ -212,14 +217,23 @@ static void vfs_cache_insert(const char* normalized_path, VFSNode* node)
         List_RemoveAt(s_cache_entries, tail_index);
     }
 
-    VFSCacheEntry* entry = (VFSCacheEntry*)malloc(sizeof(VFSCacheEntry));
+    VFSCacheEntry* entry = OBJECT_POOL_NEW(&s_cache_entry_pool, VFSCacheEntry);
     if (!entry) return;
 
-    entry->path = strdup(normalized_path);
-    if (!entry->path)
+    size_t path_len = strlen(normalized_path);
+    if (path_len < VFS_CACHE_INLINE_PATH)
     {
-        free(entry);
-        return;
+        memcpy(entry->inline_path, normalized_path, path_len + 1);
+        entry->path = entry->inline_path;
+    }
+    else
+    {
+        entry->path = strdup(normalized_path);
+        if (!entry->path)
+        {
+            object_pool_free(&s_cache_entry_pool, entry);
+            return;
+        }
     }
 
     entry->node = node;
@@ -489,6 +503,8 @@ VFSResult VFS_Unmount(const char* target)
             {
                 mount->fs->ops->unmount(mount->fs, mount->root);
             }
+            // Dosya sisteminin son yazmaları önbellekte kalmasın
+            if (!BlockCache_Sync(NULL)) WARN("VFS_Unmount: write-back failed for '%s'", normalized);
 
             free(mount->path);
             free(mount);
@@ -655,6 +671,7 @@ VFS_HANDLE VFS_Open(const char* path, uint32_t mode)
     handle->driver_handle = NULL;
     handle->mode = mode;
     handle->offset = 0;
+    memset(&handle->readahead, 0, sizeof(VFSReadAhead));
 
     if (node->ops && node->ops->open)
     {
@@ -692,6 +709,35 @@ static bool vfs_handle_can_read(VFS_HANDLE handle)
     return false;
 }
 
+// Okuma ardışıksa pencereyi büyütür ve önde kalan kısım yarım pencerenin altına
+// inince bir sonraki parçayı ister; ardışık değilse ön okumayı kapatır.
+static void vfs_readahead(VFS_HANDLE handle, uint64_t offset, uint64_t length)
+{
+    VFSReadAhead* ra = &handle->readahead;
+    uint64_t end = offset + length;
+    bool sequential = offset == ra->next_offset;
+    ra->next_offset = end;
+    if (!sequential)
+    {
+        ra->window = 0;
+        ra->ahead_end = 0;
+        return;
+    }
+    if (!handle->node->ops->readahead) return;
+
+    if (ra->window && ra->ahead_end >= end + ra->window / 2) return; // önde yeterince var
+    if (ra->window == 0)
+        ra->window = VFS_READAHEAD_MIN;
+    else if (ra->window * 2 <= VFS_READAHEAD_MAX)
+        ra->window *= 2;
+
+    uint64_t start = ra->ahead_end > end ? ra->ahead_end : end;
+    uint64_t target = end + ra->window;
+    if (start >= target) return;
+    handle->node->ops->readahead(handle->node, handle->driver_handle, start, target - start);
+    ra->ahead_end = target;
+}
+
 int64_t VFS_Read(VFS_HANDLE handle, void* buffer, size_t size)
 {
     if (!handle || !buffer || size == 0) return -1;
@@ -706,6 +752,7 @@ int64_t VFS_Read(VFS_HANDLE handle, void* buffer, size_t size)
                                                   size);
     if (read_bytes > 0)
     {
+        vfs_readahead(handle, handle->offset, (uint64_t)read_bytes);
         handle->offset += (uint64_t)read_bytes;
     }
     return read_bytes;
@@ -717,7 +764,12 @@ int64_t VFS_ReadAt(VFS_HANDLE handle, uint64_t offset, void* buffer, size_t size
     if (!vfs_handle_can_read(handle)) return -1;
     if (!handle->node || !handle->node->ops || !handle->node->ops->read)
         return -1;
-    return handle->node->ops->read(handle->node, handle->driver_handle, offset, buffer, size);
+    int64_t read_bytes = handle->node->ops->read(handle->node, handle->driver_handle, offset, buffer, size);
+    if (read_bytes > 0)
+    {
+        vfs_readahead(handle, offset, (uint64_t)read_bytes);
+    }
+    return read_bytes;
 }
 
 static bool vfs_handle_can_write(VFS_HANDLE handle)
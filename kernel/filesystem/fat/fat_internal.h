@@ -139,6 +139,8 @@ bool fat_volume_init(FATVolume* volume,
 bool fat_volume_probe_type(FATVolume* volume, const FAT_BootSector* bpb);
 bool fat_volume_read_sector(FATVolume* volume, uint32_t sector, void* buffer);
 bool fat_volume_read_cluster(FATVolume* volume, uint32_t cluster, void* buffer);
+// count ardışık kümeyi blok önbelleğine okumaya başlar
+void fat_volume_prefetch_clusters(FATVolume* volume, uint32_t cluster, uint32_t count);
 bool fat_volume_is_end(FATVolume* volume, uint32_t value);
 bool fat_volume_is_bad(FATVolume* volume, uint32_t value);
 uint32_t fat_volume_get_next_cluster(FATVolume* volume, uint32_t cluster);
@@ -4,6 +4,7 @@
 #include <memory/memory.h>
 #include <util/string.h>
 #include <debug/debug.h>
+#include <storage/BlockQueue.h>
 
 #ifndef MIN
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
@@ -28,6 +29,7 @@ static VFSResult fat_node_lookup(VFSNode* node, const char* name, VFSNode** out_
 static VFSResult fat_node_create(VFSNode* node, const char* name, VFSNodeType type, VFSNode** out_node);
 static VFSResult fat_node_remove(VFSNode* node, const char* name);
 static VFSResult fat_node_stat(VFSNode* node, VFSNodeInfo* out_info);
+static void     fat_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length);
 static bool     fat_probe(VFSFileSystem* fs, const VFSMountParams* params);
 static bool     fat_read_boot_sector(const VFSMountParams* params, FAT_BootSector* out_bpb, uint32_t* out_block_size);
 
@@ -42,6 +44,7 @@ static const VFSNodeOps s_fat_node_ops = {
     .create   = fat_node_create,
     .remove   = fat_node_remove,
     .stat     = fat_node_stat,
+    .readahead = fat_node_readahead,
 };
 
 static const VFSFileSystemOps s_fat_ops = {
@@ -476,6 +479,51 @@ static int64_t fatfs_read_file(FATNodeInfo* node, uint64_t offset, void* buffer,
     return (int64_t)total_read;
 }
 
+// Zincirde [offset, offset + length) aralığına düşen kümeleri ardışık gruplar
+// halinde önbelleğe ister
+static void fatfs_readahead_file(FATNodeInfo* node, uint64_t offset, uint64_t length)
+{
+    FATVolume* volume = node->volume;
+    if (!volume || node->first_cluster < 2 || offset >= node->size) return;
+    if (length > node->size - offset) length = node->size - offset;
+
+    uint32_t cluster_size = volume->cluster_size_bytes;
+    uint32_t first = (uint32_t)(offset / cluster_size);
+    uint32_t last = (uint32_t)((offset + length - 1) / cluster_size);
+
+    uint32_t cluster = node->first_cluster;
+    for (uint32_t i = 0; i < first; ++i)
+    {
+        cluster = fat_volume_get_next_cluster(volume, cluster);
+        if (fat_volume_is_end(volume, cluster))
+            return;
+    }
+
+    // Parçalı zincirin istekleri birlikte sıralanıp verilsin
+    BlockQueue_Plug();
+    uint32_t run_start = cluster;
+    uint32_t run_length = 1;
+    for (uint32_t i = first; i < last; ++i)
+    {
+        uint32_t next = fat_volume_get_next_cluster(volume, cluster);
+        if (fat_volume_is_end(volume, next) || fat_volume_is_bad(volume, next))
+            break;
+        if (next == cluster + 1)
+        {
+            run_length++;
+        }
+        else
+        {
+            fat_volume_prefetch_clusters(volume, run_start, run_length);
+            run_start = next;
+            run_length = 1;
+        }
+        cluster = next;
+    }
+    fat_volume_prefetch_clusters(volume, run_start, run_length);
+    BlockQueue_Unplug();
+}
+
 static bool fatfs_overlay_reserve(FATNodeInfo* info, size_t required)
 {
     if (!info) return false;
@@ -820,6 +868,15 @@ static int64_t fat_node_read(VFSNode* node, void* handle, uint64_t offset, void*
     return fatfs_read_file(info, offset, buffer, size);
 }
 
+static void fat_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length)
+{
+    (void)handle;
+    if (!node || node->type == VFS_NODE_DIRECTORY || length == 0) return;
+    FATNodeInfo* info = fat_node_info(node);
+    if (!info || info->overlay) return;
+    fatfs_readahead_file(info, offset, length);
+}
+
 static int64_t fat_node_write(VFSNode* node, void* handle, uint64_t offset, const void* buffer, size_t size)
 {
     (void)handle;
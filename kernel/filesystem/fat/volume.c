@@ -1,36 +1,39 @@
 #include "fat_internal.h"
 #include <memory/memory.h>
 #include <util/string.h>
+#include <storage/BlockCache.h>
 
+// Birimin altındaki aygıt ve birimin aygıttaki ilk LBA'sı
+static BlockDevice* fat_volume_backing(FATVolume* volume, uint64_t* base_lba)
+{
+    if (volume->backing_volume)
+    {
+        *base_lba = volume->backing_volume->start_lba;
+        return volume->backing_volume->device;
+    }
+    *base_lba = volume->lba_offset;
+    return volume->device;
+}
+
+// FAT girdisi blok önbelleğinden okunur; her arama için sektör ayrılıp okunmaz
 static uint32_t fat_read_fat_entry(FATVolume* volume, uint32_t cluster)
 {
     uint32_t entry_size = (volume->fat_bits == 32) ? 4u : 2u;
-    uint32_t fat_offset = cluster * entry_size;
-    uint32_t sector = volume->fat_start_sector + (fat_offset / volume->bytes_per_sector);
-    uint32_t offset = fat_offset % volume->bytes_per_sector;
+    uint64_t fat_offset = (uint64_t)volume->fat_start_sector * volume->bytes_per_sector +
+                          (uint64_t)cluster * entry_size;
 
-    uint8_t* buffer = (uint8_t*)malloc(volume->bytes_per_sector);
-    if (!buffer)
-        return 0xFFFFFFFFu;
+    uint64_t base_lba = 0;
+    BlockDevice* device = fat_volume_backing(volume, &base_lba);
 
-    if (!fat_volume_read_sector(volume, sector, buffer))
-    {
-        free(buffer);
+    uint32_t value = 0;
+    if (!BlockCache_ReadBytes(device, base_lba, fat_offset, &value, entry_size))
         return 0xFFFFFFFFu;
-    }
 
-    uint32_t value;
     if (volume->fat_bits == 32)
     {
-        value = *((uint32_t*)(buffer + offset)) & 0x0FFFFFFFu;
+        return value & 0x0FFFFFFFu;
     }
-    else
-    {
-        value = *((uint16_t*)(buffer + offset)) & 0xFFFFu;
-    }
-
-    free(buffer);
-    return value;
+    return value & 0xFFFFu;
 }
 
 bool fat_volume_read_sector(FATVolume* volume, uint32_t sector, void* buffer)
@@ -58,6 +61,15 @@ bool fat_volume_read_cluster(FATVolume* volume, uint32_t cluster, void* buffer)
     return BlockDevice_Read(volume->device, volume->lba_offset + first_sector, sectors, buffer);
 }
 
+void fat_volume_prefetch_clusters(FATVolume* volume, uint32_t cluster, uint32_t count)
+{
+    if (!volume || cluster < 2 || count == 0) return;
+    uint64_t base_lba = 0;
+    BlockDevice* device = fat_volume_backing(volume, &base_lba);
+    uint64_t first_sector = volume->first_data_sector + (uint64_t)(cluster - 2) * volume->sectors_per_cluster;
+    BlockCache_Prefetch(device, base_lba + first_sector, count * volume->sectors_per_cluster);
+}
+
 uint32_t fat_volume_get_next_cluster(FATVolume* volume, uint32_t cluster)
 {
     if (!volume) return 0xFFFFFFFFu;
@@ -4,6 +4,7 @@
 #include <debug/debug.h>
 #include <list.h>
 #include <storage/Volume.h>
+#include <storage/BlockCache.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -109,6 +110,7 @@ static VFSResult iso9660_node_lookup(VFSNode* node, const char* name, VFSNode**
 static VFSResult iso9660_node_create(VFSNode* node, const char* name, VFSNodeType type, VFSNode** out_node);
 static VFSResult iso9660_node_remove(VFSNode* node, const char* name);
 static VFSResult iso9660_node_stat(VFSNode* node, VFSNodeInfo* out_info);
+static void      iso9660_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length);
 static bool      iso9660_probe(VFSFileSystem* fs, const VFSMountParams* params);
 static bool      iso9660_read_sector(const VFSMountParams* params, uint32_t block_size, uint32_t lba, void* buffer);
 
@@ -123,6 +125,7 @@ static const VFSNodeOps s_iso_node_ops = {
     .create   = iso9660_node_create,
     .remove   = iso9660_node_remove,
     .stat     = iso9660_node_stat,
+    .readahead = iso9660_node_readahead,
 };
 
 static const VFSFileSystemOps s_iso_ops = {
@@ -656,6 +659,25 @@ static int64_t iso9660_node_read(VFSNode* node, void* handle, uint64_t offset, v
     return (int64_t)total_read;
 }
 
+// Dosya tek bir extent'tir; aralık doğrudan ardışık bloklara karşılık gelir
+static void iso9660_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length)
+{
+    (void)handle;
+    if (!node || node->type == VFS_NODE_DIRECTORY || length == 0) return;
+    ISO9660NodeInfo* info = iso9660_node_info(node);
+    if (!info || !info->volume || !info->volume->device || offset >= info->data_length)
+        return;
+    if (length > info->data_length - offset)
+        length = info->data_length - offset;
+
+    uint32_t block_size = info->volume->logical_block_size;
+    if (block_size == 0)
+        block_size = 2048;
+    uint64_t first = offset / block_size;
+    uint64_t last = (offset + length - 1) / block_size;
+    BlockCache_Prefetch(info->volume->device, info->extent_lba + first, (uint32_t)(last - first + 1));
+}
+
 static int64_t iso9660_node_write(VFSNode* node, void* handle, uint64_t offset, const void* buffer, size_t size)
 {
     (void)node; (void)handle; (void)offset; (void)buffer; (void)size;
@@ -3,6 +3,8 @@
 #include <util/string.h>
 #include <debug/debug.h>
 #include <list.h>
+#include <storage/BlockCache.h>
+#include <storage/BlockQueue.h>
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -217,6 +219,7 @@ static VFSResult ntfs_node_lookup(VFSNode* node, const char* name, VFSNode** out
 static VFSResult ntfs_node_create(VFSNode* node, const char* name, VFSNodeType type, VFSNode** out_node);
 static VFSResult ntfs_node_remove(VFSNode* node, const char* name);
 static VFSResult ntfs_node_stat(VFSNode* node, VFSNodeInfo* out_info);
+static void      ntfs_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length);
 static int64_t   ntfs_node_write(VFSNode* node, void* handle, uint64_t offset, const void* buffer, size_t size);
 static bool      ntfs_probe(VFSFileSystem* fs, const VFSMountParams* params);
 
@@ -231,6 +234,7 @@ static const VFSNodeOps s_ntfs_node_ops = {
     .create   = ntfs_node_create,
     .remove   = ntfs_node_remove,
     .stat     = ntfs_node_stat,
+    .readahead = ntfs_node_readahead,
 };
 
 static const VFSFileSystemOps s_ntfs_ops = {
@@ -270,6 +274,7 @@ static int64_t ntfs_read_from_runlist(NTFSNodeInfo* info, NTFSRunlist* runlist,
 static bool ntfs_enumerate_directory(NTFSNodeInfo* dir, size_t target_index, VFSDirEntry* out_entry, const char* find_name, uint64_t* out_child_ref);
 static uint32_t ntfs_device_block_size(const NTFSVolume* volume);
 static bool ntfs_read_blocks(NTFSVolume* volume, uint64_t lba, uint32_t count, void* buffer);
+static void ntfs_prefetch_blocks(NTFSVolume* volume, uint64_t lba, uint32_t count);
 static bool ntfs_overlay_reserve(NTFSNodeInfo* info, size_t required);
 static VFSNode* ntfs_overlay_find_child(NTFSNodeInfo* dir, const char* name);
 static size_t ntfs_overlay_child_count(NTFSNodeInfo* dir);
@@ -997,6 +1002,18 @@ static bool ntfs_read_blocks(NTFSVolume* volume, uint64_t lba, uint32_t count, v
     return BlockDevice_Read(volume->device, volume->lba_offset + lba, count, buffer);
 }
 
+static void ntfs_prefetch_blocks(NTFSVolume* volume, uint64_t lba, uint32_t count)
+{
+    if (!volume || count == 0) return;
+    if (volume->backing_volume)
+    {
+        BlockCache_Prefetch(volume->backing_volume->device, volume->backing_volume->start_lba + lba, count);
+        return;
+    }
+    if (volume->device)
+        BlockCache_Prefetch(volume->device, volume->lba_offset + lba, count);
+}
+
 static bool ntfs_overlay_reserve(NTFSNodeInfo* info, size_t required)
 {
     if (!info) return false;
@@ -1608,6 +1625,43 @@ static int64_t ntfs_read_from_runlist(NTFSNodeInfo* info,
     return (int64_t)(size - remaining);
 }
 
+// Tutamacın son okumada çözülmüş runlist'ini kullanır; resident ya da henüz
+// okunmamış dosyalarda bir şey yapmaz
+static void ntfs_node_readahead(VFSNode* node, void* handle, uint64_t offset, uint64_t length)
+{
+    NTFSHandle* h = (NTFSHandle*)handle;
+    if (!node || !h || length == 0) return;
+    NTFSNodeInfo* info = (NTFSNodeInfo*)node->internal_data;
+    if (!info || info->is_directory || info->overlay || !info->volume) return;
+    if (h->runlist.count == 0) return;
+
+    NTFSVolume* volume = info->volume;
+    uint32_t block_size = ntfs_device_block_size(volume);
+    uint64_t remaining = length;
+    uint64_t relative = offset;
+
+    BlockQueue_Plug(); // run'ların istekleri LBA sırasıyla verilsin
+    for (size_t i = 0; i < h->runlist.count && remaining > 0; ++i)
+    {
+        const NTFSDataRun* run = &h->runlist.runs[i];
+        uint64_t run_bytes = run->length * volume->bytes_per_cluster;
+        if (relative >= run_bytes)
+        {
+            relative -= run_bytes;
+            continue;
+        }
+
+        uint64_t chunk = MIN(run_bytes - relative, remaining);
+        uint64_t byte_offset = (uint64_t)run->lcn * volume->bytes_per_cluster + relative;
+        uint64_t first = byte_offset / block_size;
+        uint64_t last = (byte_offset + chunk - 1) / block_size;
+        ntfs_prefetch_blocks(volume, first, (uint32_t)(last - first + 1));
+        remaining -= chunk;
+        relative = 0;
+    }
+    BlockQueue_Unplug();
+}
+
 static bool ntfs_enumerate_directory(NTFSNodeInfo* dir,
                                      size_t target_index,
                                      VFSDirEntry* out_entry,
@@ -440,6 +440,24 @@ void gfx_clear_buffer(gfx_buffer *buffer, gfx_color color)
     if (!buffer)
         return;
 
+    if (buffer->bpp == 32 && color.a != 0 && buffer->size.height > 0)
+    {
+        // İlk satırı doldur, sonra dolu kısmı ikiye katlayarak kopyala (vektörel memcpy)
+        uint32_t* pixels = (uint32_t*)buffer->buffer;
+        for (size_t x = 0; x < buffer->size.width; x++)
+            pixels[x] = color.argb;
+
+        size_t total = buffer->size.width * buffer->size.height * sizeof(uint32_t);
+        size_t done = buffer->size.width * sizeof(uint32_t);
+        while (done < total)
+        {
+            size_t chunk = (done < total - done) ? done : total - done;
+            memcpy((uint8_t*)buffer->buffer + done, buffer->buffer, chunk);
+            done += chunk;
+        }
+        return;
+    }
+
     for (size_t y = 0; y < buffer->size.height; y++)
     {
         for (size_t x = 0; x < buffer->size.width; x++)
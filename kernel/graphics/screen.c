@@ -18,6 +18,36 @@ extern DriverBase efi_gop_driver;
 
 Event* screen_modeChangeEvent = NULL;
 
+bool screen_set_framebuffer_memtype(ScreenVideoModeInfo* mode, arch_paging_memtype_t type)
+{
+    if (!mode || !mode->framebuffer || !mode->linear_framebuffer) return false;
+
+    uintptr_t fb = (uintptr_t)mode->framebuffer;
+    size_t size = mode->pitch * mode->height;
+    if (size == 0) return false;
+
+#ifdef ARCH_AMD
+    // PAT yolu: sayfa tablosu girdisi MTRR tipini geçersiz kılar (WC için PAT her zaman kazanır).
+    // i386'da paging kapalı olduğundan PTE bitlerinin etkisi yok, doğrudan MTRR'a geçilir.
+    if (arch_paging_pat_init())
+    {
+        // Eşli büyük sayfalar yerinde yeniden tiplenir; yalnızca aralığın kenarları bölünür
+        if (arch_paging_map_with_type(fb, fb, size, 0, type)) return true;
+        WARN("screen: PAT memtype %u failed for fb=%p, trying MTRR", (unsigned)type, mode->framebuffer);
+    }
+#endif
+
+    // Yedek yol: değişken MTRR. Görünür alan (ör. 1920x1080x4) 2'nin kuvveti olmadığından
+    // çok sayıda slot tüketir; taban hizalıysa tek slotluk 2'nin kuvveti aralık denenir.
+    size_t mtrr_size = 4096;
+    while (mtrr_size < size) mtrr_size <<= 1;
+    if ((fb & (mtrr_size - 1)) == 0 && arch_mtrr_set_range(fb, mtrr_size, type)) return true;
+    if (arch_mtrr_set_range(fb, size, type)) return true;
+
+    WARN("screen: could not set memtype %u for fb=%p (+%zu)", (unsigned)type, mode->framebuffer, size);
+    return false;
+}
+
 void screen_init()
 {
     screen_list = List_Create();
@@ -69,6 +99,9 @@ void screen_init()
         main_screen.mode->pitch,
         main_screen.mode->framebuffer);
 
+    // Firmware'in bıraktığı tip (genelde UC) yerine framebuffer write-combining çalışsın
+    if (screen_set_framebuffer_memtype(main_screen.mode, ARCH_PAGING_MT_WC))
+        LOG("screen: framebuffer mapped write-combining");
 }
 
 extern void efi_gop_setVideoMode(ScreenInfo* screen, ScreenVideoModeInfo* mode);
@@ -100,6 +133,7 @@ void screen_changeVideoMode(ScreenInfo* screen, ScreenVideoModeInfo* mode)
     if (mb2_is_efi_boot)
     {
         efi_gop_setVideoMode(screen, mode);
+        screen_set_framebuffer_memtype(main_screen.mode, ARCH_PAGING_MT_WC);
         hardware_buffer->bpp = main_screen.mode->bpp;
         hardware_buffer->size.width = main_screen.mode->width;
         hardware_buffer->size.height = main_screen.mode->height;
@@ -24,3 +24,40 @@ detect_erms:
     movzx   eax, al
     pop     ebx
     ret
+
+section .bss
+
+; SIMD level used by memcpy/memmove/memset: 0 = none, 1 = SSE2
+global simd_level
+simd_level: resb 1
+
+section .text
+
+; void detect_simd(void)
+; SSE2 via CPUID.1:EDX[26] (+ FXSR EDX[24]); enables CR0.MP, clears CR0.EM and
+; sets CR4.OSFXSR|OSXMMEXCPT. The 32-bit routines stay on SSE2 (no AVX path).
+; Writes the result to simd_level and returns it in EAX
+global detect_simd
+detect_simd:
+    push    ebx
+    mov     eax, 1
+    cpuid
+    xor     eax, eax
+    bt      edx, 24            ; FXSR
+    jnc     .done
+    bt      edx, 26            ; SSE2
+    jnc     .done
+
+    mov     eax, cr0
+    and     eax, ~(1 << 2)     ; EM = 0
+    or      eax, (1 << 1)      ; MP = 1
+    mov     cr0, eax
+    mov     eax, cr4
+    or      eax, (1 << 9) | (1 << 10) ; OSFXSR | OSXMMEXCPT
+    mov     cr4, eax
+    mov     eax, 1
+
+.done:
+    mov     byte [simd_level], al
+    pop     ebx
+    ret
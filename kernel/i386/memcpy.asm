@@ -1,10 +1,38 @@
 section .text
 
 global memcpy
+global memmove
 extern erms_supported
+extern simd_level
 
 use32
 
+MEM_SIMD_MIN    equ 256             ; below this the vector setup is not worth it
+MEM_NT_MIN      equ 512 * 1024      ; above this, non-temporal stores (no cache pollution)
+MEM_SIMD_CHUNK  equ 4096            ; largest block copied with interrupts off
+
+; The SSE2 loops run in MEM_SIMD_CHUNK pieces with interrupts off, so an IRQ
+; never lands mid-loop.
+; An interrupt has no caller: when memcpy/memset run in an IRQ (periodic tasks
+; call them from the timer IRQ) the interrupted code still expects its xmm
+; registers intact, and the ISR stubs save only the general registers. The
+; SSE2 paths therefore keep xmm0-3 on the stack for their duration.
+%macro XMM_SAVE 0
+	sub     esp, 64
+	movdqu  [esp], xmm0
+	movdqu  [esp+16], xmm1
+	movdqu  [esp+32], xmm2
+	movdqu  [esp+48], xmm3
+%endmacro
+
+%macro XMM_RESTORE 0
+	movdqu  xmm0, [esp]
+	movdqu  xmm1, [esp+16]
+	movdqu  xmm2, [esp+32]
+	movdqu  xmm3, [esp+48]
+	add     esp, 64
+%endmacro
+
 ; void* memcpy(void* dest [ESP+4], const void* src [ESP+8], size_t n [ESP+12])
 memcpy:
 	push    edi
@@ -18,10 +46,34 @@ memcpy:
 
 	test    ecx, ecx
 	jz      .ret
+	cld
+
+	cmp     byte [simd_level], 0
+	je      .no_simd
 
+	; Large copies (e.g. a full frame to the framebuffer) use non-temporal stores
+	cmp     ecx, MEM_NT_MIN
+	jae     .nt
+
+	; For mid sizes ERMS rep movsb is as fast as the vector loop
+	cmp     byte [erms_supported], 0
+	jne     .erms
+	cmp     ecx, MEM_SIMD_MIN
+	jb      .no_erms
+	xor     edx, edx
+	call    simd_copy_fwd
+	jmp     .ret
+
+.nt:
+	mov     edx, 1
+	call    simd_copy_fwd
+	jmp     .ret
+
+.no_simd:
 	; If ERMS supported, prefer rep movsb for all sizes
 	cmp     byte [erms_supported], 0
 	je      .no_erms
+.erms:
 	rep     movsb
 	jmp     .ret
 
@@ -65,3 +117,176 @@ memcpy:
 	pop     esi
 	pop     edi
 	ret
+
+; void* memmove(void* dest [ESP+4], const void* src [ESP+8], size_t n [ESP+12])
+; The forward memcpy paths are safe when dest < src. A backward copy is only
+; needed when src < dest < src + n.
+memmove:
+	push    edi
+	push    esi
+	push    ebx
+
+	mov     edi, [esp+16]
+	mov     esi, [esp+20]
+	mov     ecx, [esp+24]
+	mov     eax, edi
+	cld
+
+	mov     edx, edi
+	sub     edx, esi           ; dest - src (unsigned)
+	jz      .ret
+	cmp     edx, ecx
+	jb      .backward
+
+	pop     ebx
+	pop     esi
+	pop     edi
+	jmp     memcpy
+
+.backward:
+	add     esi, ecx           ; work from the end
+	add     edi, ecx
+
+	cmp     byte [simd_level], 0
+	je      .head
+	cmp     ecx, MEM_SIMD_MIN
+	jb      .head
+	XMM_SAVE
+
+.chunk:
+	cmp     ecx, 64
+	jb      .vec_done
+	mov     ebx, ecx
+	and     ebx, ~63
+	cmp     ebx, MEM_SIMD_CHUNK
+	jbe     .sized
+	mov     ebx, MEM_SIMD_CHUNK
+.sized:
+	sub     ecx, ebx
+	shr     ebx, 6
+
+	pushfd
+	cli
+.loop:
+	; Each 64-byte block is fully loaded before it is stored, so dest > src overlap is safe
+	sub     esi, 64
+	sub     edi, 64
+	movdqu  xmm0, [esi+48]
+	movdqu  xmm1, [esi+32]
+	movdqu  xmm2, [esi+16]
+	movdqu  xmm3, [esi]
+	movdqu  [edi+48], xmm0
+	movdqu  [edi+32], xmm1
+	movdqu  [edi+16], xmm2
+	movdqu  [edi], xmm3
+	dec     ebx
+	jnz     .loop
+	popfd
+	jmp     .chunk
+
+.vec_done:
+	XMM_RESTORE
+
+.head:
+	; Remaining bytes at the start (all of them on the scalar path). The ISR
+	; stubs do not clear DF, so DF=1 is only held with interrupts off, in
+	; MEM_SIMD_CHUNK pieces like the vector loop.
+	test    ecx, ecx
+	jz      .ret
+	dec     esi
+	dec     edi
+	mov     edx, ecx
+.head_chunk:
+	mov     ecx, edx
+	cmp     ecx, MEM_SIMD_CHUNK
+	jbe     .head_sized
+	mov     ecx, MEM_SIMD_CHUNK
+.head_sized:
+	sub     edx, ecx
+	pushfd
+	cli
+	std
+	rep     movsb
+	cld
+	popfd
+	test    edx, edx
+	jnz     .head_chunk
+
+.ret:
+	pop     ebx
+	pop     esi
+	pop     edi
+	ret
+
+; Forward SSE2 copy.
+; In: edi = dest, esi = src, ecx = n (>= MEM_SIMD_MIN), edx = 1 for non-temporal stores
+; eax and edx are preserved; ebx, ecx, esi, edi are clobbered
+simd_copy_fwd:
+	XMM_SAVE
+
+	; Align the destination to 16 bytes (movdqa/movntdq require it)
+	mov     ebx, edi
+	neg     ebx
+	and     ebx, 15
+	sub     ecx, ebx
+	xchg    ecx, ebx
+	rep     movsb
+	mov     ecx, ebx           ; ecx = remaining
+
+.chunk:
+	cmp     ecx, 64
+	jb      .tail
+	mov     ebx, ecx
+	and     ebx, ~63
+	cmp     ebx, MEM_SIMD_CHUNK
+	jbe     .sized
+	mov     ebx, MEM_SIMD_CHUNK
+.sized:
+	sub     ecx, ebx
+	shr     ebx, 6             ; 64-byte blocks
+
+	pushfd
+	cli
+	test    edx, edx
+	jnz     .nt_loop
+.loop:
+	movdqu  xmm0, [esi]
+	movdqu  xmm1, [esi+16]
+	movdqu  xmm2, [esi+32]
+	movdqu  xmm3, [esi+48]
+	movdqa  [edi], xmm0
+	movdqa  [edi+16], xmm1
+	movdqa  [edi+32], xmm2
+	movdqa  [edi+48], xmm3
+	add     esi, 64
+	add     edi, 64
+	dec     ebx
+	jnz     .loop
+	jmp     .chunk_done
+
+.nt_loop:
+	movdqu  xmm0, [esi]
+	movdqu  xmm1, [esi+16]
+	movdqu  xmm2, [esi+32]
+	movdqu  xmm3, [esi+48]
+	movntdq [edi], xmm0
+	movntdq [edi+16], xmm1
+	movntdq [edi+32], xmm2
+	movntdq [edi+48], xmm3
+	add     esi, 64
+	add     edi, 64
+	dec     ebx
+	jnz     .nt_loop
+
+.chunk_done:
+	popfd
+	jmp     .chunk
+
+.tail:
+	XMM_RESTORE
+	test    edx, edx
+	jz      .tail_copy
+	sfence                     ; order the non-temporal stores before later stores
+.tail_copy:
+	rep     movsb
+	ret
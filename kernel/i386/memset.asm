@@ -0,0 +1,142 @@
+section .text
+
+global memset
+extern erms_supported
+extern simd_level
+
+use32
+
+MEM_SIMD_MIN    equ 256
+MEM_NT_MIN      equ 512 * 1024
+MEM_SIMD_CHUNK  equ 4096
+
+; Same as memcpy.asm: xmm0 is saved around the SSE2 path, which may run in
+; an IRQ where the interrupted code still holds it
+%macro XMM_SAVE 0
+	sub     esp, 16
+	movdqu  [esp], xmm0
+%endmacro
+
+%macro XMM_RESTORE 0
+	movdqu  xmm0, [esp]
+	add     esp, 16
+%endmacro
+
+; void* memset(void* ptr [ESP+4], int value [ESP+8], size_t n [ESP+12])
+; Same dispatch as memcpy (see memcpy.asm): the SSE2 loop runs in
+; MEM_SIMD_CHUNK pieces with interrupts off.
+memset:
+	push    edi
+	push    ebx
+
+	mov     edi, [esp+12]      ; ptr
+	movzx   eax, byte [esp+16] ; value
+	mov     ecx, [esp+20]      ; n
+
+	test    ecx, ecx
+	jz      .ret
+	cld
+
+	imul    eax, eax, 0x01010101 ; byte -> 4-byte pattern (al stays the value)
+
+	cmp     byte [simd_level], 0
+	je      .no_simd
+	cmp     ecx, MEM_NT_MIN
+	jae     .nt
+	cmp     byte [erms_supported], 0
+	jne     .bytes
+	cmp     ecx, MEM_SIMD_MIN
+	jb      .no_erms
+	xor     edx, edx
+	jmp     .simd
+.nt:
+	mov     edx, 1
+
+.simd:
+	XMM_SAVE
+
+	; Align the destination to 16 bytes
+	mov     ebx, edi
+	neg     ebx
+	and     ebx, 15
+	sub     ecx, ebx
+	xchg    ecx, ebx
+	rep     stosb
+	mov     ecx, ebx
+
+.chunk:
+	cmp     ecx, 64
+	jb      .tail
+	mov     ebx, ecx
+	and     ebx, ~63
+	cmp     ebx, MEM_SIMD_CHUNK
+	jbe     .sized
+	mov     ebx, MEM_SIMD_CHUNK
+.sized:
+	sub     ecx, ebx
+	shr     ebx, 6
+
+	pushfd
+	cli
+	movd    xmm0, eax
+	pshufd  xmm0, xmm0, 0
+	test    edx, edx
+	jnz     .nt_loop
+.loop:
+	movdqa  [edi], xmm0
+	movdqa  [edi+16], xmm0
+	movdqa  [edi+32], xmm0
+	movdqa  [edi+48], xmm0
+	add     edi, 64
+	dec     ebx
+	jnz     .loop
+	jmp     .chunk_done
+.nt_loop:
+	movntdq [edi], xmm0
+	movntdq [edi+16], xmm0
+	movntdq [edi+32], xmm0
+	movntdq [edi+48], xmm0
+	add     edi, 64
+	dec     ebx
+	jnz     .nt_loop
+
+.chunk_done:
+	popfd
+	jmp     .chunk
+
+.tail:
+	XMM_RESTORE
+	test    edx, edx
+	jz      .bytes
+	sfence
+	jmp     .bytes
+
+.no_simd:
+	cmp     byte [erms_supported], 0
+	jne     .bytes
+
+.no_erms:
+	cmp     ecx, 16
+	jb      .bytes
+
+	; Align to 4, then dword stores, then the tail
+	mov     ebx, edi
+	neg     ebx
+	and     ebx, 3
+	sub     ecx, ebx
+	xchg    ecx, ebx
+	rep     stosb
+	mov     ecx, ebx
+	shr     ecx, 2
+	rep     stosd
+	mov     ecx, ebx
+	and     ecx, 3
+
+.bytes:
+	rep     stosb
+
+.ret:
+	mov     eax, [esp+12]
+	pop     ebx
+	pop     edi
+	ret
@@ -435,3 +435,21 @@ bool arch_paging_map_with_type(uintptr_t phys_start, uintptr_t virt_start, size_
     }
     return true;
 }
+
+bool arch_paging_unmap(uintptr_t virt_start, size_t length) {
+    if (length == 0) return true;
+    uintptr_t page_size = 4096u;
+    uintptr_t virt = virt_start & ~(page_size - 1);
+    uintptr_t end  = (virt_start + length + page_size - 1) & ~(page_size - 1);
+    for (uintptr_t v = virt; v < end; v += page_size) {
+        PTE* pte = __pte_from_virt(v);
+        pte->present = 0;
+        arch_tlb_flush_one((void*)v);
+    }
+    return true;
+}
+
+uintptr_t arch_paging_virt_to_phys(uintptr_t virt_addr) {
+    /* Paging is not enabled on i386 yet; addresses are physical */
+    return virt_addr;
+}
@@ -8,6 +8,7 @@ extern idt_ptr
 extern __boot_kernel_start
 extern gdtr_i386
 extern detect_erms
+extern detect_simd
 extern __stack_end
 
 extern page_directory
@@ -40,6 +41,7 @@ _start:
 
     ; Detect CPU features (ERMS)
     call detect_erms
+    call detect_simd ; SSE2 -> simd_level (memcpy/memset dispatch)
     
     ; Enable disable by clearing the PG bit in CR0
     mov eax, cr0 ; Read CR0
@@ -1,6 +1,10 @@
 #include <memory/memory.h>
+#include <memory/objpool.h>
 #include <list.h>
 
+// Her ekleme için malloc yerine düğümler ortak bir havuzdan gelir
+static ObjectPool list_node_pool = OBJECT_POOL_STATIC(ListNode, 128, true);
+
 void List_Init(List* list) {
 	if (!list) return;
 	list->head = NULL;
@@ -23,7 +27,7 @@ void List_Destroy(List* list, bool freeData) {
 
 void List_Add(List* self, void* item) {
 	if (!self) return;
-	ListNode* node = (ListNode*)malloc(sizeof(ListNode));
+	ListNode* node = OBJECT_POOL_NEW(&list_node_pool, ListNode);
 	if (!node) return; // out of memory, sessizce düş
 	node->data = item;
 	node->next = NULL;
@@ -57,7 +61,7 @@ bool List_RemoveAt(List* self, size_t index) {
 		if (self->tail == cur) self->tail = prev;
 	}
 
-	free(cur);
+	object_pool_free(&list_node_pool, cur);
 	self->count--;
 	return true;
 }
@@ -79,7 +83,7 @@ bool List_Remove(List* self, void* item) {
 				prev->next = cur->next;
 				if (self->tail == cur) self->tail = prev;
 			}
-			free(cur);
+			object_pool_free(&list_node_pool, cur);
 			self->count--;
 			return true;
 		}
@@ -115,7 +119,7 @@ bool List_InsertAt(List* self, size_t index, void* item) {
 		return true;
 	}
 
-	ListNode* node = (ListNode*)malloc(sizeof(ListNode));
+	ListNode* node = OBJECT_POOL_NEW(&list_node_pool, ListNode);
 	if (!node) return false;
 	node->data = item;
 
@@ -144,7 +148,7 @@ void List_Clear(List* self, bool freeData) {
 		if (freeData && n->data) {
 			free(n->data);
 		}
-		free(n);
+		object_pool_free(&list_node_pool, n);
 		n = next;
 	}
 	self->head = self->tail = NULL;
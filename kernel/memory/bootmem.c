@@ -0,0 +1,39 @@
+#include <memory/bootmem.h>
+#include <memory/memory.h>
+#include <memory/heap.h>
+#include <arch.h>
+#include <debug/debug.h>
+
+#define BOOTMEM_MIN_ALIGN 16
+
+static uint8_t bootmem_arena[BOOTMEM_SIZE] __attribute__((aligned(4096)));
+static size_t bootmem_used = 0;
+static size_t bootmem_spilled = 0;
+
+void* bootmem_alloc(size_t size, size_t align)
+{
+    if (size == 0) return NULL;
+    if (align < BOOTMEM_MIN_ALIGN) align = BOOTMEM_MIN_ALIGN;
+    if (align & (align - 1)) return NULL;
+
+    size_t flags = arch_irq_save();
+    size_t offset = (bootmem_used + align - 1) & ~(align - 1);
+    if (offset <= BOOTMEM_SIZE && size <= BOOTMEM_SIZE - offset)
+    {
+        bootmem_used = offset + size;
+        arch_irq_restore(flags);
+        return &bootmem_arena[offset];
+    }
+    bootmem_spilled += size;
+    arch_irq_restore(flags);
+
+    // Arena doldu; hiç geri verilmeyecek olsa da heap'ten al
+    WARN("bootmem: arena full, %zu bytes taken from the heap", size);
+    return heap_aligned_alloc(align, size);
+}
+
+void bootmem_get_usage(size_t* used, size_t* spilled)
+{
+    if (used) *used = bootmem_used;
+    if (spilled) *spilled = bootmem_spilled;
+}
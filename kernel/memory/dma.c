@@ -0,0 +1,299 @@
+#include <memory/dma.h>
+#include <memory/memory.h>
+#include <memory/heap.h>
+#include <memory/pmm.h>
+#include <arch.h>
+#include <debug/debug.h>
+
+#define DMA_MIN_ALIGN      16
+#define DMA_ALLOC_RETRIES  4   // max_phys'e uymayan bloklar bu kadar kez tutulup yeniden denenir
+
+#define DMA_KIND_NONE        0
+#define DMA_KIND_HEAP        1
+#define DMA_KIND_PAGES_EXACT 2 // pmm_alloc_pages_exact(pages)
+#define DMA_KIND_PAGES_ORDER 3 // pmm_alloc_pages(order); hizalama tam boyuttan büyük
+
+static DmaBuffer dma_bounce[DMA_BOUNCE_COUNT];
+static uint32_t dma_bounce_ready = 0; // Ayrılmış bounce tamponlarının bit maskesi
+static uint32_t dma_bounce_used = 0;
+
+static inline bool dma_is_pow2(size_t x)
+{
+    return x && (x & (x - 1)) == 0;
+}
+
+static size_t dma_next_pow2(size_t x)
+{
+    size_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+static inline uint64_t dma_virt_to_phys(uintptr_t virt)
+{
+    return (uint64_t)arch_paging_virt_to_phys(virt);
+}
+
+size_t dma_map_partial(const void* virt, size_t len, size_t boundary, size_t max_segment,
+                       uint64_t max_phys, DmaSegment* out, size_t max_out, size_t* mapped)
+{
+    if (mapped) *mapped = 0;
+    if (!virt || len == 0 || !out || max_out == 0) return 0;
+    if (boundary && !dma_is_pow2(boundary)) return 0;
+    if (max_segment == 0 || max_segment - 1 >= (size_t)UINT32_MAX) max_segment = (size_t)UINT32_MAX;
+
+    uintptr_t va = (uintptr_t)virt;
+    size_t count = 0;
+    size_t done = 0;
+    bool full = false;
+
+    while (done < len && !full)
+    {
+        uint64_t pa = dma_virt_to_phys(va);
+        if (pa == 0) break; // Eşlenmemiş
+
+        size_t n = PMM_PAGE_SIZE - (va & (PMM_PAGE_SIZE - 1));
+        if (n > len - done) n = len - done;
+        if (pa + n - 1 > max_phys) break;
+
+        while (n)
+        {
+            DmaSegment* seg = count ? &out[count - 1] : NULL;
+            bool join = seg && seg->phys + seg->length == pa &&
+                        !(boundary && (pa & (boundary - 1)) == 0);
+
+            size_t room = 0;
+            if (join)
+            {
+                room = max_segment - seg->length;
+                if (boundary)
+                {
+                    size_t to_boundary = boundary - (size_t)(pa & (boundary - 1));
+                    if (room > to_boundary) room = to_boundary;
+                }
+            }
+            if (!join || room == 0)
+            {
+                if (count == max_out)
+                {
+                    full = true;
+                    break;
+                }
+                seg = &out[count++];
+                seg->phys = pa;
+                seg->length = 0;
+                room = max_segment;
+                if (boundary)
+                {
+                    size_t to_boundary = boundary - (size_t)(pa & (boundary - 1));
+                    if (room > to_boundary) room = to_boundary;
+                }
+            }
+
+            size_t take = n < room ? n : room;
+            seg->length += (uint32_t)take;
+            pa += take;
+            va += take;
+            n -= take;
+            done += take;
+        }
+    }
+
+    if (mapped) *mapped = done;
+    return count;
+}
+
+size_t dma_map_segments(const void* virt, size_t len, size_t boundary, size_t max_segment,
+                        uint64_t max_phys, DmaSegment* out, size_t max_out)
+{
+    size_t mapped = 0;
+    size_t count = dma_map_partial(virt, len, boundary, max_segment, max_phys, out, max_out, &mapped);
+    return mapped == len ? count : 0;
+}
+
+// Tamponun tek parça olarak kısıtlara uyup uymadığı
+static bool dma_fits(void* virt, size_t size, size_t boundary, uint64_t max_phys, uint64_t* phys)
+{
+    DmaSegment seg;
+    if (dma_map_segments(virt, size, boundary, size, max_phys, &seg, 1) != 1) return false;
+    *phys = seg.phys;
+    return true;
+}
+
+static void dma_release(DmaBuffer* buf)
+{
+    switch (buf->kind)
+    {
+        case DMA_KIND_HEAP:        heap_free(buf->virt); break;
+        case DMA_KIND_PAGES_EXACT: pmm_free_pages_exact(buf->virt, buf->pages); break;
+        case DMA_KIND_PAGES_ORDER: pmm_free_pages(buf->virt, buf->order); break;
+        default: break;
+    }
+    buf->kind = DMA_KIND_NONE;
+    buf->virt = NULL;
+}
+
+static bool dma_alloc_pages(DmaBuffer* buf, size_t size, size_t align)
+{
+    size_t pages = (size + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+
+    // 2^order sayfalık blok kendi boyutuna hizalıdır; boundary >= blok boyutu
+    // olduğundan (size <= boundary, ikisi de 2'nin kuvveti) sınırı geçemez.
+    uint32_t exact_order = 0;
+    while (((size_t)1 << exact_order) < pages) exact_order++;
+    uint32_t order = exact_order;
+    while (((size_t)PMM_PAGE_SIZE << order) < align) order++;
+    if (order > PMM_MAX_ORDER) return false;
+
+    if (order == exact_order)
+    {
+        buf->virt = pmm_alloc_pages_exact(pages);
+        buf->kind = DMA_KIND_PAGES_EXACT;
+    }
+    else
+    {
+        buf->virt = pmm_alloc_pages(order);
+        buf->kind = DMA_KIND_PAGES_ORDER;
+    }
+    if (!buf->virt)
+    {
+        buf->kind = DMA_KIND_NONE;
+        return false;
+    }
+
+    buf->pages = pages;
+    buf->order = (uint8_t)order;
+    return true;
+}
+
+bool dma_alloc(DmaBuffer* buf, size_t size, size_t align, size_t boundary, uint64_t max_phys)
+{
+    if (!buf || size == 0) return false;
+    memset(buf, 0, sizeof(DmaBuffer));
+
+    if (align < DMA_MIN_ALIGN) align = DMA_MIN_ALIGN;
+    if (!dma_is_pow2(align) || (boundary && !dma_is_pow2(boundary)))
+    {
+        WARN("dma_alloc: alignment %zu / boundary %zu must be powers of two", align, boundary);
+        return false;
+    }
+    if (boundary && size > boundary)
+    {
+        WARN("dma_alloc: %zu bytes cannot fit inside a %zu-byte boundary", size, boundary);
+        return false;
+    }
+
+    // Küçük yapılar heap'ten oyulur; kendi boyutunun 2'nin kuvvetine hizalanan
+    // blok, ondan büyük hiçbir boundary'yi geçmez.
+    size_t heap_align = align;
+    if (boundary && heap_align < dma_next_pow2(size)) heap_align = dma_next_pow2(size);
+
+    if (size + heap_align <= PMM_PAGE_SIZE)
+    {
+        void* virt = heap_aligned_alloc(heap_align, size);
+        if (virt && dma_fits(virt, size, boundary, max_phys, &buf->phys))
+        {
+            buf->virt = virt;
+            buf->size = size;
+            buf->kind = DMA_KIND_HEAP;
+            memset(virt, 0, size);
+            return true;
+        }
+        if (virt) heap_free(virt);
+    }
+
+    // Sayfa yolu; max_phys'e uymayan bloklar yeniden verilmesin diye bir süre tutulur
+    DmaBuffer rejected[DMA_ALLOC_RETRIES];
+    size_t rejected_count = 0;
+    bool ok = false;
+
+    while (rejected_count < DMA_ALLOC_RETRIES)
+    {
+        if (!dma_alloc_pages(buf, size, align)) break;
+
+        if (dma_fits(buf->virt, size, boundary, max_phys, &buf->phys))
+        {
+            ok = true;
+            break;
+        }
+        rejected[rejected_count++] = *buf;
+        memset(buf, 0, sizeof(DmaBuffer));
+    }
+
+    for (size_t i = 0; i < rejected_count; i++)
+        dma_release(&rejected[i]);
+
+    if (!ok)
+    {
+        ERROR("dma_alloc: no memory for %zu bytes (align %zu, boundary %zu, max_phys 0x%llx)",
+              size, align, boundary, (unsigned long long)max_phys);
+        memset(buf, 0, sizeof(DmaBuffer));
+        return false;
+    }
+
+    buf->size = size;
+    memset(buf->virt, 0, size);
+    return true;
+}
+
+void dma_free(DmaBuffer* buf)
+{
+    if (!buf || !buf->virt) return;
+    dma_release(buf);
+    memset(buf, 0, sizeof(DmaBuffer));
+}
+
+void dma_init(void)
+{
+    if (dma_bounce_ready) return;
+
+    for (uint32_t i = 0; i < DMA_BOUNCE_COUNT; i++)
+    {
+        if (dma_alloc(&dma_bounce[i], DMA_BOUNCE_SIZE, DMA_BOUNCE_SIZE, DMA_BOUNDARY_64K, DMA_ADDR_32BIT))
+            dma_bounce_ready |= 1u << i;
+    }
+
+    unsigned ready = 0;
+    for (uint32_t i = 0; i < DMA_BOUNCE_COUNT; i++)
+        if (dma_bounce_ready & (1u << i)) ready++;
+    LOG("dma: %u bounce buffers of %u KiB ready", ready, (unsigned)(DMA_BOUNCE_SIZE / 1024));
+}
+
+bool dma_bounce_acquire(DmaBuffer* buf)
+{
+    if (!buf) return false;
+
+    size_t flags = arch_irq_save();
+    uint32_t avail = dma_bounce_ready & ~dma_bounce_used;
+    if (!avail)
+    {
+        arch_irq_restore(flags);
+        return false;
+    }
+
+    uint32_t i = (uint32_t)__builtin_ctz(avail);
+    dma_bounce_used |= 1u << i;
+    arch_irq_restore(flags);
+
+    *buf = dma_bounce[i];
+    return true;
+}
+
+void dma_bounce_release(DmaBuffer* buf)
+{
+    if (!buf || !buf->virt) return;
+
+    for (uint32_t i = 0; i < DMA_BOUNCE_COUNT; i++)
+    {
+        if (dma_bounce[i].virt != buf->virt) continue;
+
+        size_t flags = arch_irq_save();
+        dma_bounce_used &= ~(1u << i);
+        arch_irq_restore(flags);
+
+        buf->virt = NULL;
+        return;
+    }
+
+    WARN("dma_bounce_release: %p is not a bounce buffer", buf->virt);
+}
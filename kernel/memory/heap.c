@@ -1,21 +1,50 @@
 #include <memory/memory.h>
 #include <memory/heap.h>
 #include <memory/pmm.h>
+#include <memory/slab.h>
 #include <efi/efi.h>
+#include <arch.h>
 #include <list.h>
+#include <task/PeriodicTask.h>
 #include <debug/debug.h>
 
-#define HEAP_MAGIC 0xDEADBEEF
-#define HEAP_NODE_MIN_SIZE (sizeof(size_t) * 2)
+#define HEAP_MAGIC         0xDEADBEEF
+#define HEAP_ALIGNED_MAGIC 0xA11C0DEDu // heap_aligned_alloc'un gerçek bloğa geri işaret eden sahte başlığı
+#define HEAP_LARGE_MAGIC   0x1A26EB1Cu // Doğrudan PMM sayfalarından verilen büyük blok
+#define HEAP_END_MAGIC     0           // Bölge sonu sentinel'i
 
+#define HEAP_FLAG_FREE      (1u << 0)
+#define HEAP_FLAG_PREV_FREE (1u << 1) // Fiziksel olarak önceki blok boş; footer'ı geçerli
+
+#define HEAP_ALIGN 16
+#define HEAP_DUMP_TOP_SITES 8
+
+#define HEAP_LARGE_MIN   (64 * 1024)        // Bu boyut ve üstü heap'e girmez, sayfa olarak alınır
+#define HEAP_GROW_MIN    (256 * 1024)       // İlk genişleme bölgesi; her genişlemede iki katına çıkar
+#define HEAP_GROW_MAX    (8 * 1024 * 1024)
+#define HEAP_MAX_REGIONS 64
+#define HEAP_ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((size_t)(a) - 1))
+
+// Boundary-tag blok başlığı. Boş blokların gövdesi free list bağlantılarını,
+// son sizeof(size_t) baytı ise boyut footer'ını taşır; böylece bir işaretçiden
+// hem sonraki hem önceki komşuya O(1) ulaşılır.
 typedef struct HeapNode
 {
     uint32_t magic; // Magic number for validation
-    bool is_free; // Flag to indicate if the block is free
-    struct HeapNode* next; // Pointer to the next node in the free list
-} HeapNode;
+    uint32_t flags; // HEAP_FLAG_*
+    size_t size;    // Başlıktan sonraki kullanılabilir bayt sayısı
+#ifdef HEAP_TRACE_CALLSITES
+    void* site;     // Tahsisli bloğu ayıran çağrı noktası
+#endif
+} __attribute__((aligned(HEAP_ALIGN))) HeapNode;
+
+typedef struct HeapFreeLinks
+{
+    HeapNode* prev;
+    HeapNode* next;
+} HeapFreeLinks;
 
-#define NODE_SIZE(node) (node->next ? ((size_t)node->next - (size_t)node - sizeof(HeapNode)) : 0)
+#define HEAP_MIN_PAYLOAD HEAP_ALIGN_UP(sizeof(HeapFreeLinks) + sizeof(size_t), HEAP_ALIGN)
 
 // Linker-provided symbols that delimit the local heap region
 // Declare as arrays to avoid array-bounds warnings and allow taking addresses safely.
@@ -26,103 +55,370 @@ HeapRegion* first_heap_region = NULL;
 
 HeapRegion localHeapRegion;
 
+// Tüm bölgelerin boş blokları; tahsisli bloklar hiç gezilmez
+static HeapNode* heap_free_list = NULL;
+
+// İstatistikler bölgeleri gezer; kesme bağlamındaki dump bir alloc/free'nin
+// ortasına denk gelirse o turu atlar.
+static volatile uint32_t heap_busy = 0;
+static size_t heap_expanded_regions = 0;
+static size_t heap_next_grow = HEAP_GROW_MIN;
+
+// Bölgeler başlangıç adresine göre sıralı; işaretçiden bölgeyi ikili aramayla bulur.
+// first_heap_region zinciri de aynı sırada tutulur.
+static HeapRegion* heap_region_index[HEAP_MAX_REGIONS];
+static size_t heap_region_count = 0;
+
+static size_t heap_large_blocks = 0;
+static size_t heap_large_bytes = 0;
+
+#ifdef HEAP_TRACE_CALLSITES
+#define HEAP_SITE_SLOTS 256
+
+static HeapCallSite heap_sites[HEAP_SITE_SLOTS];
+static HeapCallSite heap_site_overflow; // Tablo dolunca tüm yeni noktalar burada toplanır
+
+static HeapCallSite* heap_site_slot(void* site)
+{
+    size_t idx = ((uintptr_t)site >> 4) % HEAP_SITE_SLOTS;
+    for (size_t i = 0; i < HEAP_SITE_SLOTS; i++)
+    {
+        HeapCallSite* slot = &heap_sites[(idx + i) % HEAP_SITE_SLOTS];
+        if (slot->site == site) return slot;
+        if (slot->site == NULL)
+        {
+            slot->site = site;
+            return slot;
+        }
+    }
+    return &heap_site_overflow;
+}
+
+static void heap_site_account_alloc(HeapNode* node, void* site)
+{
+    node->site = site;
+    HeapCallSite* slot = heap_site_slot(site);
+    slot->live_blocks++;
+    slot->live_bytes += node->size;
+    slot->total_allocs++;
+}
+
+static void heap_site_account_free(HeapNode* node)
+{
+    HeapCallSite* slot = heap_site_slot(node->site);
+    if (slot->live_blocks) slot->live_blocks--;
+    slot->live_bytes = slot->live_bytes > node->size ? slot->live_bytes - node->size : 0;
+}
+
+// Yerinde realloc: blok aynı çağrı noktasına ait kalır, yalnızca boyutu değişir
+static void heap_site_account_resize(HeapNode* node, size_t old_size)
+{
+    HeapCallSite* slot = heap_site_slot(node->site);
+    slot->live_bytes = slot->live_bytes > old_size ? slot->live_bytes - old_size : 0;
+    slot->live_bytes += node->size;
+}
+#endif
+
 extern List* memory_regions; // From pmm.c
 
+static inline HeapFreeLinks* node_links(HeapNode* node)
+{
+    return (HeapFreeLinks*)(node + 1);
+}
+
+static inline HeapNode* node_next(HeapNode* node)
+{
+    return (HeapNode*)((uint8_t*)(node + 1) + node->size);
+}
+
+static inline HeapNode* node_prev(HeapNode* node)
+{
+    size_t prev_size = *((size_t*)node - 1);
+    return (HeapNode*)((uint8_t*)node - prev_size - sizeof(HeapNode));
+}
+
+static void freelist_insert(HeapNode* node)
+{
+    HeapFreeLinks* links = node_links(node);
+    links->prev = NULL;
+    links->next = heap_free_list;
+    if (heap_free_list) node_links(heap_free_list)->prev = node;
+    heap_free_list = node;
+}
+
+static void freelist_remove(HeapNode* node)
+{
+    HeapFreeLinks* links = node_links(node);
+    if (links->prev) node_links(links->prev)->next = links->next;
+    else heap_free_list = links->next;
+    if (links->next) node_links(links->next)->prev = links->prev;
+}
+
+// Bloğu boş işaretle: footer'ı yaz, sonraki bloğa haber ver, free list'e ekle
+static void mark_free(HeapNode* node)
+{
+    node->flags |= HEAP_FLAG_FREE;
+    *(size_t*)((uint8_t*)node_next(node) - sizeof(size_t)) = node->size;
+    node_next(node)->flags |= HEAP_FLAG_PREV_FREE;
+    freelist_insert(node);
+}
+
+// Bölgenin ilk bloğu; initRegion'ın kuramayacağı kadar küçükse NULL
+static HeapNode* region_first_node(HeapRegion* region)
+{
+    if (region == NULL || region->base == 0 || region->size == 0) return NULL;
+
+    size_t start = HEAP_ALIGN_UP(region->base, HEAP_ALIGN);
+    size_t end = (region->base + region->size) & ~((size_t)HEAP_ALIGN - 1);
+    if (end < start + 2 * sizeof(HeapNode) + HEAP_MIN_PAYLOAD) return NULL;
+
+    return (HeapNode*)start;
+}
+
 static void initRegion(HeapRegion* region)
 {
     if (region == NULL) return;
 
     if (region->base == 0 || region->size == 0) return;
 
+    size_t start = HEAP_ALIGN_UP(region->base, HEAP_ALIGN);
+    size_t end = (region->base + region->size) & ~((size_t)HEAP_ALIGN - 1);
+
     // Require at least room for a head node and a terminal end node
-    if (region->size < 2 * sizeof(HeapNode)) return;
+    if (end < start + 2 * sizeof(HeapNode) + HEAP_MIN_PAYLOAD) return;
 
-    HeapNode* initial_node = (HeapNode*)region->base;
-    HeapNode* end_node = (HeapNode*)(region->base + region->size - sizeof(HeapNode));
+    HeapNode* initial_node = (HeapNode*)start;
+    HeapNode* end_node = (HeapNode*)(end - sizeof(HeapNode));
+
+    end_node->magic = HEAP_END_MAGIC;
+    end_node->flags = 0; // End node is never free, so it is never merged
+    end_node->size = 0;
 
     initial_node->magic = (uint32_t)HEAP_MAGIC;
-    initial_node->is_free = true;
-    initial_node->next = end_node;
+    initial_node->flags = 0; // Bölge başından önce birleşilecek blok yok
+    initial_node->size = (size_t)end_node - start - sizeof(HeapNode);
+
+    mark_free(initial_node);
+}
 
-    end_node->magic = 0; // Mark the end node with a magic value of 0
-    end_node->next = NULL;
-    end_node->is_free = false; // End node is not free
+// Free list'ten çıkarılmış bloğu tahsisli yapar, artan kuyruğu yeni boş blok olarak ayırır
+static void* use_block(HeapNode* node, size_t size)
+{
+    node->flags &= ~HEAP_FLAG_FREE;
+
+    size_t remaining_size = node->size - size;
+    if (remaining_size >= sizeof(HeapNode) + HEAP_MIN_PAYLOAD)
+    {
+        // Split the block; tail stays free and already precedes a PREV_FREE block
+        HeapNode* new_node = (HeapNode*)((uint8_t*)(node + 1) + size);
+        new_node->magic = HEAP_MAGIC;
+        new_node->flags = 0;
+        new_node->size = remaining_size - sizeof(HeapNode);
+
+        node->size = size;
+        mark_free(new_node);
+    }
+    else
+    {
+        // Use the entire block
+        node_next(node)->flags &= ~HEAP_FLAG_PREV_FREE;
+    }
+
+    return (void*)(node + 1);
+}
 
+// Boş blok içinde alignment'a hizalı ilk yük adresi. Öndeki boşluk ya sıfırdır ya da
+// kendi başına boş blok olabilecek kadar büyüktür; sığmıyorsa 0.
+static uintptr_t aligned_payload_in(HeapNode* node, size_t size, size_t alignment)
+{
+    uintptr_t start = (uintptr_t)(node + 1);
+    uintptr_t aligned = HEAP_ALIGN_UP(start, alignment);
+    while (aligned != start && aligned - start < sizeof(HeapNode) + HEAP_MIN_PAYLOAD)
+        aligned += alignment;
+
+    if (aligned + size > start + node->size)
+        return 0;
+    return aligned;
 }
 
-static void* alloc_region(HeapRegion* region, size_t size)
+static void* alloc_block(size_t size, size_t alignment)
 {
-    HeapNode* node = (HeapNode*)(region->base);
-    while (node && node->magic == HEAP_MAGIC)
+    size = HEAP_ALIGN_UP(size, HEAP_ALIGN);
+    if (size < HEAP_MIN_PAYLOAD) size = HEAP_MIN_PAYLOAD;
+
+    HeapNode* node = heap_free_list;
+    while (node)
     {
-        
-        if (node->is_free && NODE_SIZE(node) >= size)
+        if (alignment <= HEAP_ALIGN)
         {
-            size_t remaining_size = NODE_SIZE(node) - size;
-            if (remaining_size >= HEAP_NODE_MIN_SIZE + sizeof(HeapNode))
+            if (node->size >= size)
             {
-                // Split the block
-                HeapNode* new_node = (HeapNode*)((char*)node + size + sizeof(HeapNode));
-                new_node->magic = HEAP_MAGIC;
-                new_node->is_free = true;
-                new_node->next = node->next;
-
-                node->is_free = false;
-                node->next = new_node;
-
-                return (void*)((char*)node + sizeof(HeapNode));
+                freelist_remove(node);
+                return use_block(node, size);
             }
-            else
+        }
+        else if (node->size >= size)
+        {
+            uintptr_t aligned = aligned_payload_in(node, size, alignment);
+            if (aligned)
             {
-                // Use the entire block
-                node->is_free = false;
-                return (void*)((char*)node + sizeof(HeapNode));
+                freelist_remove(node);
+
+                HeapNode* target = (HeapNode*)aligned - 1;
+                if (target != node)
+                {
+                    // Öndeki boşluk ayrı bir boş blok olarak free list'e döner
+                    size_t lead = (size_t)((uint8_t*)target - (uint8_t*)node);
+                    target->magic = HEAP_MAGIC;
+                    target->flags = 0;
+                    target->size = node->size - lead;
+
+                    node->size = lead - sizeof(HeapNode);
+                    mark_free(node);
+                }
+                return use_block(target, size);
             }
         }
-        // Advance to next node when not returning above
-        node = node->next;
+        node = node_links(node)->next;
     }
 
     return NULL; // No suitable block found
 }
 
-static bool free_region(HeapRegion* region, void* ptr)
+static void free_block(HeapNode* node)
 {
-    if (ptr == NULL) return false;
-
-    HeapNode* node = (HeapNode*)region->base;
-    HeapNode* prev = NULL;
+    // Coalesce with next node if it's free
+    HeapNode* next = node_next(node);
+    if (next->magic == HEAP_MAGIC && (next->flags & HEAP_FLAG_FREE))
+    {
+        freelist_remove(next);
+        node->size += sizeof(HeapNode) + next->size;
+        next->magic = 0;
+    }
 
-    while (node && node->magic == HEAP_MAGIC)
+    // Coalesce with previous node via its footer
+    if (node->flags & HEAP_FLAG_PREV_FREE)
     {
-        if (
-            (size_t)node < (size_t)ptr &&
-            (size_t)ptr < (size_t)node->next
-        )
-        {
-            node->is_free = true;
+        HeapNode* prev = node_prev(node);
+        freelist_remove(prev);
+        prev->size += sizeof(HeapNode) + node->size;
+        node->magic = 0;
+        node = prev;
+    }
 
-            // Coalesce with next node if it's free
-            if (node->next && node->next->is_free)
-            {
-                node->next = node->next->next;
-            }
+    mark_free(node);
+}
 
-            // If have previous node and it's free, coalesce with it
-            if (prev && prev->is_free)
-            {
-                prev->next = node->next;
-                prev->is_free = true;
-                prev->magic = HEAP_MAGIC;
-            }
+static HeapRegion* heap_region_of(const void* ptr)
+{
+    size_t addr = (size_t)(uintptr_t)ptr;
+    size_t lo = 0, hi = heap_region_count;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        HeapRegion* region = heap_region_index[mid];
+        if (addr < region->base) hi = mid;
+        else if (addr - region->base >= region->size) lo = mid + 1;
+        else return region;
+    }
+    return NULL;
+}
 
-            return true;
-        }
-        prev = node;
-        node = node->next;
+// Bölgeyi sıralı indekse ve zincire yerleştirir; indeks doluysa false
+static bool heap_region_insert(HeapRegion* region)
+{
+    if (heap_region_count >= HEAP_MAX_REGIONS)
+    {
+        ERROR("heap: region index full (%u regions)", (unsigned)HEAP_MAX_REGIONS);
+        return false;
+    }
+
+    size_t pos = heap_region_count;
+    while (pos > 0 && heap_region_index[pos - 1]->base > region->base)
+    {
+        heap_region_index[pos] = heap_region_index[pos - 1];
+        pos--;
     }
+    heap_region_index[pos] = region;
+    heap_region_count++;
+
+    region->next = (pos + 1 < heap_region_count) ? heap_region_index[pos + 1] : NULL;
+    if (pos > 0) heap_region_index[pos - 1]->next = region;
+    else first_heap_region = region;
+
+    return true;
+}
+
+// Tahsisli bloğu size'a kadar daraltır; artan kuyruk yeterince büyükse ayrılıp
+// sonraki boş blokla birleştirilerek free list'e döner.
+static void shrink_block(HeapNode* node, size_t size)
+{
+    if (node->size - size < sizeof(HeapNode) + HEAP_MIN_PAYLOAD) return;
+
+    HeapNode* tail = (HeapNode*)((uint8_t*)(node + 1) + size);
+    tail->magic = HEAP_MAGIC;
+    tail->flags = 0; // Önceki blok (node) tahsisli
+    tail->size = node->size - size - sizeof(HeapNode);
+
+    node->size = size;
+    free_block(tail);
+}
+
+// Fiziksel olarak sonraki blok boşsa ve yetiyorsa bloğu onun içine doğru büyütür
+static bool grow_block(HeapNode* node, size_t size)
+{
+    HeapNode* next = node_next(node);
+    if (next->magic != HEAP_MAGIC || !(next->flags & HEAP_FLAG_FREE)) return false;
+    if (node->size + sizeof(HeapNode) + next->size < size) return false;
+
+    freelist_remove(next);
+    node->size += sizeof(HeapNode) + next->size;
+    next->magic = 0;
+    node_next(node)->flags &= ~HEAP_FLAG_PREV_FREE;
+
+    shrink_block(node, size);
+    return true;
+}
+
+// Kullanıcı işaretçisinden gerçek blok başlığını bulur; geçersizse NULL.
+// Büyük bloklar HEAP_LARGE_MAGIC ile döner.
+static HeapNode* heap_node_of(void* ptr)
+{
+    HeapNode* node = (HeapNode*)ptr - 1;
+    if (node->magic == HEAP_ALIGNED_MAGIC)
+        node = (HeapNode*)((uint8_t*)node - node->size);
+    if (node->magic == HEAP_LARGE_MAGIC)
+        return node;
+    if (node->magic != HEAP_MAGIC || !heap_region_of(node))
+        return NULL;
+    return node;
+}
+
+// Büyük blok: başlık sayfanın başında, kullanıcı verisi hemen ardından.
+// PMM henüz hazır değilse NULL döner ve istek first-fit'e düşer.
+static void* heap_large_alloc(size_t n)
+{
+    size_t pages = (HEAP_ALIGN_UP(n, HEAP_ALIGN) + sizeof(HeapNode) + PMM_PAGE_SIZE - 1) / PMM_PAGE_SIZE;
+    HeapNode* node = (HeapNode*)pmm_alloc_pages_exact(pages);
+    if (!node) return NULL;
 
-    return false;
+    node->magic = HEAP_LARGE_MAGIC;
+    node->flags = 0;
+    node->size = pages * PMM_PAGE_SIZE - sizeof(HeapNode);
+
+    heap_large_blocks++;
+    heap_large_bytes += pages * PMM_PAGE_SIZE;
+    return (void*)(node + 1);
+}
+
+static void heap_large_free(HeapNode* node)
+{
+    size_t bytes = node->size + sizeof(HeapNode);
+    node->magic = 0;
+
+    heap_large_blocks--;
+    heap_large_bytes -= bytes;
+    pmm_free_pages_exact(node, bytes / PMM_PAGE_SIZE);
 }
 
 void heap_init()
@@ -132,65 +428,64 @@ void heap_init()
     localHeapRegion.next = NULL;
 
     first_heap_region = &localHeapRegion;
+    heap_region_index[0] = &localHeapRegion;
+    heap_region_count = 1;
 
     initRegion(&localHeapRegion);
 
 }
 
-void* heap_alloc(size_t n) {
+static void* heap_firstfit_alloc_aligned(size_t n, size_t alignment) {
     if (n <= 0) return NULL;
 
     if (first_heap_region == NULL) {
         heap_init();
     }
 
-    HeapRegion* region = first_heap_region;
-    while (region) {
-        void* ptr = alloc_region(region, n);
-        if (ptr) {
-            return ptr;
-        }else region = region->next;
-    }
+    void* ptr = alloc_block(n, alignment);
+    if (ptr) return ptr;
 
     if (memory_regions)
     {
 
         LOG("Heap exhausted, attempting to expand...");
 
-        // PMM active ise PMM'den yeni bir heap bölgesi al
-        size_t regionSize = n + (4096 - (n % 4096));  // Align up to page size
-
-        regionSize += 0x1000; // Extra space for HeapNode structures
-
-        void* newRegionPtr = pmm_alloc(regionSize / 1024); // PMM'den KB cinsinden al
+        // Bölgeler geometrik büyür; küçük isteklerle sık genişlemeyi ve uzun bölge zincirini önler
+        size_t header = HEAP_ALIGN_UP(sizeof(HeapRegion), HEAP_ALIGN);
+        size_t slack = alignment > HEAP_ALIGN ? alignment + sizeof(HeapNode) + HEAP_MIN_PAYLOAD : 0;
+        size_t needed = HEAP_ALIGN_UP(header + HEAP_ALIGN_UP(n, HEAP_ALIGN) + slack + 3 * sizeof(HeapNode) + HEAP_MIN_PAYLOAD, PMM_PAGE_SIZE);
+        size_t regionSize = needed > heap_next_grow ? needed : heap_next_grow;
+
+        void* newRegionPtr = pmm_alloc_pages_exact(regionSize / PMM_PAGE_SIZE);
+        if (!newRegionPtr && regionSize > needed) {
+            // Bellek sıkışık; yalnızca bu isteğe yetecek kadarını dene
+            regionSize = needed;
+            newRegionPtr = pmm_alloc_pages_exact(regionSize / PMM_PAGE_SIZE);
+        }
         if (!newRegionPtr) {
-            ERROR("heap_alloc: pmm_alloc failed to allocate new heap region of size %zu bytes ( %zu kb, %zu mb )", regionSize, regionSize / 1024, regionSize / (1024 * 1024));
+            ERROR("heap_alloc: pmm failed to allocate new heap region of size %zu bytes ( %zu kb, %zu mb )", regionSize, regionSize / 1024, regionSize / (1024 * 1024));
             return NULL;
         }
 
-        HeapRegion newRegion;
-        newRegion.base = (size_t)(uintptr_t)newRegionPtr;
-        newRegion.size = regionSize;
-        newRegion.next = NULL;
-        initRegion(&newRegion);
-
-        HeapRegion* region = (HeapRegion*)alloc_region(&newRegion, sizeof(HeapRegion));
-        
-        region->base = newRegion.base;
-        region->size = newRegion.size;
+        // Bölge tanımlayıcısı bölgenin başında durur
+        HeapRegion* region = (HeapRegion*)newRegionPtr;
+        region->base = (size_t)(uintptr_t)newRegionPtr + header;
+        region->size = regionSize - header;
         region->next = NULL;
 
-        // Bağlantı listesinin sonuna ekle
-        HeapRegion* last = first_heap_region;
-        while (last->next) {
-            last = last->next;
+        if (!heap_region_insert(region)) {
+            pmm_free_pages_exact(newRegionPtr, regionSize / PMM_PAGE_SIZE);
+            return NULL;
         }
+        initRegion(region);
+        heap_expanded_regions++;
 
-        last->next = region;
+        if (heap_next_grow < HEAP_GROW_MAX)
+            heap_next_grow *= 2;
 
-        void* _Ret = alloc_region(region, n);
+        void* _Ret = alloc_block(n, alignment);
         if (!_Ret) {
-            ERROR("heap_alloc: alloc_region failed after expanding heap");
+            ERROR("heap_alloc: alloc_block failed after expanding heap");
             return NULL;
         }
 
@@ -205,78 +500,199 @@ void* heap_alloc(size_t n) {
     return NULL; // No memory available
 }
 
+// First-fit yolu; slab katmanı kendi sayfalarını da buradan alır.
+void* heap_firstfit_alloc(size_t n) {
+    return heap_firstfit_alloc_aligned(n, HEAP_ALIGN);
+}
+
+void* heap_alloc_from(size_t n, void* site) {
+    if (n <= 0) return NULL;
+
+    heap_busy++;
+
+#ifndef HEAP_TRACE_CALLSITES
+    // Çağrı noktası izlenirken slab devre dışıdır: her bloğun bir başlığı olmalı
+    if (n <= SLAB_MAX_SIZE) {
+        void* ptr = slab_alloc(n);
+        if (ptr) {
+            heap_busy--;
+            return ptr;
+        }
+    }
+#endif
+
+    void* ptr = NULL;
+    if (n >= HEAP_LARGE_MIN)
+        ptr = heap_large_alloc(n);
+    if (!ptr)
+        ptr = heap_firstfit_alloc(n);
+
+#ifdef HEAP_TRACE_CALLSITES
+    if (ptr) heap_site_account_alloc((HeapNode*)ptr - 1, site);
+#endif
+
+    heap_busy--;
+    return ptr;
+}
+
+void* heap_alloc(size_t n) {
+    return heap_alloc_from(n, HEAP_CALLER());
+}
+
 void heap_free(void* ptr) {
     if (ptr == NULL) return;
 
-    if (first_heap_region == NULL) {
-        heap_init();
+    heap_busy++;
+
+    if (slab_free(ptr)) {
+        heap_busy--;
+        return;
     }
 
-    HeapRegion* region = first_heap_region;
-    while (region) {
-        if (free_region(region, ptr)) {
-            return; // Successfully freed
-        }
-        region = region->next;
+    HeapNode* node = heap_node_of(ptr);
+    if (!node) {
+        WARN("heap_free: invalid pointer %p", ptr);
+        heap_busy--;
+        return;
+    }
+
+    if (node->flags & HEAP_FLAG_FREE) {
+        WARN("heap_free: double free of %p", ptr);
+        heap_busy--;
+        return;
     }
+
+#ifdef HEAP_TRACE_CALLSITES
+    heap_site_account_free(node);
+#endif
+
+    if (node->magic == HEAP_LARGE_MAGIC)
+        heap_large_free(node);
+    else
+        free_block(node);
+    heap_busy--;
 }
 
-void *heap_realloc(void* ptr, size_t new_size) {
+void* heap_realloc(void* ptr, size_t new_size) {
+    return heap_realloc_from(ptr, new_size, HEAP_CALLER());
+}
+
+void* heap_realloc_from(void* ptr, size_t new_size, void* site) {
     if (new_size <= 0) {
         heap_free(ptr);
         return NULL;
     }
 
     if (ptr == NULL) {
-        return heap_alloc(new_size);
+        return heap_alloc_from(new_size, site);
     }
 
-    HeapNode* node = (HeapNode*)((char*)ptr - sizeof(HeapNode));
-    if (node->magic != HEAP_MAGIC) {
-        return NULL; // Invalid pointer
+    size_t old_size = slab_object_size(ptr);
+    if (old_size == 0) {
+        HeapNode* node = heap_node_of(ptr);
+        if (!node) {
+            return NULL; // Invalid pointer
+        }
+
+        old_size = node->size - (size_t)((uint8_t*)ptr - (uint8_t*)(node + 1));
+
+        // Sıradan heap bloğu: taşımadan önce yerinde daraltmayı/büyütmeyi dene
+        if (node->magic == HEAP_MAGIC && ptr == (void*)(node + 1)) {
+            size_t size = HEAP_ALIGN_UP(new_size, HEAP_ALIGN);
+            if (size < HEAP_MIN_PAYLOAD) size = HEAP_MIN_PAYLOAD;
+
+            heap_busy++;
+            size_t before = node->size;
+            bool in_place = true;
+            if (size <= node->size)
+                shrink_block(node, size);
+            else
+                in_place = grow_block(node, size);
+#ifdef HEAP_TRACE_CALLSITES
+            if (in_place && node->size != before) heap_site_account_resize(node, before);
+#endif
+            (void)before;
+            heap_busy--;
+
+            if (in_place) return ptr;
+        }
     }
 
-    size_t old_size = NODE_SIZE(node);
     if (new_size <= old_size) {
-        return ptr; // No need to reallocate
+        return ptr; // Slab nesnesi veya büyük blok zaten yeterli
     }
 
-    void* new_ptr = heap_alloc(new_size);
+    // Sayfa bloklarına taşınan büyüyen tamponlar (log, overlay) her adımda yeniden
+    // kopyalanmasın diye payı %50 artır; fazlası node->size'da kalır ve sonraki
+    // realloc'lar onu yerinde kullanır.
+    size_t alloc_size = new_size;
+    if (new_size >= HEAP_LARGE_MIN && new_size < old_size + old_size / 2) {
+        alloc_size = old_size + old_size / 2;
+    }
+
+    void* new_ptr = heap_alloc_from(alloc_size, site);
     if (new_ptr) {
         memcpy(new_ptr, ptr, old_size); // Copy old data to new location
         heap_free(ptr); // Free old memory
     }
-    
+
     return new_ptr;
 }
 
-void *heap_calloc(size_t count, size_t size) {
+void* heap_calloc(size_t count, size_t size) {
+    return heap_calloc_from(count, size, HEAP_CALLER());
+}
+
+void* heap_calloc_from(size_t count, size_t size, void* site) {
     if (count == 0 || size == 0) return NULL;
 
-    void* ptr = heap_alloc(count * size);
+    void* ptr = heap_alloc_from(count * size, site);
     if (ptr) {
         memset(ptr, 0, count * size); // Zero out the allocated memory
     }
-    
+
     return ptr;
 }
 
 void* heap_aligned_alloc(size_t alignment, size_t size)
+{
+    return heap_aligned_alloc_from(alignment, size, HEAP_CALLER());
+}
+
+void* heap_aligned_alloc_from(size_t alignment, size_t size, void* site)
 {
     if (alignment == 0 || size == 0 || (alignment & (alignment - 1)) != 0) {
         return NULL; // Invalid alignment or size
     }
 
-    void* ptr = heap_alloc(size + alignment - 1 + sizeof(HeapNode));
+    if (alignment <= HEAP_ALIGN) {
+        return heap_alloc_from(size, site);
+    }
+
+    // Heap bloğu doğrudan hizalı adreste oyulur; öndeki ve arkadaki artık free list'e döner
+    if (size + alignment < HEAP_LARGE_MIN) {
+        heap_busy++;
+        void* block = heap_firstfit_alloc_aligned(size, alignment);
+#ifdef HEAP_TRACE_CALLSITES
+        if (block) heap_site_account_alloc((HeapNode*)block - 1, site);
+#endif
+        heap_busy--;
+        return block;
+    }
+
+    // Büyük bloklar sayfa olarak gelir; artık sayfalarla birlikte PMM'e döner.
+    // Sahte başlık heap_free'nin gerçek bloğu O(1) bulmasını sağlar.
+    void* ptr = heap_alloc_from(size + alignment - 1 + sizeof(HeapNode), site);
     if (!ptr) return NULL;
 
-    // Align the pointer
+    if (((uintptr_t)ptr & (alignment - 1)) == 0) return ptr;
+
     uintptr_t aligned_ptr = ((uintptr_t)ptr + sizeof(HeapNode) + alignment - 1) & ~(alignment - 1);
-    
+
     HeapNode* node = (HeapNode*)((char*)aligned_ptr - sizeof(HeapNode));
-    node->magic = HEAP_MAGIC;
-    node->is_free = false;
-    node->next = NULL;
+    node->magic = HEAP_ALIGNED_MAGIC;
+    node->flags = 0;
+    node->size = (size_t)((uint8_t*)node - ((uint8_t*)ptr - sizeof(HeapNode)));
 
     return (void*)aligned_ptr;
 }
@@ -287,10 +703,128 @@ void heap_register_region(HeapRegion* region)
     if (region->base == 0 || region->size == 0) return;
     if (region->size < 2 * sizeof(HeapNode)) return;
 
-    // Initialize the region's free list
+    if (first_heap_region == NULL) {
+        heap_init();
+    }
+
+    if (!heap_region_insert(region)) return;
+
+    // Initialize the region's free blocks
     initRegion(region);
+}
+
+bool heap_get_stats(HeapStats* stats)
+{
+    if (!stats) return false;
+    if (heap_busy) return false; // Bir alloc/free'nin ortasında; tutarsız görüntü olur
+
+    memset(stats, 0, sizeof(HeapStats));
+
+    size_t flags = arch_irq_save();
+
+    for (HeapRegion* region = first_heap_region; region; region = region->next)
+    {
+        stats->region_count++;
+
+        HeapNode* node = region_first_node(region);
+        while (node && node->magic == HEAP_MAGIC)
+        {
+            stats->node_count++;
+            if (node->flags & HEAP_FLAG_FREE)
+            {
+                stats->free_node_count++;
+                stats->bytes_free += node->size;
+                if (node->size > stats->largest_free_block)
+                    stats->largest_free_block = node->size;
+            }
+            else
+            {
+                stats->bytes_in_use += node->size;
+            }
+            node = node_next(node);
+        }
+
+        if (node && node->magic != HEAP_END_MAGIC)
+            WARN("heap_get_stats: corrupt node %p in region %p", node, region);
+    }
+
+    stats->expanded_regions = heap_expanded_regions;
+    stats->large_blocks = heap_large_blocks;
+    stats->large_bytes = heap_large_bytes;
+    stats->slab_bytes_in_use = slab_bytes_in_use();
+
+    arch_irq_restore(flags);
+    return true;
+}
+
+size_t heap_get_callsites(HeapCallSite* out, size_t max)
+{
+#ifdef HEAP_TRACE_CALLSITES
+    if (!out || max == 0) return 0;
+
+    // live_bytes'a göre azalan sırada ilk max nokta (tablo küçük, ekleme sıralaması yeterli)
+    size_t count = 0;
+    for (size_t i = 0; i <= HEAP_SITE_SLOTS; i++)
+    {
+        HeapCallSite* site = (i < HEAP_SITE_SLOTS) ? &heap_sites[i] : &heap_site_overflow;
+        if (site->live_blocks == 0) continue;
+
+        size_t pos;
+        if (count < max) pos = count++;
+        else if (out[max - 1].live_bytes < site->live_bytes) pos = max - 1;
+        else continue;
+
+        while (pos > 0 && out[pos - 1].live_bytes < site->live_bytes)
+        {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos] = *site;
+    }
+    return count;
+#else
+    (void)out;
+    (void)max;
+    return 0;
+#endif
+}
+
+void heap_dump_stats(void)
+{
+    HeapStats stats;
+    if (!heap_get_stats(&stats)) return;
+
+    LOG("heap: in use %zu KiB, free %zu KiB, largest free %zu KiB, slab objects %zu KiB",
+        stats.bytes_in_use / 1024, stats.bytes_free / 1024,
+        stats.largest_free_block / 1024, stats.slab_bytes_in_use / 1024);
+    LOG("heap: %zu nodes (%zu free), %zu regions (%zu from expansion)",
+        stats.node_count, stats.free_node_count, stats.region_count, stats.expanded_regions);
+    LOG("heap: %zu large blocks in %zu KiB of pages",
+        stats.large_blocks, stats.large_bytes / 1024);
+
+#ifdef HEAP_TRACE_CALLSITES
+    HeapCallSite top[HEAP_DUMP_TOP_SITES];
+    size_t count = heap_get_callsites(top, HEAP_DUMP_TOP_SITES);
+    for (size_t i = 0; i < count; i++)
+    {
+        LOG("heap:   site %p: %zu blocks, %zu bytes live, %zu allocs total",
+            top[i].site, top[i].live_blocks, top[i].live_bytes, top[i].total_allocs);
+    }
+#endif
+}
+
+static void heap_stats_dump_task(void* task, void* arg)
+{
+    (void)task;
+    (void)arg;
+    heap_dump_stats();
+}
+
+void heap_stats_dump_start(size_t interval_ms)
+{
+    static PeriodicTask* dump_task = NULL;
+    if (dump_task) return;
 
-    // Insert at the end of the linked list
-    region->next = NULL;
-    first_heap_region->next = region;
+    dump_task = periodic_task_create("heap_stats", heap_stats_dump_task, NULL, interval_ms);
+    if (dump_task) periodic_task_start(dump_task);
 }
@@ -3,7 +3,7 @@
 
 void *malloc(size_t size)
 {
-    return heap_alloc(size);
+    return heap_alloc_from(size, HEAP_CALLER());
 }
 void free(void *ptr)
 {
@@ -11,42 +11,18 @@ void free(void *ptr)
 }
 void *realloc(void *ptr, size_t size)
 {
-    return heap_realloc(ptr, size);
+    return heap_realloc_from(ptr, size, HEAP_CALLER());
 }
 void *calloc(size_t count, size_t size)
 {
-    return heap_calloc(count, size);
+    return heap_calloc_from(count, size, HEAP_CALLER());
 }
 void *malloc_aligned(size_t alignment, size_t size)
 {
-    return heap_aligned_alloc(alignment, size);
+    return heap_aligned_alloc_from(alignment, size, HEAP_CALLER());
 }
 
-void memset(void *ptr, char value, size_t num)
-{
-    for (size_t i = 0; i < num; i++)
-    {
-        ((char *)ptr)[i] = value;
-    }
-}
-
-void memmove(void *dest, const void *src, size_t n)
-{
-    if (!dest || !src || n == 0) return;
-
-    unsigned char *d = (unsigned char *)dest;
-    const unsigned char *s = (const unsigned char *)src;
-
-    if (d < s) {
-        for (size_t i = 0; i < n; ++i) {
-            d[i] = s[i];
-        }
-    } else if (d > s) {
-        for (size_t i = n; i != 0; --i) {
-            d[i - 1] = s[i - 1];
-        }
-    }
-}
+// memcpy, memmove ve memset mimariye özgü assembly'dedir (kernel/{i386,amd64}/memcpy.asm, memset.asm)
 
 int memcmp(const void *s1, const void *s2, size_t n)
 {
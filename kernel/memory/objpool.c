@@ -0,0 +1,151 @@
+#include <memory/objpool.h>
+#include <memory/memory.h>
+#include <arch.h>
+#include <debug/debug.h>
+
+#define OBJECT_POOL_ALIGN (2 * sizeof(void*))
+
+typedef struct ObjectPoolChunk
+{
+    struct ObjectPoolChunk* next;
+    size_t count;
+} __attribute__((aligned(2 * sizeof(void*)))) ObjectPoolChunk;
+
+typedef struct ObjectPoolFree
+{
+    struct ObjectPoolFree* next;
+} ObjectPoolFree;
+
+static void object_pool_setup(ObjectPool* pool)
+{
+    size_t size = pool->object_size;
+    if (size < sizeof(ObjectPoolFree)) size = sizeof(ObjectPoolFree);
+    pool->object_size = (size + OBJECT_POOL_ALIGN - 1) & ~(OBJECT_POOL_ALIGN - 1);
+    if (pool->grow_count == 0) pool->grow_count = 32;
+    pool->initialized = true;
+}
+
+// Yeni bir chunk ayırıp nesnelerini boş listeye ekler. Heap çağrısı kesmeler açıkken yapılır.
+static bool object_pool_grow(ObjectPool* pool, size_t count)
+{
+    ObjectPoolChunk* chunk = (ObjectPoolChunk*)malloc(sizeof(ObjectPoolChunk) + count * pool->object_size);
+    if (!chunk)
+    {
+        WARN("object pool %s: out of memory growing by %zu objects", pool->name, count);
+        return false;
+    }
+
+    chunk->count = count;
+    uint8_t* objects = (uint8_t*)(chunk + 1);
+
+    size_t flags = arch_irq_save();
+
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    for (size_t i = count; i > 0; i--)
+    {
+        ObjectPoolFree* obj = (ObjectPoolFree*)(objects + (i - 1) * pool->object_size);
+        obj->next = (ObjectPoolFree*)pool->free_list;
+        pool->free_list = obj;
+    }
+    pool->total_objects += count;
+
+    arch_irq_restore(flags);
+    return true;
+}
+
+bool object_pool_init(ObjectPool* pool, const char* name, size_t object_size, size_t initial_count, bool growable)
+{
+    if (!pool || object_size == 0) return false;
+
+    pool->name = name ? name : "unnamed";
+    pool->object_size = object_size;
+    pool->grow_count = initial_count;
+    pool->growable = growable;
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    pool->total_objects = 0;
+    pool->in_use = 0;
+    object_pool_setup(pool);
+
+    if (initial_count == 0) return true;
+    return object_pool_grow(pool, initial_count);
+}
+
+void object_pool_destroy(ObjectPool* pool)
+{
+    if (!pool || !pool->initialized) return;
+
+    if (pool->in_use)
+        WARN("object pool %s: destroyed with %zu objects in use", pool->name, pool->in_use);
+
+    ObjectPoolChunk* chunk = pool->chunks;
+    while (chunk)
+    {
+        ObjectPoolChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    pool->chunks = NULL;
+    pool->free_list = NULL;
+    pool->total_objects = 0;
+    pool->in_use = 0;
+    pool->initialized = false;
+}
+
+bool object_pool_reserve(ObjectPool* pool, size_t count)
+{
+    if (!pool) return false;
+    if (!pool->initialized) object_pool_setup(pool);
+
+    size_t available = pool->total_objects - pool->in_use;
+    if (available >= count) return true;
+    return object_pool_grow(pool, count - available);
+}
+
+void* object_pool_alloc(ObjectPool* pool)
+{
+    if (!pool) return NULL;
+    if (!pool->initialized) object_pool_setup(pool);
+
+    for (;;)
+    {
+        size_t flags = arch_irq_save();
+        ObjectPoolFree* obj = (ObjectPoolFree*)pool->free_list;
+        if (obj)
+        {
+            pool->free_list = obj->next;
+            pool->in_use++;
+            arch_irq_restore(flags);
+            return obj;
+        }
+        bool can_grow = pool->growable || pool->total_objects == 0;
+        arch_irq_restore(flags);
+
+        if (!can_grow || !object_pool_grow(pool, pool->grow_count))
+            return NULL;
+    }
+}
+
+void object_pool_free(ObjectPool* pool, void* obj)
+{
+    if (!pool || !obj) return;
+
+    size_t flags = arch_irq_save();
+
+    if (pool->in_use == 0)
+    {
+        arch_irq_restore(flags);
+        WARN("object pool %s: free of %p with no objects in use", pool->name, obj);
+        return;
+    }
+
+    ObjectPoolFree* node = (ObjectPoolFree*)obj;
+    node->next = (ObjectPoolFree*)pool->free_list;
+    pool->free_list = node;
+    pool->in_use--;
+
+    arch_irq_restore(flags);
+}
@@ -4,8 +4,10 @@
 #include <util/assert.h>
 #include <efi/efi.h>
 #include <memory/memory.h>
+#include <memory/bootmem.h>
 #include <list.h>
 #include <graphics/screen.h>
+#include <arch.h>
 
 List *memory_regions = NULL; // Bellek bölgelerinin başı
 
@@ -14,12 +16,16 @@ extern char __kernel_start[];
 extern char __kernel_end[];
 extern char __kernel_size[];
 
+extern uint32_t mb2_tagptr;
+
 void efi_mr_init(void);
 void bios_mr_init(void);
 void print_memory_regions();
+static void pmm_buddy_init(void);
 
 UINTN bs_map_key;
 UINTN bs_mr_memory_map_size = 0; // İlk çağrıda 0
+UINTN bs_mr_memory_map_capacity = 0; // ExitBootServices yeniden denemesi haritayı buraya tekrar alır
 EFI_MEMORY_DESCRIPTOR *bs_mr_memory_map = NULL;
 UINTN bs_mr_descriptor_size = 0;
 uint32_t bs_mr_descriptor_version = 0;
@@ -186,6 +192,8 @@ void pmm_init(void)
         }
     }
 
+    pmm_buddy_init();
+
 }
 
 void bios_mr_init(void)
@@ -217,10 +225,43 @@ void bios_mr_init(void)
     }
 }
 
+// EFI tanımlayıcılarını bölge listesine ekler. loader_exited ise yükleyici
+// ExitBootServices'i çağırmıştır: Loader bölgeleri boştur (çekirdek, mb2 bilgisi ve
+// modül ayrıca korunur); BS bölgeleri türleriyle kalır, efi_exit_boot_services geri kazanır.
+static void efi_mr_add_descriptors(const uint8_t* map, size_t map_size, size_t desc_size, bool loader_exited)
+{
+    for (size_t offset = 0; offset + desc_size <= map_size; offset += desc_size)
+    {
+        const EFI_MEMORY_DESCRIPTOR *entry = (const EFI_MEMORY_DESCRIPTOR *)(map + offset);
+
+        // Bellek bölgesi bilgilerini listeye ekle
+        MemoryRegion *newRegion = (MemoryRegion *)malloc(sizeof(MemoryRegion));
+        newRegion->base = entry->physical_start;
+        newRegion->size = entry->number_of_pages * 4096; // EFI sayfa boyutu genellikle 4KB'dir
+        newRegion->type = efiType_to_mrType(entry->type);
+        if (loader_exited && (newRegion->type == MemoryRegionType_EFI_LOADER_CODE ||
+                              newRegion->type == MemoryRegionType_EFI_LOADER_DATA))
+            newRegion->type = MemoryRegionType_USABLE;
+        List_Add(memory_regions, newRegion);
+    }
+}
+
 void efi_mr_init(void)
 {
     // EFI tabanlı bellek bölgesi başlatma kodu buraya gelecek
 
+    // Yükleyici boot services'ten çıktıysa EFI haritasını etiketle verir; e820 biçimli
+    // mb2 haritası BS bölgelerini ayırt etmediğinden ondan önce gelir
+    if (mb2_efi_mmap && mb2_efi_mmap->descr_size >= sizeof(EFI_MEMORY_DESCRIPTOR))
+    {
+        if (memory_regions == NULL)
+            memory_regions = List_Create();
+        List_Clear(memory_regions, true);
+        efi_mr_add_descriptors(mb2_efi_mmap->efi_mmap, mb2_efi_mmap->size - sizeof(struct multiboot_tag_efi_mmap),
+                               mb2_efi_mmap->descr_size, true);
+        return;
+    }
+
     if (mb2_mmap)
     {
         bios_mr_init();
@@ -254,7 +295,11 @@ void efi_mr_init(void)
     // status = bs->get_memory_map(&memory_map_size, memory_map, &map_key, &descriptor_size, &descriptor_version);
     // if (status == EFI_BUFFER_TOO_SMALL) { yeniden allocate_pool + tekrar dene... }
 
-    bs_mr_memory_map = (EFI_MEMORY_DESCRIPTOR *)malloc(bs_mr_memory_map_size);
+    // Harita yalnızca açılışta gerekir; heap yerine bootmem'den al. İki çağrı arasında ve
+    // ExitBootServices yeniden denemesinde harita büyüyebilir, birkaç girdilik pay bırak.
+    bs_mr_memory_map_capacity = bs_mr_memory_map_size + 8 * bs_mr_descriptor_size;
+    bs_mr_memory_map_size = bs_mr_memory_map_capacity;
+    bs_mr_memory_map = (EFI_MEMORY_DESCRIPTOR *)bootmem_alloc(bs_mr_memory_map_capacity, 16);
 
     ASSERT(bs_mr_memory_map != NULL, "Failed to allocate memory for EFI memory map");
 
@@ -275,17 +320,7 @@ void efi_mr_init(void)
     LOG("EFI Memory Map obtained: size=%lu, descriptor_size=%lu, version=%u",
         bs_mr_memory_map_size, bs_mr_descriptor_size, bs_mr_descriptor_version);
 
-    for (UINTN offset = 0; offset < bs_mr_memory_map_size; offset += bs_mr_descriptor_size)
-    {
-        EFI_MEMORY_DESCRIPTOR *entry = (EFI_MEMORY_DESCRIPTOR *)((uintptr_t)bs_mr_memory_map + offset);
-
-        // Bellek bölgesi bilgilerini listeye ekle
-        MemoryRegion *newRegion = (MemoryRegion *)malloc(sizeof(MemoryRegion));
-        newRegion->base = entry->physical_start;
-        newRegion->size = entry->number_of_pages * 4096; // EFI sayfa boyutu genellikle 4KB'dir
-        newRegion->type = efiType_to_mrType(entry->type);
-        List_Add(memory_regions, newRegion);
-    }
+    efi_mr_add_descriptors((const uint8_t *)bs_mr_memory_map, bs_mr_memory_map_size, bs_mr_descriptor_size, false);
 }
 
 char *mrTypeToString(MemoryRegionType type)
@@ -397,241 +432,487 @@ void pmm_maintain()
     }
 }
 
-void *pmm_alloc(size_t sizeInKB)
+// ---------------------------------------------------------------------------
+// Buddy allocator
+//
+// Boş bloklar kendi ilk sayfalarında tutulan çift yönlü listelerle order başına
+// zincirlenir; sayfa başına bir bayt (pmm_page_info) blok başını, order'ını ve
+// durumunu tutar. Bu yüzden tahsis ve serbest bırakma heap'e hiç dokunmaz.
+// Boş sayfalar yazılabilir olmak zorunda olduğundan yalnızca ilk 4 GiB
+// (identity map edilen alan) yönetilir.
+// ---------------------------------------------------------------------------
+
+#define PMM_PAGE_SHIFT      12
+#define PMM_PHYS_LIMIT      0x100000000ULL
+
+#define PMM_INFO_ORDER_MASK 0x1F
+#define PMM_INFO_ALLOC      0x40 // Tahsisli bloğun ilk sayfası
+#define PMM_INFO_FREE       0x80 // Boş bloğun ilk sayfası
+
+#define PMM_MAX_EXCLUDED    4
+
+typedef struct PmmFreeBlock
+{
+    struct PmmFreeBlock* prev;
+    struct PmmFreeBlock* next;
+} PmmFreeBlock;
+
+typedef struct PmmRange
+{
+    size_t start;
+    size_t end;
+} PmmRange;
+
+static PmmFreeBlock* pmm_free_lists[PMM_MAX_ORDER + 1];
+static size_t pmm_free_counts[PMM_MAX_ORDER + 1];
+static uint8_t* pmm_page_info = NULL;
+static size_t pmm_max_pfn = 0;
+static size_t pmm_total_pages = 0;
+static size_t pmm_free_page_count = 0;
+
+// Seed sırasında buddy'ye verilmeyecek aralıklar (multiboot bilgisi, metadata, ...)
+static PmmRange pmm_excluded[PMM_MAX_EXCLUDED];
+static size_t pmm_excluded_count = 0;
+
+static inline PmmFreeBlock* pfn_to_block(size_t pfn)
+{
+    return (PmmFreeBlock*)(uintptr_t)(pfn << PMM_PAGE_SHIFT);
+}
+
+static inline size_t block_to_pfn(const void* block)
+{
+    return (size_t)(uintptr_t)block >> PMM_PAGE_SHIFT;
+}
+
+static void pmm_list_push(size_t pfn, uint32_t order)
 {
-    if (!memory_regions || sizeInKB == 0)
+    PmmFreeBlock* block = pfn_to_block(pfn);
+    block->prev = NULL;
+    block->next = pmm_free_lists[order];
+    if (block->next) block->next->prev = block;
+    pmm_free_lists[order] = block;
+    pmm_free_counts[order]++;
+    pmm_page_info[pfn] = (uint8_t)(PMM_INFO_FREE | order);
+}
+
+static void pmm_list_remove(size_t pfn, uint32_t order)
+{
+    PmmFreeBlock* block = pfn_to_block(pfn);
+    if (block->prev) block->prev->next = block->next;
+    else pmm_free_lists[order] = block->next;
+    if (block->next) block->next->prev = block->prev;
+    pmm_free_counts[order]--;
+    pmm_page_info[pfn] = 0;
+}
+
+// Bloğu boş listeye koyar, buddy'si boş oldukça yukarı doğru birleştirir
+static void pmm_release_block(size_t pfn, uint32_t order)
+{
+    pmm_free_page_count += (size_t)1 << order;
+
+    while (order < PMM_MAX_ORDER)
     {
-        LOG("pmm_alloc: invalid parameters (memory_regions=%p, sizeInKB=%zu)", (void *)memory_regions, sizeInKB);
-        return NULL;
+        size_t buddy = pfn ^ ((size_t)1 << order);
+        if (buddy + ((size_t)1 << order) > pmm_max_pfn)
+            break;
+        if (pmm_page_info[buddy] != (uint8_t)(PMM_INFO_FREE | order))
+            break;
+
+        pmm_list_remove(buddy, order);
+        if (buddy < pfn) pfn = buddy;
+        order++;
     }
 
-    // KB -> bytes, overflow guard
-    if (sizeInKB > (SIZE_MAX / 1024))
+    pmm_list_push(pfn, order);
+}
+
+static void pmm_seed_range(size_t start, size_t end, size_t first_exclusion)
+{
+    for (size_t i = first_exclusion; i < pmm_excluded_count; i++)
     {
-        LOG("pmm_alloc: sizeInKB too large: %zu", sizeInKB);
-        return NULL; // overflow korumasi
+        PmmRange* ex = &pmm_excluded[i];
+        if (ex->start < end && ex->end > start)
+        {
+            if (ex->start > start) pmm_seed_range(start, ex->start, i + 1);
+            if (ex->end < end) pmm_seed_range(ex->end, end, i + 1);
+            return;
+        }
     }
-    size_t bytes = sizeInKB * 1024;
 
-    // 4KiB hizalama (EFI_PAGE_SIZE)
-    const size_t PAGE = EFI_PAGE_SIZE; // 4096
-    size_t alloc_size = (bytes + PAGE - 1) & ~(PAGE - 1);
-    if (alloc_size == 0)
+    size_t pfn = (start + PMM_PAGE_SIZE - 1) >> PMM_PAGE_SHIFT;
+    size_t end_pfn = end >> PMM_PAGE_SHIFT;
+    if (end_pfn > pmm_max_pfn) end_pfn = pmm_max_pfn;
+
+    while (pfn < end_pfn)
     {
-        LOG("pmm_alloc: alloc_size overflow for sizeInKB=%zu", sizeInKB);
-        return NULL; // overflow korumasi
+        // Hizalamanın ve kalan uzunluğun izin verdiği en büyük blok
+        uint32_t order = 0;
+        while (order < PMM_MAX_ORDER &&
+               (pfn & (((size_t)2 << order) - 1)) == 0 &&
+               pfn + ((size_t)2 << order) <= end_pfn)
+        {
+            order++;
+        }
+
+        pmm_total_pages += (size_t)1 << order;
+        pmm_release_block(pfn, order);
+        pfn += (size_t)1 << order;
     }
+}
+
+static void pmm_exclude(size_t start, size_t end)
+{
+    if (end <= start || pmm_excluded_count >= PMM_MAX_EXCLUDED) return;
+    pmm_excluded[pmm_excluded_count].start = start & ~((size_t)PMM_PAGE_SIZE - 1);
+    pmm_excluded[pmm_excluded_count].end = (end + PMM_PAGE_SIZE - 1) & ~((size_t)PMM_PAGE_SIZE - 1);
+    pmm_excluded_count++;
+}
 
-    // Birlestirme uygula ki duzgun buyuk blok bulalim
-    pmm_maintain();
+static bool pmm_region_reclaimable(MemoryRegionType type)
+{
+    return type == MemoryRegionType_USABLE ||
+           type == MemoryRegionType_EFI_BS_CODE ||
+           type == MemoryRegionType_EFI_BS_DATA ||
+           type == MemoryRegionType_EFI_LOADER_CODE ||
+           type == MemoryRegionType_EFI_LOADER_DATA ||
+           type == MemoryRegionType_ACPI_RECLAIMABLE;
+}
 
-    size_t index = 0;
-    for (ListNode *node = memory_regions->head; node; node = node->next, ++index)
+static void pmm_buddy_init(void)
+{
+    // Multiboot2 bilgisi ve modül USABLE bellekte durabilir; üzerine free list yazılmasın
+    if (mb2_tagptr)
+        pmm_exclude(mb2_tagptr, mb2_tagptr + *(uint32_t*)(uintptr_t)mb2_tagptr);
+    if (mb2_module)
+        pmm_exclude(mb2_module->mod_start, mb2_module->mod_end);
+
+    // Sonradan geri kazanılabilecek bölgeler de metadata kapsamına girsin
+    uint64_t highest = 0;
+    for (ListNode* node = memory_regions->head; node; node = node->next)
     {
-        MemoryRegion *cur = (MemoryRegion *)node->data;
-        if (!cur || cur->type != MemoryRegionType_USABLE)
-            continue;
+        MemoryRegion* region = (MemoryRegion*)node->data;
+        if (!pmm_region_reclaimable(region->type)) continue;
+        uint64_t end = (uint64_t)region->base + region->size;
+        if (end > highest) highest = end;
+    }
+    if (highest > PMM_PHYS_LIMIT) highest = PMM_PHYS_LIMIT;
 
-        // Tahsis baslangic adresini 4KiB'e hizala
-        size_t aligned_base = (cur->base + PAGE - 1) & ~(PAGE - 1);
-        if (aligned_base < cur->base)
-            continue; // overflow korumasi
+    pmm_max_pfn = (size_t)(highest >> PMM_PAGE_SHIFT);
+    size_t info_bytes = (pmm_max_pfn + PMM_PAGE_SIZE - 1) & ~((size_t)PMM_PAGE_SIZE - 1);
 
-        size_t gap = aligned_base - cur->base; // on kisim (USABLE kalacak)
-        if (cur->size < gap + alloc_size)
-            continue; // bu bolge yeterli degil
+    // Metadata için ilk uygun USABLE aralığı kullan
+    size_t info_base = 0;
+    for (ListNode* node = memory_regions->head; node && !info_base; node = node->next)
+    {
+        MemoryRegion* region = (MemoryRegion*)node->data;
+        if (region->type != MemoryRegionType_USABLE) continue;
+        if ((uint64_t)region->base + region->size > PMM_PHYS_LIMIT) continue;
 
-        // Durum 1: gap == 0 ve tam uyan blok -> mevcut dugumu RESERVED yap
-        if (gap == 0 && cur->size == alloc_size)
+        size_t candidate = (region->base + PMM_PAGE_SIZE - 1) & ~((size_t)PMM_PAGE_SIZE - 1);
+        size_t region_end = region->base + region->size;
+        for (size_t i = 0; i < pmm_excluded_count; i++)
         {
-            void *ret = (void *)(uintptr_t)cur->base;
-            cur->type = MemoryRegionType_RESERVED;
-            return ret;
+            PmmRange* ex = &pmm_excluded[i];
+            if (ex->start < candidate + info_bytes && ex->end > candidate)
+                candidate = ex->end;
         }
+        if (candidate >= region->base && candidate + info_bytes <= region_end)
+            info_base = candidate;
+    }
 
-        size_t cur_end = cur->base + cur->size;
-        size_t alloc_end = aligned_base + alloc_size;
+    if (!info_base)
+    {
+        ERROR("pmm: no room for page metadata (%zu bytes)", info_bytes);
+        return;
+    }
 
-        // gap == 0 ise: mevcut dugumu ALLOCATED yap, sadece suffix icin tek malloc kullan
-        if (gap == 0)
-        {
-            void *ret = (void *)(uintptr_t)cur->base;
-            // Mevcut dugumu allocated'a cevir
-            cur->type = MemoryRegionType_RESERVED;
-            cur->size = alloc_size;
+    pmm_page_info = (uint8_t*)(uintptr_t)info_base;
+    memset(pmm_page_info, 0, info_bytes);
+    pmm_exclude(info_base, info_base + info_bytes);
 
-            // Suffix var mi?
-            if (alloc_end < cur_end)
-            {
-                MemoryRegion *suffix = (MemoryRegion *)malloc(sizeof(MemoryRegion));
-                if (!suffix)
-                {
-                    ERROR("pmm_alloc: suffix allocation failed for size %lu", (unsigned long)alloc_size);
-                    return NULL;
-                }
-                suffix->base = alloc_end;
-                suffix->size = cur_end - alloc_end;
-                suffix->type = MemoryRegionType_USABLE;
-
-                // allocated nodenin hemen arkasina suffix ekle
-                if (!List_InsertAt(memory_regions, index + 1, suffix))
-                {
-                    ERROR("pmm_alloc: List_InsertAt failed while inserting suffix");
-                    free(suffix);
-                    return NULL;
-                }
-            }
-            return ret;
-        }
+    for (ListNode* node = memory_regions->head; node; node = node->next)
+    {
+        MemoryRegion* region = (MemoryRegion*)node->data;
+        if (region->type != MemoryRegionType_USABLE) continue;
+        uint64_t end = (uint64_t)region->base + region->size;
+        if (end > PMM_PHYS_LIMIT - 1) end = PMM_PHYS_LIMIT - 1; // 4 GiB üstü yönetilmez; i386'da size_t taşmasın
+        pmm_seed_range(region->base, (size_t)end, 0);
+    }
 
-        // gap > 0 ise: cur prefix olarak kalir; ayrica alloc ve gerekirse suffix nodelari eklenir
-        MemoryRegion *alloc_region = (MemoryRegion *)malloc(sizeof(MemoryRegion));
-        if (!alloc_region)
-        {
-            ERROR("pmm_alloc: alloc_region allocation failed");
-            return NULL;
-        }
-        alloc_region->base = aligned_base;
-        alloc_region->size = alloc_size;
-        alloc_region->type = MemoryRegionType_RESERVED;
+    LOG("pmm: buddy allocator ready, %zu pages (%zu MB) free, metadata at 0x%zx",
+        pmm_free_page_count, pmm_free_page_count / 256, info_base);
+}
 
-        // cur'u prefixe daralt
-        cur->size = gap;
-        if (!List_InsertAt(memory_regions, index + 1, alloc_region))
-        {
-            ERROR("pmm_alloc: List_InsertAt failed while inserting alloc_region");
-            free(alloc_region);
-            return NULL;
-        }
+static void *pmm_take_block(uint32_t order)
+{
+    uint32_t current = order;
+    while (current <= PMM_MAX_ORDER && !pmm_free_lists[current])
+        current++;
 
-        // Suffix var mi?
-        if (alloc_end < cur_end)
-        {
-            MemoryRegion *suffix = (MemoryRegion *)malloc(sizeof(MemoryRegion));
-            if (!suffix)
-            {
-                ERROR("pmm_alloc: suffix allocation failed");
-                return NULL;
-            }
-            suffix->base = alloc_end;
-            suffix->size = cur_end - alloc_end;
-            suffix->type = MemoryRegionType_USABLE;
-            if (!List_InsertAt(memory_regions, index + 2, suffix))
-            {
-                ERROR("pmm_alloc: List_InsertAt failed while inserting suffix (gap>0)");
-                free(suffix);
-                return NULL;
-            }
-        }
+    if (current > PMM_MAX_ORDER)
+        return NULL;
 
-        return (void *)(uintptr_t)alloc_region->base;
+    size_t pfn = block_to_pfn(pmm_free_lists[current]);
+    pmm_list_remove(pfn, current);
+
+    // Büyük bloğu böl; üst yarılar bir alt order'ın listesine
+    while (current > order)
+    {
+        current--;
+        pmm_list_push(pfn + ((size_t)1 << current), current);
     }
 
-    ERROR("pmm_alloc: no suitable block found for sizeInKB=%08u", (uint32_t)sizeInKB);
-    return NULL; // uygun blok yok
+    pmm_page_info[pfn] = (uint8_t)(PMM_INFO_ALLOC | order);
+    pmm_free_page_count -= (size_t)1 << order;
+
+    return (void *)pfn_to_block(pfn);
 }
 
-void pmm_free(void *ptr)
+static bool pmm_put_block(void *ptr, uint32_t order)
 {
-    if (!ptr || !memory_regions)
-        return;
+    size_t pfn = block_to_pfn(ptr);
+    if (pfn >= pmm_max_pfn || pmm_page_info[pfn] != (uint8_t)(PMM_INFO_ALLOC | order))
+        return false;
 
-    size_t addr = (size_t)(uintptr_t)ptr;
+    pmm_page_info[pfn] = 0;
+    pmm_release_block(pfn, order);
+    return true;
+}
+
+void *pmm_alloc_pages(uint32_t order)
+{
+    if (!pmm_page_info || order > PMM_MAX_ORDER)
+        return NULL;
+
+    size_t flags = arch_irq_save();
+    void *ptr = pmm_take_block(order);
+    arch_irq_restore(flags);
+
+    return ptr;
+}
 
-    if (addr % 4096 != 0)
+// [pfn, pfn + pages) aralığını hizalı 2'nin kuvveti parçalara ayırır; pfn
+// 2^order'a hizalı olduğundan parçalar pages'in ikili basamaklarıdır (büyükten küçüğe).
+static uint32_t pmm_exact_piece(size_t pfn, size_t pages)
+{
+    uint32_t order = 0;
+    while (order < PMM_MAX_ORDER &&
+           (pfn & (((size_t)2 << order) - 1)) == 0 &&
+           ((size_t)2 << order) <= pages)
     {
-        // Align down to page size
-        LOG("pmm_free: address is not page-aligned: 0x%lX", (unsigned long)addr);
-        addr = addr & ~(4096 - 1);
-        LOG("pmm_free: aligned address: 0x%lX", (unsigned long)addr);
+        order++;
     }
+    return order;
+}
 
-    // Ilgili bolgeyi bul
-    ListNode *node = memory_regions->head;
-    MemoryRegion *freed = NULL;
-    while (node)
+void *pmm_alloc_pages_exact(size_t pages)
+{
+    if (!pmm_page_info || pages == 0)
+        return NULL;
+
+    uint32_t order = 0;
+    while (order <= PMM_MAX_ORDER && ((size_t)1 << order) < pages)
+        order++;
+    if (order > PMM_MAX_ORDER)
+        return NULL;
+
+    size_t flags = arch_irq_save();
+
+    void *block = pmm_take_block(order);
+    if (!block)
+    {
+        arch_irq_restore(flags);
+        return NULL;
+    }
+
+    // Kullanılan kısım parça parça tahsisli işaretlenir, artan kuyruk buddy'ye döner
+    size_t pfn = block_to_pfn(block);
+    size_t end = pfn + pages;
+    size_t cur = pfn;
+    while (cur < end)
+    {
+        uint32_t piece = pmm_exact_piece(cur, end - cur);
+        pmm_page_info[cur] = (uint8_t)(PMM_INFO_ALLOC | piece);
+        cur += (size_t)1 << piece;
+    }
+
+    size_t block_end = pfn + ((size_t)1 << order);
+    while (cur < block_end)
+    {
+        uint32_t piece = pmm_exact_piece(cur, block_end - cur);
+        pmm_release_block(cur, piece);
+        cur += (size_t)1 << piece;
+    }
+
+    arch_irq_restore(flags);
+    return block;
+}
+
+void pmm_free_pages_exact(void *ptr, size_t pages)
+{
+    if (!ptr || !pmm_page_info || pages == 0)
+        return;
+
+    size_t pfn = block_to_pfn(ptr);
+    size_t end = pfn + pages;
+
+    size_t flags = arch_irq_save();
+    while (pfn < end)
     {
-        MemoryRegion *r = (MemoryRegion *)node->data;
-        if (r && r->base == addr)
+        uint32_t piece = pmm_exact_piece(pfn, end - pfn);
+        if (!pmm_put_block(pfn_to_block(pfn), piece))
         {
-            freed = r;
-            break;
+            arch_irq_restore(flags);
+            WARN("pmm_free_pages_exact: 0x%zx is not part of an allocated %zu-page range",
+                 (size_t)(uintptr_t)pfn_to_block(pfn), pages);
+            return;
         }
-        node = node->next;
+        pfn += (size_t)1 << piece;
     }
+    arch_irq_restore(flags);
+}
+
+void pmm_free_pages(void *ptr, uint32_t order)
+{
+    if (!ptr || !pmm_page_info)
+        return;
+
+    size_t flags = arch_irq_save();
+    bool ok = pmm_put_block(ptr, order);
+    arch_irq_restore(flags);
+
+    if (!ok)
+        WARN("pmm_free_pages: 0x%zx is not an allocated order-%u block", (size_t)(uintptr_t)ptr, order);
+}
 
-    if (!freed)
+size_t pmm_alloc_pages_bulk(uint32_t order, void **out, size_t count)
+{
+    if (!pmm_page_info || order > PMM_MAX_ORDER || !out)
+        return 0;
+
+    size_t flags = arch_irq_save();
+    size_t got = 0;
+    while (got < count)
     {
-        LOG("pmm_free: adres bulunamadi: 0x%lX", (unsigned long)addr);
+        void *ptr = pmm_take_block(order);
+        if (!ptr) break;
+        out[got++] = ptr;
+    }
+    arch_irq_restore(flags);
+
+    return got;
+}
+
+void pmm_free_pages_bulk(uint32_t order, void *const *pages, size_t count)
+{
+    if (!pmm_page_info || !pages)
+        return;
+
+    size_t flags = arch_irq_save();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!pmm_put_block(pages[i], order))
+            WARN("pmm_free_pages_bulk: 0x%zx is not an allocated order-%u block", (size_t)(uintptr_t)pages[i], order);
+    }
+    arch_irq_restore(flags);
+}
+
+void *pmm_alloc(size_t sizeInKB)
+{
+    if (!pmm_page_info || sizeInKB == 0)
+    {
+        LOG("pmm_alloc: invalid parameters (ready=%d, sizeInKB=%zu)", pmm_page_info != NULL, sizeInKB);
+        return NULL;
+    }
+
+    size_t pages = (sizeInKB + (PMM_PAGE_SIZE / 1024) - 1) / (PMM_PAGE_SIZE / 1024);
+
+    uint32_t order = 0;
+    while (order <= PMM_MAX_ORDER && ((size_t)1 << order) < pages)
+        order++;
+
+    void *ptr = pmm_pcp_alloc(order);
+    if (!ptr)
+    {
+        // Per-CPU önbelleklerde bekleyen bloklar birleşmeyi engelliyor olabilir
+        pmm_pcp_drain_all();
+        ptr = pmm_alloc_pages(order);
+    }
+    if (!ptr)
+        ERROR("pmm_alloc: no suitable block found for sizeInKB=%08u", (uint32_t)sizeInKB);
+
+    return ptr;
+}
+
+void pmm_free(void *ptr)
+{
+    if (!ptr || !pmm_page_info)
         return;
+
+    size_t addr = (size_t)(uintptr_t)ptr;
+
+    if (addr % PMM_PAGE_SIZE != 0)
+    {
+        // Align down to page size
+        LOG("pmm_free: address is not page-aligned: 0x%lX", (unsigned long)addr);
+        addr = addr & ~(PMM_PAGE_SIZE - 1);
     }
 
-    if (freed->type == MemoryRegionType_USABLE)
+    size_t pfn = addr >> PMM_PAGE_SHIFT;
+    if (pfn >= pmm_max_pfn || !(pmm_page_info[pfn] & PMM_INFO_ALLOC))
     {
-        LOG("pmm_free: cift free veya zaten USABLE: 0x%lX", (unsigned long)addr);
+        LOG("pmm_free: adres bulunamadi: 0x%lX", (unsigned long)addr);
         return;
     }
 
-    // Serbest birak ve USABLE yap
-    freed->type = MemoryRegionType_USABLE;
+    pmm_pcp_free((void *)(uintptr_t)addr, pmm_page_info[pfn] & PMM_INFO_ORDER_MASK);
+}
 
-    // Hedefe komsu/dahil USABLE bloklarla birlestir (liste sirali olmasa bile tum listeyi tara)
-    bool merged;
-    do
-    {
-        merged = false;
-        size_t freed_end = freed->base + freed->size;
+void pmm_add_free_range(size_t base, size_t size)
+{
+    if (!pmm_page_info || size == 0)
+        return;
 
-        for (ListNode *n = memory_regions->head; n; n = n->next)
-        {
-            MemoryRegion *mr = (MemoryRegion *)n->data;
-            if (!mr || mr == freed || mr->type != MemoryRegionType_USABLE)
-                continue;
+    size_t flags = arch_irq_save();
+    pmm_seed_range(base, base + size, 0);
+    arch_irq_restore(flags);
+}
 
-            size_t mr_end = mr->base + mr->size;
+size_t pmm_reclaim_regions(MemoryRegionType type)
+{
+    if (!memory_regions || !pmm_page_info)
+        return 0;
 
-            // Bitişik ya da örtüşen durum
-            if (!(mr->base > freed_end || mr_end < freed->base))
-            {
-                // kapsayici aralik
-                size_t new_base = (freed->base < mr->base) ? freed->base : mr->base;
-                size_t new_end = (freed_end > mr_end) ? freed_end : mr_end;
-                freed->base = new_base;
-                freed->size = new_end - new_base;
-
-                // mr dugumunu listeden cikar ve verisini serbest birak
-                MemoryRegion *to_free = mr;
-                List_Remove(memory_regions, to_free);
-                free(to_free);
-
-                // birlesme oldu; tekrar tara
-                merged = true;
-                break;
-            }
+    size_t before = pmm_total_pages;
+    for (ListNode *node = memory_regions->head; node; node = node->next)
+    {
+        MemoryRegion *region = (MemoryRegion *)node->data;
+        if (region->type != type) continue;
+        region->type = MemoryRegionType_USABLE;
 
-            // Sol bitisik: mr_end == freed->base
-            if (mr_end == freed->base)
-            {
-                freed->base = mr->base;
-                freed->size += mr->size;
-                MemoryRegion *to_free = mr;
-                List_Remove(memory_regions, to_free);
-                free(to_free);
-                merged = true;
-                break;
-            }
+        uint64_t end = (uint64_t)region->base + region->size;
+        if (end > PMM_PHYS_LIMIT - 1) end = PMM_PHYS_LIMIT - 1; // 4 GiB üstü yönetilmez
+        if (end <= region->base) continue;
+        pmm_add_free_range(region->base, (size_t)end - region->base);
+    }
 
-            // Sag bitisik: freed_end == mr->base
-            if (freed_end == mr->base)
-            {
-                freed->size += mr->size;
-                MemoryRegion *to_free = mr;
-                List_Remove(memory_regions, to_free);
-                free(to_free);
-                merged = true;
-                break;
-            }
-        }
+    size_t reclaimed = pmm_total_pages - before;
+    if (reclaimed)
+    {
+        pmm_maintain();
+        LOG("pmm: reclaimed %zu KiB of %s memory", reclaimed * (PMM_PAGE_SIZE / 1024), mrTypeToString(type));
+    }
+    return reclaimed * PMM_PAGE_SIZE;
+}
+
+void pmm_get_stats(PmmStats *stats)
+{
+    if (!stats)
+        return;
 
-    } while (merged);
+    stats->total_pages = pmm_total_pages;
+    stats->free_pages = pmm_free_page_count;
+    stats->cached_pages = pmm_pcp_cached_pages();
+    for (uint32_t order = 0; order <= PMM_MAX_ORDER; order++)
+        stats->free_blocks[order] = pmm_free_counts[order];
 }
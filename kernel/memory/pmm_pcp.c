@@ -0,0 +1,120 @@
+#include <memory/pmm.h>
+#include <memory/memory.h>
+#include <arch.h>
+#include <debug/debug.h>
+
+// Per-CPU sayfa önbelleği. Her CPU'nun her küçük order için bir magazine'i
+// vardır; boşaldığında buddy'den PMM_PCP_BATCH blok tek kilitle doldurulur,
+// dolduğunda en eski PMM_PCP_BATCH blok tek kilitle geri verilir. Önbellekteki
+// bloklar buddy açısından tahsisli sayılır, bu yüzden birleştirilmezler.
+
+#define PMM_PCP_MAX_CPUS 16
+#define PMM_PCP_CAPACITY 32
+#define PMM_PCP_BATCH    16
+
+typedef struct PmmMagazine
+{
+    uint32_t count;
+    void* rounds[PMM_PCP_CAPACITY];
+} PmmMagazine;
+
+typedef struct PmmPcp
+{
+    PmmMagazine mags[PMM_PCP_MAX_ORDER + 1];
+} PmmPcp;
+
+static PmmPcp pmm_pcp[PMM_PCP_MAX_CPUS];
+
+static PmmPcp* pmm_pcp_local(void)
+{
+    uint32_t cpu = arch_cpu_index();
+    return cpu < PMM_PCP_MAX_CPUS ? &pmm_pcp[cpu] : NULL;
+}
+
+static void pmm_pcp_drain_batch(PmmMagazine* mag, uint32_t order, uint32_t count)
+{
+    if (count > mag->count) count = mag->count;
+
+    pmm_free_pages_bulk(order, mag->rounds, count);
+
+    mag->count -= count;
+    memmove(mag->rounds, mag->rounds + count, mag->count * sizeof(void*));
+}
+
+void* pmm_pcp_alloc(uint32_t order)
+{
+    if (order > PMM_PCP_MAX_ORDER)
+        return pmm_alloc_pages(order);
+
+    size_t flags = arch_irq_save();
+
+    PmmPcp* pcp = pmm_pcp_local();
+    if (!pcp)
+    {
+        arch_irq_restore(flags);
+        return pmm_alloc_pages(order);
+    }
+
+    PmmMagazine* mag = &pcp->mags[order];
+    if (mag->count == 0)
+        mag->count = (uint32_t)pmm_alloc_pages_bulk(order, mag->rounds, PMM_PCP_BATCH);
+
+    void* ptr = mag->count ? mag->rounds[--mag->count] : NULL;
+
+    arch_irq_restore(flags);
+    return ptr;
+}
+
+void pmm_pcp_free(void* ptr, uint32_t order)
+{
+    if (!ptr) return;
+
+    if (order > PMM_PCP_MAX_ORDER)
+    {
+        pmm_free_pages(ptr, order);
+        return;
+    }
+
+    size_t flags = arch_irq_save();
+
+    PmmPcp* pcp = pmm_pcp_local();
+    if (!pcp)
+    {
+        arch_irq_restore(flags);
+        pmm_free_pages(ptr, order);
+        return;
+    }
+
+    PmmMagazine* mag = &pcp->mags[order];
+    if (mag->count == PMM_PCP_CAPACITY)
+        pmm_pcp_drain_batch(mag, order, PMM_PCP_BATCH);
+
+    mag->rounds[mag->count++] = ptr;
+
+    arch_irq_restore(flags);
+}
+
+void pmm_pcp_drain(uint32_t cpu)
+{
+    if (cpu >= PMM_PCP_MAX_CPUS) return;
+
+    size_t flags = arch_irq_save();
+    for (uint32_t order = 0; order <= PMM_PCP_MAX_ORDER; order++)
+        pmm_pcp_drain_batch(&pmm_pcp[cpu].mags[order], order, PMM_PCP_CAPACITY);
+    arch_irq_restore(flags);
+}
+
+void pmm_pcp_drain_all(void)
+{
+    for (uint32_t cpu = 0; cpu < PMM_PCP_MAX_CPUS; cpu++)
+        pmm_pcp_drain(cpu);
+}
+
+size_t pmm_pcp_cached_pages(void)
+{
+    size_t pages = 0;
+    for (uint32_t cpu = 0; cpu < PMM_PCP_MAX_CPUS; cpu++)
+        for (uint32_t order = 0; order <= PMM_PCP_MAX_ORDER; order++)
+            pages += (size_t)pmm_pcp[cpu].mags[order].count << order;
+    return pages;
+}
@@ -0,0 +1,259 @@
+#include <memory/slab.h>
+#include <memory/memory.h>
+#include <memory/pmm.h>
+#include <debug/debug.h>
+
+// Slab sayfaları SLAB_PAGE_SIZE'a hizalıdır; bir nesne işaretçisinden sayfa
+// başlığına maskeleme ile ulaşılır, böylece alloc/free O(1) olur.
+#define SLAB_PAGE_SIZE    0x4000u   // 16 KiB
+#define SLAB_PAGE_ORDER   2         // SLAB_PAGE_SIZE / PMM_PAGE_SIZE = 2^2
+#define SLAB_HEADER_SIZE  64u
+#define SLAB_CHUNK_PAGES  4u        // first-fit'ten tek seferde alınan sayfa sayısı
+
+#define SLAB_MAGIC        0x51ABCAFEu
+#define SLAB_POOL_MAGIC   0x51AB0F0Fu // Havuzda bekleyen, sınıfa atanmamış sayfa
+
+typedef struct SlabObject
+{
+    struct SlabObject* next;
+} SlabObject;
+
+struct SlabClass;
+
+typedef struct SlabPage
+{
+    uint32_t magic;
+    uint16_t in_use;
+    uint16_t capacity;
+    struct SlabPage* self;      // Rastgele veriyle eşleşmeyi önlemek için
+    struct SlabClass* cls;
+    SlabObject* free_list;
+    struct SlabPage* prev;      // Sınıfın kısmi sayfa listesi (çift yönlü)
+    struct SlabPage* next;
+    uint8_t* objects;
+} SlabPage;
+
+typedef struct SlabClass
+{
+    size_t size;
+    SlabPage* partial;          // En az bir boş nesnesi olan sayfalar
+} SlabClass;
+
+static const uint16_t slab_class_sizes[] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+#define SLAB_CLASS_COUNT (sizeof(slab_class_sizes) / sizeof(slab_class_sizes[0]))
+
+static SlabClass slab_classes[SLAB_CLASS_COUNT];
+static uint8_t slab_class_index[SLAB_MAX_SIZE / 16 + 1]; // (size + 15) / 16 -> sınıf
+static SlabPage* slab_page_pool = NULL;
+static bool slab_ready = false;
+static bool slab_enabled = true;
+static size_t slab_live_bytes = 0;
+
+extern void* heap_firstfit_alloc(size_t size); // From heap.c
+
+static void slab_init(void)
+{
+    size_t cls = 0;
+    for (size_t i = 0; i < sizeof(slab_class_index); i++)
+    {
+        size_t size = i * 16;
+        while (slab_class_sizes[cls] < size) cls++;
+        slab_class_index[i] = (uint8_t)cls;
+    }
+
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++)
+    {
+        slab_classes[i].size = slab_class_sizes[i];
+        slab_classes[i].partial = NULL;
+    }
+
+    slab_ready = true;
+}
+
+static void slab_pool_push(SlabPage* page)
+{
+    page->magic = SLAB_POOL_MAGIC;
+    page->self = page;
+    page->cls = NULL;
+    page->next = slab_page_pool;
+    slab_page_pool = page;
+}
+
+static bool slab_grow_pool(void)
+{
+    // PMM hazırsa hizalı blok doğrudan per-CPU sayfa önbelleğinden gelir
+    SlabPage* pmm_page = (SlabPage*)pmm_pcp_alloc(SLAB_PAGE_ORDER);
+    if (pmm_page)
+    {
+        slab_pool_push(pmm_page);
+        return true;
+    }
+
+    // Hizalama payı için bir sayfa fazlası istenir; bu bloklar first-fit'e geri verilmez.
+    size_t raw = (size_t)(uintptr_t)heap_firstfit_alloc(SLAB_CHUNK_PAGES * SLAB_PAGE_SIZE + SLAB_PAGE_SIZE - 1);
+    if (!raw) return false;
+
+    size_t base = (raw + SLAB_PAGE_SIZE - 1) & ~((size_t)SLAB_PAGE_SIZE - 1);
+    for (size_t i = 0; i < SLAB_CHUNK_PAGES; i++)
+    {
+        slab_pool_push((SlabPage*)(base + i * SLAB_PAGE_SIZE));
+    }
+
+    return true;
+}
+
+static void slab_partial_push(SlabClass* cls, SlabPage* page)
+{
+    page->prev = NULL;
+    page->next = cls->partial;
+    if (cls->partial) cls->partial->prev = page;
+    cls->partial = page;
+}
+
+static void slab_partial_remove(SlabClass* cls, SlabPage* page)
+{
+    if (page->prev) page->prev->next = page->next;
+    else cls->partial = page->next;
+    if (page->next) page->next->prev = page->prev;
+    page->prev = page->next = NULL;
+}
+
+static SlabPage* slab_page_format(SlabClass* cls)
+{
+    if (!slab_page_pool && !slab_grow_pool())
+        return NULL;
+
+    SlabPage* page = slab_page_pool;
+    slab_page_pool = page->next;
+
+    page->magic = SLAB_MAGIC;
+    page->self = page;
+    page->cls = cls;
+    page->in_use = 0;
+    page->objects = (uint8_t*)page + SLAB_HEADER_SIZE;
+    page->capacity = (uint16_t)((SLAB_PAGE_SIZE - SLAB_HEADER_SIZE) / cls->size);
+
+    // Boş listeyi adres sırasıyla kur
+    SlabObject* head = NULL;
+    for (size_t i = page->capacity; i > 0; i--)
+    {
+        SlabObject* obj = (SlabObject*)(page->objects + (i - 1) * cls->size);
+        obj->next = head;
+        head = obj;
+    }
+    page->free_list = head;
+
+    slab_partial_push(cls, page);
+    return page;
+}
+
+static SlabPage* slab_page_of(const void* ptr)
+{
+    if (!slab_ready || !ptr) return NULL;
+
+    SlabPage* page = (SlabPage*)((uintptr_t)ptr & ~((uintptr_t)SLAB_PAGE_SIZE - 1));
+    if (page->self != page) return NULL;
+    if (page->magic == SLAB_POOL_MAGIC) return page;
+    if (page->magic != SLAB_MAGIC) return NULL;
+
+    const uint8_t* p = (const uint8_t*)ptr;
+    if (p < page->objects || p >= page->objects + (size_t)page->capacity * page->cls->size)
+        return NULL;
+
+    return page;
+}
+
+void* slab_alloc(size_t size)
+{
+    if (size == 0 || size > SLAB_MAX_SIZE || !slab_enabled) return NULL;
+
+    if (!slab_ready) slab_init();
+
+    SlabClass* cls = &slab_classes[slab_class_index[(size + 15) >> 4]];
+    SlabPage* page = cls->partial;
+    if (!page)
+    {
+        page = slab_page_format(cls);
+        if (!page) return NULL;
+    }
+
+    SlabObject* obj = page->free_list;
+    page->free_list = obj->next;
+    page->in_use++;
+    slab_live_bytes += cls->size;
+
+    if (!page->free_list)
+        slab_partial_remove(cls, page);
+
+    return obj;
+}
+
+bool slab_free(void* ptr)
+{
+    SlabPage* page = slab_page_of(ptr);
+    if (!page) return false;
+
+    if (page->magic == SLAB_POOL_MAGIC)
+    {
+        WARN("slab_free: pointer %p belongs to an unused slab page", ptr);
+        return true;
+    }
+
+    SlabClass* cls = page->cls;
+
+    // Hizalanmış bloklar heap'ten oyulur; slab yalnızca nesne başlarını dağıtır
+    size_t offset = (size_t)((uint8_t*)ptr - page->objects);
+    if (offset % cls->size != 0)
+    {
+        WARN("slab_free: %p is not the start of a slab object", ptr);
+        return true;
+    }
+    SlabObject* obj = (SlabObject*)ptr;
+
+    bool was_full = (page->free_list == NULL);
+
+    obj->next = page->free_list;
+    page->free_list = obj;
+    page->in_use--;
+    slab_live_bytes -= cls->size;
+
+    if (was_full)
+        slab_partial_push(cls, page);
+
+    // Sınıfta başka kısmi sayfa varsa boşalan sayfayı ortak havuza geri ver
+    if (page->in_use == 0 && (cls->partial != page || page->next))
+    {
+        slab_partial_remove(cls, page);
+        slab_pool_push(page);
+    }
+
+    return true;
+}
+
+size_t slab_object_size(const void* ptr)
+{
+    SlabPage* page = slab_page_of(ptr);
+    if (!page || page->magic != SLAB_MAGIC) return 0;
+
+    size_t size = page->cls->size;
+    if ((size_t)((const uint8_t*)ptr - page->objects) % size != 0) return 0;
+    return size;
+}
+
+size_t slab_bytes_in_use(void)
+{
+    return slab_live_bytes;
+}
+
+void slab_set_enabled(bool enabled)
+{
+    slab_enabled = enabled;
+}
+
+bool slab_is_enabled(void)
+{
+    return slab_enabled;
+}
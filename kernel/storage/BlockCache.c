@@ -0,0 +1,902 @@
+#include <storage/BlockCache.h>
+#include <storage/BlockQueue.h>
+#include <memory/memory.h>
+#include <memory/objpool.h>
+#include <debug/debug.h>
+#include <task/PeriodicTask.h>
+#include <arch.h>
+
+#define BLOCK_CACHE_HASH_BUCKETS 1024u // 2'nin kuvveti
+
+// Geri yazma istekleri önceden ayrılır: zamanlayıcı kesmesindeki flusher malloc çağıramaz
+#define BLOCK_CACHE_WRITEBACK_SLOTS      8
+#define BLOCK_CACHE_WRITEBACK_MAX_BLOCKS 128 // bir istekte birleştirilen en fazla blok
+
+#define BLOCK_CACHE_VALID   0
+#define BLOCK_CACHE_READING 1 // ön okuma sürüyor; çıkarılmaz, okuyan bekler
+#define BLOCK_CACHE_FAILED  2 // ön okuma başarısız; blockcache_reap siler
+
+struct BlockCachePrefetch;
+
+typedef struct BlockCacheEntry
+{
+    BlockDevice* device;
+    uint64_t lba;
+    uint8_t* data;
+    uint32_t size;
+    bool referenced;                   // CLOCK biti; her isabette kurulur
+    bool dirty;                        // aygıttakinden yeni; çıkarılmaz
+    bool writing;                      // geri yazma isteğinde; tampon donanıma açık
+    bool redirty;                      // yazılırken yeniden değişti; istek bitince kirli kalır
+    volatile uint8_t state;            // BLOCK_CACHE_*; tamamlanma kesme bağlamında yazar
+    struct BlockCachePrefetch* io;     // READING iken bağlı olduğu istek
+    struct BlockCacheEntry* hash_next;
+    struct BlockCacheEntry* ring_prev; // CLOCK halkası
+    struct BlockCacheEntry* ring_next;
+    struct BlockCacheEntry* dirty_prev; // kirli liste; en eski başta
+    struct BlockCacheEntry* dirty_next;
+} BlockCacheEntry;
+
+// Bir ön okuma isteği: ardışık eksik bloklar, her biri kendi girdisinin tamponuna
+typedef struct BlockCachePrefetch
+{
+    BlockRequest req;
+    BlockDevice* device;
+    struct BlockCachePrefetch* done_next;     // tamamlananlar (kesme bağlamından eklenir)
+    struct BlockCachePrefetch* inflight_next; // sürenler (görev bağlamı)
+    uint32_t count;
+    BlockCacheEntry** entries;
+    BlockSegment* segments;
+} BlockCachePrefetch;
+
+// Bitişik kirli blokları tek yazmada toplayan geri yazma isteği
+typedef struct BlockCacheWriteBack
+{
+    BlockRequest req;
+    bool busy; // gönderildi; blockcache_writeback_reap bırakır
+    uint32_t count;
+    BlockCacheEntry* entries[BLOCK_CACHE_WRITEBACK_MAX_BLOCKS];
+    BlockSegment segments[BLOCK_CACHE_WRITEBACK_MAX_BLOCKS];
+} BlockCacheWriteBack;
+
+static ObjectPool s_entry_pool = OBJECT_POOL_STATIC(BlockCacheEntry, 64, true);
+static BlockCacheEntry* s_buckets[BLOCK_CACHE_HASH_BUCKETS];
+static BlockCacheEntry* s_hand = NULL; // CLOCK ibresi; halkadaki sıradaki çıkarma adayı
+static size_t s_budget = BLOCK_CACHE_DEFAULT_BUDGET;
+static BlockCacheStats s_stats;
+static BlockCachePrefetch* s_inflight = NULL;
+static BlockCachePrefetch* volatile s_done = NULL;
+
+static BlockCacheEntry* s_dirty_head = NULL;
+static BlockCacheEntry* s_dirty_tail = NULL;
+static BlockCacheWriteBack s_writeback[BLOCK_CACHE_WRITEBACK_SLOTS];
+static size_t s_dirty_limit = BLOCK_CACHE_DEFAULT_DIRTY_LIMIT; // 0: write-through
+static uint32_t s_flush_interval = BLOCK_CACHE_DEFAULT_FLUSH_MS;
+static PeriodicTask* s_flusher = NULL;
+static bool s_flusher_tried = false;
+static bool s_write_failed = false;    // son BlockCache_Sync'ten beri kaybolan geri yazma
+static volatile uint32_t s_busy = 0;   // görev bağlamı önbellek içinde; flusher dokunmaz
+static volatile bool s_flush_due = false; // flusher atladı; sıradaki çağrı geri yazar
+
+// Zamanlayıcı kesmesindeki flusher yalnızca s_busy sıfırken çalışır; tek işlemcide
+// bu, önbellek yapılarının yarım kalmış bir değişikliğini görmemesi için yeterlidir.
+static void blockcache_enter(void);
+static void blockcache_leave(void);
+
+static inline size_t blockcache_cost(uint32_t size)
+{
+    return sizeof(BlockCacheEntry) + size;
+}
+
+static inline uint32_t blockcache_hash(const BlockDevice* dev, uint64_t lba)
+{
+    uint64_t key = (lba ^ ((uint64_t)(uintptr_t)dev << 20)) * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(key >> 32) & (BLOCK_CACHE_HASH_BUCKETS - 1);
+}
+
+static BlockCacheEntry* blockcache_lookup(const BlockDevice* dev, uint64_t lba)
+{
+    for (BlockCacheEntry* e = s_buckets[blockcache_hash(dev, lba)]; e; e = e->hash_next)
+    {
+        if (e->device == dev && e->lba == lba) return e;
+    }
+    return NULL;
+}
+
+static void blockcache_dirty_unlink(BlockCacheEntry* e)
+{
+    if (e->dirty_prev) e->dirty_prev->dirty_next = e->dirty_next;
+    else s_dirty_head = e->dirty_next;
+    if (e->dirty_next) e->dirty_next->dirty_prev = e->dirty_prev;
+    else s_dirty_tail = e->dirty_prev;
+    e->dirty_prev = e->dirty_next = NULL;
+    e->dirty = false;
+    s_stats.dirty -= e->size;
+}
+
+static void blockcache_start_flusher(void);
+
+static void blockcache_mark_dirty(BlockCacheEntry* e)
+{
+    if (e->writing) e->redirty = true;
+    if (e->dirty) return;
+    e->dirty = true;
+    e->dirty_next = NULL;
+    e->dirty_prev = s_dirty_tail;
+    if (s_dirty_tail) s_dirty_tail->dirty_next = e;
+    else s_dirty_head = e;
+    s_dirty_tail = e;
+    s_stats.dirty += e->size;
+    if (!s_flusher_tried) blockcache_start_flusher();
+}
+
+static void blockcache_destroy(BlockCacheEntry* e)
+{
+    if (e->dirty) blockcache_dirty_unlink(e);
+
+    BlockCacheEntry** link = &s_buckets[blockcache_hash(e->device, e->lba)];
+    while (*link != e) link = &(*link)->hash_next;
+    *link = e->hash_next;
+
+    if (e->ring_next == e)
+    {
+        s_hand = NULL;
+    }
+    else
+    {
+        e->ring_prev->ring_next = e->ring_next;
+        e->ring_next->ring_prev = e->ring_prev;
+        if (s_hand == e) s_hand = e->ring_next;
+    }
+
+    s_stats.entries--;
+    s_stats.bytes -= blockcache_cost(e->size);
+    free(e->data);
+    object_pool_free(&s_entry_pool, e);
+}
+
+// CLOCK: referenced biti kurulu girdiler biti silinerek bir tur daha yaşar.
+// Ön okuması toplanmamış ve kirli girdiler atlanır; iki turda aday çıkmazsa false.
+static bool blockcache_evict_one(void)
+{
+    size_t steps = 2 * s_stats.entries + 1;
+    while (s_hand && steps--)
+    {
+        BlockCacheEntry* e = s_hand;
+        s_hand = e->ring_next;
+        if (e->io || e->dirty || e->writing) continue; // io: ön okuması henüz toplanmadı
+        if (e->referenced)
+        {
+            e->referenced = false;
+            continue;
+        }
+        blockcache_destroy(e);
+        s_stats.evictions++;
+        return true;
+    }
+    return false;
+}
+
+// Ön okuma tamamlanması; sürücünün bağlamında (kesme olabilir) çalışır, yalnızca
+// durumları yazar ve isteği blockcache_reap'e bırakır.
+static void blockcache_prefetch_done(BlockRequest* req)
+{
+    BlockCachePrefetch* io = (BlockCachePrefetch*)req->callback_arg;
+    uint8_t state = req->status == BLKREQ_STATUS_OK ? BLOCK_CACHE_VALID : BLOCK_CACHE_FAILED;
+    for (uint32_t i = 0; i < io->count; i++)
+        io->entries[i]->state = state;
+
+    size_t flags = arch_irq_save();
+    io->done_next = s_done;
+    s_done = io;
+    arch_irq_restore(flags);
+}
+
+// Tamamlanmış ön okumaları bırakır; başarısız blokları önbellekten siler
+static void blockcache_reap(void)
+{
+    if (!s_done) return;
+    size_t flags = arch_irq_save();
+    BlockCachePrefetch* list = s_done;
+    s_done = NULL;
+    arch_irq_restore(flags);
+
+    while (list)
+    {
+        BlockCachePrefetch* io = list;
+        list = io->done_next;
+
+        BlockCachePrefetch** link = &s_inflight;
+        while (*link && *link != io) link = &(*link)->inflight_next;
+        if (*link) *link = io->inflight_next;
+
+        for (uint32_t i = 0; i < io->count; i++)
+        {
+            BlockCacheEntry* e = io->entries[i];
+            e->io = NULL;
+            if (e->state == BLOCK_CACHE_FAILED) blockcache_destroy(e);
+        }
+        free(io);
+    }
+}
+
+// Okuması süren girdiyi bekler. Okuma başarısızsa girdi silinmiş olur, NULL döner.
+static BlockCacheEntry* blockcache_lookup_ready(BlockDevice* dev, uint64_t lba)
+{
+    BlockCacheEntry* e = blockcache_lookup(dev, lba);
+    if (!e || e->state != BLOCK_CACHE_READING) return e;
+    (void)BlockDevice_Wait(dev, &e->io->req);
+    blockcache_reap();
+    return blockcache_lookup(dev, lba);
+}
+
+// dev'in süren tüm ön okumalarını bekler (NULL: tüm aygıtlar)
+static void blockcache_drain(BlockDevice* dev)
+{
+    for (;;)
+    {
+        BlockCachePrefetch* io = s_inflight;
+        while (io && dev && io->device != dev) io = io->inflight_next;
+        if (!io) return;
+        (void)BlockDevice_Wait(io->device, &io->req);
+        blockcache_reap();
+    }
+}
+
+// Biten geri yazma isteklerini bırakır. Başarısız bloklar da temiz sayılır (yeniden
+// denemek aynı hatayı tekrarlar); hata sıradaki BlockCache_Sync'e bildirilir.
+// free çağırmaz, flusher kesme bağlamından da kullanır.
+static void blockcache_writeback_reap(void)
+{
+    for (uint32_t s = 0; s < BLOCK_CACHE_WRITEBACK_SLOTS; s++)
+    {
+        BlockCacheWriteBack* wb = &s_writeback[s];
+        if (!wb->busy || wb->req.status == BLKREQ_STATUS_PENDING) continue;
+
+        bool ok = wb->req.status == BLKREQ_STATUS_OK;
+        if (!ok)
+        {
+            WARN("BlockCache: write-back of %u blocks at LBA %llu on '%s' failed",
+                 wb->count, (unsigned long long)wb->req.lba, wb->req.device->name);
+            s_stats.write_errors += wb->count;
+            s_write_failed = true;
+        }
+        for (uint32_t i = 0; i < wb->count; i++)
+        {
+            BlockCacheEntry* e = wb->entries[i];
+            e->writing = false;
+            if (!e->redirty && e->dirty) blockcache_dirty_unlink(e);
+            e->redirty = false;
+        }
+        wb->busy = false;
+    }
+}
+
+// Süren geri yazmaları ilerletir (görev bağlamı). Kesmeyle tamamlanan aygıtlar da
+// yoklanır: sürücü kesmede yapamadığı işi (ör. ATA'nın PIO'ya dönüşü) buraya bırakır.
+static void blockcache_writeback_poll(void)
+{
+    for (uint32_t s = 0; s < BLOCK_CACHE_WRITEBACK_SLOTS; s++)
+    {
+        BlockCacheWriteBack* wb = &s_writeback[s];
+        if (wb->busy && wb->req.status == BLKREQ_STATUS_PENDING)
+            BlockDevice_Poll(wb->req.device);
+    }
+    blockcache_writeback_reap();
+}
+
+// dev'in süren geri yazmalarını bekler (NULL: tüm aygıtlar)
+static void blockcache_writeback_wait(BlockDevice* dev)
+{
+    for (uint32_t s = 0; s < BLOCK_CACHE_WRITEBACK_SLOTS; s++)
+    {
+        BlockCacheWriteBack* wb = &s_writeback[s];
+        if (wb->busy && (!dev || wb->req.device == dev))
+            (void)BlockDevice_Wait(wb->req.device, &wb->req);
+    }
+    blockcache_writeback_reap();
+}
+
+static bool blockcache_writeback_pending(BlockDevice* dev)
+{
+    for (uint32_t s = 0; s < BLOCK_CACHE_WRITEBACK_SLOTS; s++)
+    {
+        if (s_writeback[s].busy && (!dev || s_writeback[s].req.device == dev)) return true;
+    }
+    return false;
+}
+
+static inline bool blockcache_writeback_ready(const BlockCacheEntry* e)
+{
+    return e && e->dirty && !e->writing && e->state == BLOCK_CACHE_VALID;
+}
+
+// Boş bir geri yazma yuvası; wait ise biri bitene kadar bekler
+static BlockCacheWriteBack* blockcache_writeback_slot(bool wait)
+{
+    for (;;)
+    {
+        for (uint32_t s = 0; s < BLOCK_CACHE_WRITEBACK_SLOTS; s++)
+        {
+            if (!s_writeback[s].busy) return &s_writeback[s];
+        }
+        if (!wait) return NULL;
+        (void)BlockDevice_Wait(s_writeback[0].req.device, &s_writeback[0].req);
+        blockcache_writeback_reap();
+    }
+}
+
+// e'yi içeren bitişik kirli blokları tek istekte yazmaya başlar
+static void blockcache_writeback_run(BlockCacheWriteBack* wb, BlockCacheEntry* e)
+{
+    BlockDevice* dev = e->device;
+    while (e->lba > 0)
+    {
+        BlockCacheEntry* prev = blockcache_lookup(dev, e->lba - 1);
+        if (!blockcache_writeback_ready(prev)) break;
+        e = prev;
+    }
+
+    uint32_t n = 0;
+    while (n < BLOCK_CACHE_WRITEBACK_MAX_BLOCKS && blockcache_writeback_ready(e))
+    {
+        e->writing = true;
+        e->redirty = false;
+        wb->entries[n] = e;
+        wb->segments[n].buffer = e->data;
+        wb->segments[n].length = e->size;
+        n++;
+        e = blockcache_lookup(dev, e->lba + 1);
+    }
+
+    wb->busy = true;
+    wb->count = n;
+    BlockRequest_Init(&wb->req, dev, BLKREQ_WRITE, wb->entries[0]->lba, n, NULL);
+    wb->req.segments = wb->segments;
+    wb->req.segment_count = n;
+    s_stats.written_back += n;
+    s_stats.writeback_requests++;
+
+    if (!BlockDevice_Submit(dev, &wb->req))
+    {
+        wb->req.device = dev;
+        wb->req.status = BLKREQ_STATUS_ERROR;
+    }
+}
+
+// dev'in (NULL: tümü) kirli bloklarını yazmaya başlar. task false ise kesme
+// bağlamındayız: async_submit olmayan (isteği eşzamanlı çalıştıran) aygıtlar
+// atlanır ve yuva kalmayınca durulur. wait ise yuva beklenir; bitmeleri beklenmez.
+static void blockcache_writeback(BlockDevice* dev, bool task, bool wait)
+{
+    BlockQueue_Plug(); // istekler sıralanıp birlikte verilsin
+    BlockCacheEntry* e = s_dirty_head;
+    while (e)
+    {
+        BlockCacheEntry* next = e->dirty_next;
+        if (blockcache_writeback_ready(e) && (!dev || e->device == dev))
+        {
+            if (!task && !e->device->async_submit)
+            {
+                s_flush_due = true;
+            }
+            else
+            {
+                BlockCacheWriteBack* wb = blockcache_writeback_slot(wait);
+                if (!wb)
+                {
+                    s_flush_due = !task;
+                    break;
+                }
+                blockcache_writeback_run(wb, e);
+                next = e->dirty_next; // yuva beklenirken reap listeyi değiştirmiş olabilir
+            }
+        }
+        e = next;
+    }
+    BlockQueue_Unplug();
+}
+
+static inline size_t blockcache_dirty_limit(void)
+{
+    return s_dirty_limit < s_budget / 2 ? s_dirty_limit : s_budget / 2;
+}
+
+// Periyodik görev; zamanlayıcı kesmesinde çalışır, yalnızca istek gönderir
+static void blockcache_flush_task(void* task, void* arg)
+{
+    (void)task;
+    (void)arg;
+    if (s_busy)
+    {
+        if (s_dirty_head) s_flush_due = true;
+        return;
+    }
+    blockcache_writeback_reap();
+    if (s_dirty_head) blockcache_writeback(NULL, false, false);
+}
+
+static void blockcache_start_flusher(void)
+{
+    s_flusher_tried = true;
+    s_flusher = periodic_task_create("blockcache_flush", blockcache_flush_task, NULL, s_flush_interval);
+    if (s_flusher) periodic_task_start(s_flusher);
+    else WARN("BlockCache: no flusher task, dirty blocks are written on sync or at the dirty limit");
+}
+
+static void blockcache_enter(void)
+{
+    s_busy++;
+    asm volatile ("" ::: "memory");
+    if (s_busy != 1) return;
+
+    blockcache_reap();
+    blockcache_writeback_poll();
+    if (s_flush_due)
+    {
+        s_flush_due = false;
+        blockcache_writeback(NULL, true, false);
+    }
+}
+
+static void blockcache_leave(void)
+{
+    asm volatile ("" ::: "memory");
+    s_busy--;
+}
+
+// Kirli veri sınırı aşıldıysa hepsi yazılıp beklenir; sınırın altındaki
+// yazma patlamaları çağıranı bekletmez.
+static void blockcache_throttle(void)
+{
+    if (s_stats.dirty <= blockcache_dirty_limit()) return;
+    s_stats.throttled++;
+    blockcache_writeback(NULL, true, true);
+    blockcache_writeback_wait(NULL);
+}
+
+// Bütçede yer açıp boş bir girdi bağlar; veri çağıranındır. Bellek yoksa NULL.
+static BlockCacheEntry* blockcache_alloc(BlockDevice* dev, uint64_t lba)
+{
+    uint32_t size = dev->logical_block_size;
+    if (blockcache_cost(size) > s_budget) return NULL;
+    while (s_stats.bytes + blockcache_cost(size) > s_budget && blockcache_evict_one()) {}
+    if (s_stats.bytes + blockcache_cost(size) > s_budget && s_dirty_head)
+    {
+        // Yalnızca kirli girdiler kaldı; yazılınca çıkarılabilirler
+        blockcache_writeback(NULL, true, true);
+        blockcache_writeback_wait(NULL);
+        while (s_stats.bytes + blockcache_cost(size) > s_budget && blockcache_evict_one()) {}
+    }
+
+    BlockCacheEntry* e = OBJECT_POOL_NEW(&s_entry_pool, BlockCacheEntry);
+    if (!e) return NULL;
+    e->data = (uint8_t*)malloc(size);
+    if (!e->data)
+    {
+        object_pool_free(&s_entry_pool, e);
+        return NULL;
+    }
+    e->device = dev;
+    e->lba = lba;
+    e->size = size;
+    e->referenced = false;
+    e->dirty = false;
+    e->writing = false;
+    e->redirty = false;
+    e->dirty_prev = e->dirty_next = NULL;
+    e->state = BLOCK_CACHE_VALID;
+    e->io = NULL;
+
+    uint32_t bucket = blockcache_hash(dev, lba);
+    e->hash_next = s_buckets[bucket];
+    s_buckets[bucket] = e;
+
+    // İbrenin hemen arkasına: ibre bir tur atmadan çıkarılmaz
+    if (!s_hand)
+    {
+        e->ring_prev = e->ring_next = e;
+        s_hand = e;
+    }
+    else
+    {
+        e->ring_next = s_hand;
+        e->ring_prev = s_hand->ring_prev;
+        s_hand->ring_prev->ring_next = e;
+        s_hand->ring_prev = e;
+    }
+
+    s_stats.entries++;
+    s_stats.bytes += blockcache_cost(size);
+    return e;
+}
+
+// Bloğun önbellek girdisi; yoksa aygıttan okunur. Önbellek doluysa ya da kapalıysa NULL.
+static BlockCacheEntry* blockcache_get(BlockDevice* dev, uint64_t lba, bool* io_error)
+{
+    BlockCacheEntry* e = blockcache_lookup_ready(dev, lba);
+    if (e)
+    {
+        e->referenced = true;
+        s_stats.hits++;
+        return e;
+    }
+
+    e = blockcache_alloc(dev, lba);
+    if (!e) return NULL;
+    if (!BlockDevice_ReadDirect(dev, lba, 1, e->data))
+    {
+        blockcache_destroy(e);
+        *io_error = true;
+        return NULL;
+    }
+    s_stats.misses++;
+    return e;
+}
+
+static bool blockcache_read(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer)
+{
+    uint32_t bsz = dev->logical_block_size;
+    uint8_t* out = (uint8_t*)buffer;
+    if (count == 0 || s_budget == 0 || (uint64_t)count * bsz > BLOCK_CACHE_BYPASS_BYTES)
+    {
+        s_stats.bypassed += count;
+        if (!BlockDevice_ReadDirect(dev, lba, count, buffer)) return false;
+        // Aygıta henüz yazılmamış bloklar önbellekten
+        for (BlockCacheEntry* e = s_dirty_head; e; e = e->dirty_next)
+        {
+            if (e->device == dev && e->lba >= lba && e->lba - lba < count)
+                memcpy(out + (size_t)(e->lba - lba) * bsz, e->data, bsz);
+        }
+        return true;
+    }
+
+    uint32_t i = 0;
+    while (i < count)
+    {
+        BlockCacheEntry* e = blockcache_lookup_ready(dev, lba + i);
+        if (e)
+        {
+            memcpy(out + (size_t)i * bsz, e->data, bsz);
+            e->referenced = true;
+            s_stats.hits++;
+            i++;
+            continue;
+        }
+
+        // Ardışık eksik bloklar tek istekte, doğrudan çağıranın tamponuna okunur
+        uint32_t run = 1;
+        while (i + run < count && !blockcache_lookup(dev, lba + i + run)) run++;
+        if (!BlockDevice_ReadDirect(dev, lba + i, run, out + (size_t)i * bsz)) return false;
+        s_stats.misses += run;
+
+        for (uint32_t j = 0; j < run; j++)
+        {
+            BlockCacheEntry* fresh = blockcache_alloc(dev, lba + i + j);
+            if (!fresh) break;
+            memcpy(fresh->data, out + (size_t)(i + j) * bsz, bsz);
+        }
+        i += run;
+    }
+    return true;
+}
+
+static void blockcache_invalidate(BlockDevice* dev, uint64_t lba, uint64_t count);
+
+static bool blockcache_write(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer)
+{
+    uint32_t bsz = dev->logical_block_size;
+    const uint8_t* src = (const uint8_t*)buffer;
+    bool fill = s_budget != 0 && (uint64_t)count * bsz <= BLOCK_CACHE_BYPASS_BYTES;
+
+    if (fill && blockcache_dirty_limit() != 0)
+    {
+        // Write-back: bloklar önbellekte kirli kalır, flusher birleştirip yazar
+        uint32_t i = 0;
+        for (; i < count; i++)
+        {
+            BlockCacheEntry* e = blockcache_lookup_ready(dev, lba + i);
+            if (!e) e = blockcache_alloc(dev, lba + i);
+            if (!e) break;
+            memcpy(e->data, src + (size_t)i * bsz, bsz);
+            e->referenced = true;
+            blockcache_mark_dirty(e);
+        }
+        blockcache_throttle();
+        if (i == count) return true;
+
+        // Önbellekte yer kalmadı; kalanı doğrudan yazılır
+        lba += i;
+        count -= i;
+        src += (size_t)i * bsz;
+    }
+
+    // Eski içerikli bir geri yazma bu yazmanın üstüne düşmesin
+    if (blockcache_writeback_pending(dev)) blockcache_writeback_wait(dev);
+    if (!BlockDevice_WriteDirect(dev, lba, count, src))
+    {
+        // Aygıttaki içerik artık bilinmiyor
+        blockcache_invalidate(dev, lba, count);
+        return false;
+    }
+    if (!fill && s_stats.entries == 0) return true;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        BlockCacheEntry* e = blockcache_lookup_ready(dev, lba + i);
+        if (!e && fill) e = blockcache_alloc(dev, lba + i);
+        if (!e) continue;
+        memcpy(e->data, src + (size_t)i * bsz, bsz);
+        e->referenced = true;
+        if (e->dirty) blockcache_dirty_unlink(e);
+    }
+    return true;
+}
+
+static bool blockcache_read_bytes(BlockDevice* dev, uint64_t lba, uint64_t offset, void* out, size_t len)
+{
+    uint32_t bsz = dev->logical_block_size;
+    lba += offset / bsz;
+    offset %= bsz;
+
+    uint8_t* dst = (uint8_t*)out;
+    uint8_t* scratch = NULL; // önbelleğe sığmayan bloklar için
+    bool ok = true;
+    while (len && ok)
+    {
+        size_t n = bsz - (size_t)offset;
+        if (n > len) n = len;
+
+        bool io_error = false;
+        BlockCacheEntry* e = blockcache_get(dev, lba, &io_error);
+        if (e)
+        {
+            memcpy(dst, e->data + offset, n);
+        }
+        else if (io_error)
+        {
+            ok = false;
+        }
+        else
+        {
+            if (!scratch) scratch = (uint8_t*)malloc(bsz);
+            ok = scratch && BlockDevice_ReadDirect(dev, lba, 1, scratch);
+            if (ok) memcpy(dst, scratch + offset, n);
+        }
+
+        dst += n;
+        len -= n;
+        offset = 0;
+        lba++;
+    }
+    if (scratch) free(scratch);
+    return ok;
+}
+
+// Kirli bloklar da atılır: aralığın aygıttaki içeriği önbellekten yenidir
+static void blockcache_invalidate(BlockDevice* dev, uint64_t lba, uint64_t count)
+{
+    blockcache_drain(dev); // süren okuma silinen girdiye yazmasın
+    if (blockcache_writeback_pending(dev)) blockcache_writeback_wait(dev);
+    if (s_stats.entries == 0) return;
+
+    // Aralık önbellekten küçükse blok blok bakılır, değilse tüm tablo taranır
+    if (count <= s_stats.entries)
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            BlockCacheEntry* e = blockcache_lookup(dev, lba + i);
+            if (e) blockcache_destroy(e);
+        }
+        return;
+    }
+
+    for (uint32_t b = 0; b < BLOCK_CACHE_HASH_BUCKETS; b++)
+    {
+        BlockCacheEntry* e = s_buckets[b];
+        while (e)
+        {
+            BlockCacheEntry* next = e->hash_next;
+            if (e->device == dev && e->lba >= lba && e->lba - lba < count) blockcache_destroy(e);
+            e = next;
+        }
+    }
+}
+
+bool BlockCache_Read(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer)
+{
+    if (!dev || !buffer) return false;
+    blockcache_enter();
+    bool ok = blockcache_read(dev, lba, count, buffer);
+    blockcache_leave();
+    return ok;
+}
+
+bool BlockCache_Write(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer)
+{
+    if (!dev || !buffer) return false;
+    blockcache_enter();
+    bool ok = blockcache_write(dev, lba, count, buffer);
+    blockcache_leave();
+    return ok;
+}
+
+bool BlockCache_ReadBytes(BlockDevice* dev, uint64_t lba, uint64_t offset, void* out, size_t len)
+{
+    if (!dev || !out) return false;
+    blockcache_enter();
+    bool ok = blockcache_read_bytes(dev, lba, offset, out, len);
+    blockcache_leave();
+    return ok;
+}
+
+void BlockCache_Invalidate(BlockDevice* dev, uint64_t lba, uint64_t count)
+{
+    if (!dev) return;
+    blockcache_enter();
+    blockcache_invalidate(dev, lba, count);
+    blockcache_leave();
+}
+
+// Eksik blokların ardışık bir dizisini tek istekle okur
+static void blockcache_prefetch_run(BlockDevice* dev, uint64_t lba, uint32_t count)
+{
+    BlockCachePrefetch* io = (BlockCachePrefetch*)malloc(sizeof(BlockCachePrefetch) +
+                                                         count * (sizeof(BlockCacheEntry*) + sizeof(BlockSegment)));
+    if (!io) return;
+    io->device = dev;
+    io->entries = (BlockCacheEntry**)(io + 1);
+    io->segments = (BlockSegment*)(io->entries + count);
+
+    uint32_t n = 0;
+    while (n < count)
+    {
+        BlockCacheEntry* e = blockcache_alloc(dev, lba + n);
+        if (!e) break;
+        e->state = BLOCK_CACHE_READING; // bu isteğin sonraki ayırmaları çıkarmasın
+        e->io = io;
+        io->entries[n] = e;
+        io->segments[n].buffer = e->data;
+        io->segments[n].length = e->size;
+        n++;
+    }
+    if (n == 0)
+    {
+        free(io);
+        return;
+    }
+    io->count = n;
+
+    BlockRequest_Init(&io->req, dev, BLKREQ_READ, lba, n, NULL);
+    io->req.segments = io->segments;
+    io->req.segment_count = n;
+    io->req.callback = blockcache_prefetch_done;
+    io->req.callback_arg = io;
+    io->inflight_next = s_inflight;
+    s_inflight = io;
+    s_stats.prefetched += n;
+
+    if (!BlockDevice_Submit(dev, &io->req))
+    {
+        io->req.status = BLKREQ_STATUS_ERROR;
+        blockcache_prefetch_done(&io->req);
+    }
+}
+
+void BlockCache_Prefetch(BlockDevice* dev, uint64_t lba, uint32_t count)
+{
+    if (!dev || !dev->ops || (!dev->ops->read && !dev->ops->submit)) return;
+    if (s_budget == 0 || count == 0) return;
+
+    uint32_t bsz = dev->logical_block_size;
+    if (dev->total_blocks)
+    {
+        if (lba >= dev->total_blocks) return;
+        if (count > dev->total_blocks - lba) count = (uint32_t)(dev->total_blocks - lba);
+    }
+    // Ön okuma önbelleğin çeyreğinden fazlasını kendi bloklarıyla değiştirmesin
+    size_t limit = s_budget / 4 / blockcache_cost(bsz);
+    if (count > limit) count = (uint32_t)limit;
+
+    blockcache_enter();
+    BlockQueue_Plug();
+    uint32_t i = 0;
+    while (i < count)
+    {
+        if (blockcache_lookup(dev, lba + i))
+        {
+            i++;
+            continue;
+        }
+        uint32_t run = 1;
+        while (i + run < count && !blockcache_lookup(dev, lba + i + run)) run++;
+        blockcache_prefetch_run(dev, lba + i, run);
+        i += run;
+    }
+    BlockQueue_Unplug();
+    blockcache_leave();
+}
+
+void BlockCache_InvalidateDevice(BlockDevice* dev)
+{
+    BlockCache_Invalidate(dev, 0, UINT64_MAX);
+}
+
+bool BlockCache_Sync(BlockDevice* dev)
+{
+    if (s_busy)
+    {
+        // Önbellek işleminin ortasından (assert, kapanma) gelindi; yapılar yarım olabilir
+        WARN("BlockCache_Sync: called from inside the cache, skipping");
+        return false;
+    }
+    blockcache_enter();
+    blockcache_writeback(dev, true, true);
+    blockcache_writeback_wait(dev);
+    bool ok = !s_write_failed;
+    s_write_failed = false;
+    blockcache_leave();
+    return ok;
+}
+
+void BlockCache_SetWriteBack(size_t dirty_limit, uint32_t flush_interval_ms)
+{
+    if (flush_interval_ms == 0) flush_interval_ms = BLOCK_CACHE_DEFAULT_FLUSH_MS;
+    blockcache_enter();
+    s_dirty_limit = dirty_limit;
+    s_flush_interval = flush_interval_ms;
+    if (s_flusher) s_flusher->intervalMs = flush_interval_ms;
+    if (dirty_limit == 0)
+    {
+        blockcache_writeback(NULL, true, true);
+        blockcache_writeback_wait(NULL);
+    }
+    blockcache_leave();
+
+    if (dirty_limit == 0) LOG("BlockCache: write-through");
+    else LOG("BlockCache: write-back, dirty limit %zu KiB, flush every %u ms", dirty_limit / 1024, flush_interval_ms);
+}
+
+void BlockCache_SetBudget(size_t bytes)
+{
+    blockcache_enter();
+    s_budget = bytes;
+    while (s_stats.bytes > s_budget && blockcache_evict_one()) {}
+    if (s_stats.bytes > s_budget && s_dirty_head)
+    {
+        blockcache_writeback(NULL, true, true);
+        blockcache_writeback_wait(NULL);
+        while (s_stats.bytes > s_budget && blockcache_evict_one()) {}
+    }
+    blockcache_leave();
+    LOG("BlockCache: budget set to %zu KiB", s_budget / 1024);
+}
+
+size_t BlockCache_GetBudget(void)
+{
+    return s_budget;
+}
+
+void BlockCache_GetStats(BlockCacheStats* out)
+{
+    if (!out) return;
+    *out = s_stats;
+    out->budget = s_budget;
+    out->dirty_limit = blockcache_dirty_limit();
+    out->flush_interval_ms = s_flush_interval;
+}
+
+void BlockCache_DumpStats(void)
+{
+    uint64_t lookups = s_stats.hits + s_stats.misses;
+    unsigned rate = lookups ? (unsigned)(s_stats.hits * 100 / lookups) : 0;
+    LOG("BlockCache: %zu blocks, %zu/%zu KiB, hits=%llu misses=%llu (%u%%) prefetched=%llu bypassed=%llu evictions=%llu",
+        s_stats.entries, s_stats.bytes / 1024, s_budget / 1024,
+        (unsigned long long)s_stats.hits, (unsigned long long)s_stats.misses, rate,
+        (unsigned long long)s_stats.prefetched, (unsigned long long)s_stats.bypassed,
+        (unsigned long long)s_stats.evictions);
+    LOG("BlockCache: dirty %zu/%zu KiB, written back %llu blocks in %llu requests, throttled=%llu errors=%llu",
+        s_stats.dirty / 1024, blockcache_dirty_limit() / 1024,
+        (unsigned long long)s_stats.written_back, (unsigned long long)s_stats.writeback_requests,
+        (unsigned long long)s_stats.throttled, (unsigned long long)s_stats.write_errors);
+}
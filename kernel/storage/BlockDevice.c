@@ -1,6 +1,9 @@
 #include <storage/BlockDevice.h>
+#include <storage/BlockCache.h>
+#include <storage/BlockQueue.h>
 #include <memory/memory.h>
 #include <debug/debug.h>
+#include <arch.h>
 
 static List* s_blkdev_list = NULL;
 
@@ -17,7 +20,7 @@ BlockDevice* BlockDevice_Register(const char* name,
                                   void* driver_ctx)
 {
     if (!s_blkdev_list) BlockDevice_InitRegistry();
-    if (!ops || !ops->read) {
+    if (!ops || (!ops->read && !ops->submit)) {
         ERROR("BlockDevice_Register('%s'): invalid ops", name ? name : "<noname>");
         return NULL;
     }
@@ -29,6 +32,13 @@ BlockDevice* BlockDevice_Register(const char* name,
     d->total_blocks = total_blocks;
     d->ops = ops;
     d->driver_ctx = driver_ctx;
+    d->irq_completion = false; // sürücü kesme hattını doğruladıktan sonra açar
+    d->async_submit = false;   // submit'i olmak yetmez; sürücü bloklamadan tamamlıyorsa açar
+    d->max_transfer_blocks = 0;
+    d->max_segments = 0;
+    d->queue_depth = 1;
+    d->queue = NULL;
+    if (ops->submit) BlockQueue_Attach(d);
     List_Add(s_blkdev_list, d);
     LOG("BlockDevice: registered '%s' type=%u block=%u total=%u", d->name, (unsigned)d->type, d->logical_block_size, (unsigned)(d->total_blocks));
     return d;
@@ -48,10 +58,22 @@ BlockDevice* BlockDevice_GetAt(size_t index)
 bool BlockDevice_Read(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer)
 {
     if (!dev || !dev->ops || !dev->ops->read) return false;
-    return dev->ops->read(dev, lba, count, buffer);
+    return BlockCache_Read(dev, lba, count, buffer);
 }
 
 bool BlockDevice_Write(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer)
+{
+    if (!dev || !dev->ops || !dev->ops->write) return false;
+    return BlockCache_Write(dev, lba, count, buffer);
+}
+
+bool BlockDevice_ReadDirect(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer)
+{
+    if (!dev || !dev->ops || !dev->ops->read) return false;
+    return dev->ops->read(dev, lba, count, buffer);
+}
+
+bool BlockDevice_WriteDirect(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer)
 {
     if (!dev || !dev->ops || !dev->ops->write) return false;
     return dev->ops->write(dev, lba, count, buffer);
@@ -59,7 +81,158 @@ bool BlockDevice_Write(BlockDevice* dev, uint64_t lba, uint32_t count, const voi
 
 bool BlockDevice_Flush(BlockDevice* dev)
 {
-    if (!dev || !dev->ops || !dev->ops->flush) return true;
-    return dev->ops->flush(dev);
+    if (!dev) return true;
+    // Bariyer: önce önbellekteki kirli bloklar, sonra aygıtın yazma önbelleği
+    bool ok = BlockCache_Sync(dev);
+    BlockQueue_Drain(dev);
+    if (dev->ops && dev->ops->flush) ok = dev->ops->flush(dev) && ok;
+    return ok;
+}
+
+
+void BlockRequest_Init(BlockRequest* req, BlockDevice* dev, BlockRequestOp op, uint64_t lba, uint32_t count, void* buffer)
+{
+    if (!req) return;
+    memset(req, 0, sizeof(BlockRequest));
+    req->op = op;
+    req->lba = lba;
+    req->count = count;
+    req->single.buffer = buffer;
+    req->single.length = dev ? count * dev->logical_block_size : 0;
+    req->segments = &req->single;
+    req->segment_count = 1;
+}
+
+void* BlockRequest_BufferAt(const BlockRequest* req, uint32_t block, uint32_t* contiguous)
+{
+    if (contiguous) *contiguous = 0;
+    if (!req || !req->device) return NULL;
+    uint32_t bsz = req->device->logical_block_size;
+
+    for (uint32_t i = 0; i < req->segment_count; i++)
+    {
+        uint32_t blocks = req->segments[i].length / bsz;
+        if (block < blocks)
+        {
+            if (contiguous) *contiguous = blocks - block;
+            return (uint8_t*)req->segments[i].buffer + (size_t)block * bsz;
+        }
+        block -= blocks;
+    }
+    return NULL;
+}
+
+void BlockRequest_Complete(BlockRequest* req, bool ok)
+{
+    if (!req) return;
+    req->status = ok ? BLKREQ_STATUS_OK : BLKREQ_STATUS_ERROR;
+    if (BlockQueue_Complete(req)) return;
+    if (req->callback) req->callback(req);
+}
+
+// submit'i olmayan sürücüler için: istek parça parça senkron çalıştırılır
+static bool blockdevice_run_sync(BlockDevice* dev, BlockRequest* req)
+{
+    uint32_t block = 0;
+    while (block < req->count)
+    {
+        uint32_t n = 0;
+        void* buf = BlockRequest_BufferAt(req, block, &n);
+        if (!buf) return false;
+        if (n > req->count - block) n = req->count - block;
+
+        bool ok = (req->op == BLKREQ_WRITE)
+            ? (dev->ops->write && dev->ops->write(dev, req->lba + block, n, buf))
+            : (dev->ops->read && dev->ops->read(dev, req->lba + block, n, buf));
+        if (!ok) return false;
+        block += n;
+    }
+    return true;
 }
 
+bool BlockDevice_Submit(BlockDevice* dev, BlockRequest* req)
+{
+    if (!dev || !dev->ops || !req || !req->segments || req->segment_count == 0) return false;
+
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < req->segment_count; i++)
+    {
+        if (!req->segments[i].buffer || req->segments[i].length % dev->logical_block_size)
+        {
+            ERROR("BlockDevice_Submit('%s'): segment %u is not a whole number of blocks", dev->name, i);
+            return false;
+        }
+        bytes += req->segments[i].length;
+    }
+    if (bytes < (uint64_t)req->count * dev->logical_block_size)
+    {
+        ERROR("BlockDevice_Submit('%s'): %u blocks do not fit in the scatter list", dev->name, req->count);
+        return false;
+    }
+
+    req->device = dev;
+    req->next = NULL;
+    req->issued = 0;
+    req->inflight = 0;
+    req->driver_flags = 0;
+    req->sched_flags = 0;
+    req->error = false;
+    req->status = BLKREQ_STATUS_PENDING;
+
+    if (req->count == 0)
+    {
+        BlockRequest_Complete(req, true);
+        return true;
+    }
+    if (dev->queue)
+    {
+        BlockQueue_Submit(dev, req);
+        return true;
+    }
+    if (dev->ops->submit) return dev->ops->submit(dev, req);
+
+    BlockRequest_Complete(req, blockdevice_run_sync(dev, req));
+    return true;
+}
+
+void BlockDevice_Poll(BlockDevice* dev)
+{
+    if (dev && dev->ops && dev->ops->poll) dev->ops->poll(dev);
+}
+
+bool BlockDevice_Wait(BlockDevice* dev, BlockRequest* req)
+{
+    if (!req) return false;
+    BlockQueue_Run(dev); // tıkaçlı bir bölgeden beklenen istek kuyrukta kalmasın
+    while (req->status == BLKREQ_STATUS_PENDING)
+    {
+        BlockDevice_Poll(dev);
+        if (dev && dev->irq_completion)
+        {
+            // Durum kesmeler kapalıyken yeniden denetlenir; tamamlanma ISR'dan gelir
+            size_t flags = arch_irq_save();
+            if (req->status == BLKREQ_STATUS_PENDING && arch_irq_wait(flags)) continue;
+            arch_irq_restore(flags);
+        }
+        asm volatile ("pause");
+    }
+    return req->status == BLKREQ_STATUS_OK;
+}
+
+static bool blockdevice_sync_rw(BlockDevice* dev, BlockRequestOp op, uint64_t lba, uint32_t count, void* buffer)
+{
+    BlockRequest req;
+    BlockRequest_Init(&req, dev, op, lba, count, buffer);
+    if (!BlockDevice_Submit(dev, &req)) return false;
+    return BlockDevice_Wait(dev, &req);
+}
+
+bool BlockDevice_SyncRead(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer)
+{
+    return blockdevice_sync_rw(dev, BLKREQ_READ, lba, count, buffer);
+}
+
+bool BlockDevice_SyncWrite(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer)
+{
+    return blockdevice_sync_rw(dev, BLKREQ_WRITE, lba, count, (void*)buffer);
+}
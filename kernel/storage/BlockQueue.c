@@ -0,0 +1,374 @@
+#include <storage/BlockQueue.h>
+#include <memory/memory.h>
+#include <debug/debug.h>
+#include <arch.h>
+
+#define BLKQ_DISPATCHED 0x1u // sürücüde; tamamlanması BlockQueue_Complete'ten geçer
+#define BLKQ_MERGED     0x2u // birleşik istek; sched_next parçaların listesi
+
+// Birleşik istek; req ilk üye, BlockQueue_Complete geri dönüştürür
+typedef struct BlockQueueMerge
+{
+    BlockRequest req;
+    bool used;
+    BlockSegment segments[BLOCK_QUEUE_MERGE_SEGMENTS];
+} BlockQueueMerge;
+
+typedef struct BlockQueue
+{
+    BlockDevice* device;
+    struct BlockQueue* next;  // tüm kuyruklar; Unplug hepsini ilerletir
+    BlockRequest* head;       // LBA'ya göre sıralı (eşitler geliş sırasıyla)
+    uint32_t queued;
+    uint32_t inflight;
+    uint32_t seq;
+    uint64_t position;        // son verilen isteğin sonu; asansörün yeri
+    bool dispatching;         // yeniden girişte (eşzamanlı tamamlanma, kesme) dıştaki döngü verir
+    BlockQueueStats stats;
+    BlockQueueMerge merges[BLOCK_QUEUE_MERGE_SLOTS];
+} BlockQueue;
+
+static BlockQueue* s_queues = NULL;
+static volatile uint32_t s_plugged = 0;
+
+bool BlockQueue_Attach(BlockDevice* dev)
+{
+    if (!dev || dev->queue) return dev != NULL;
+    BlockQueue* q = (BlockQueue*)malloc(sizeof(BlockQueue));
+    if (!q)
+    {
+        WARN("BlockQueue: no memory for '%s', requests go straight to the driver", dev->name);
+        return false;
+    }
+    memset(q, 0, sizeof(BlockQueue));
+    q->device = dev;
+
+    size_t flags = arch_irq_save();
+    q->next = s_queues;
+    s_queues = q;
+    dev->queue = q;
+    arch_irq_restore(flags);
+    return true;
+}
+
+static inline bool blockqueue_overlap(const BlockRequest* a, const BlockRequest* b)
+{
+    if (a->op != BLKREQ_WRITE && b->op != BLKREQ_WRITE) return false;
+    return a->lba < b->lba + b->count && b->lba < a->lba + a->count;
+}
+
+static inline bool blockqueue_older(const BlockRequest* a, const BlockRequest* b)
+{
+    return (int32_t)(a->sched_seq - b->sched_seq) < 0;
+}
+
+// r'den önce gelmiş ve onunla çakışan en eski istek
+static BlockRequest* blockqueue_older_conflict(BlockQueue* q, const BlockRequest* r)
+{
+    BlockRequest* oldest = NULL;
+    for (BlockRequest* x = q->head; x; x = x->sched_next)
+    {
+        if (x == r || !blockqueue_older(x, r) || !blockqueue_overlap(x, r)) continue;
+        if (!oldest || blockqueue_older(x, oldest)) oldest = x;
+    }
+    return oldest;
+}
+
+static void blockqueue_unlink(BlockQueue* q, BlockRequest* r)
+{
+    BlockRequest** link = &q->head;
+    while (*link != r) link = &(*link)->sched_next;
+    *link = r->sched_next;
+    r->sched_next = NULL;
+    q->queued--;
+}
+
+// Sıradaki istek: süresi dolan en eski, yoksa asansörün önündeki ilk istek
+static BlockRequest* blockqueue_pick(BlockQueue* q)
+{
+    uint64_t now = uptimeMs;
+    BlockRequest* r = NULL;
+    for (BlockRequest* x = q->head; x; x = x->sched_next)
+    {
+        if (x->deadline <= now && (!r || x->deadline < r->deadline)) r = x;
+    }
+    if (r)
+    {
+        q->stats.expired++;
+    }
+    else
+    {
+        for (r = q->head; r && r->lba < q->position; r = r->sched_next) {}
+        if (!r) r = q->head; // sona varıldı; baştan (C-SCAN)
+    }
+
+    BlockRequest* older;
+    while ((older = blockqueue_older_conflict(q, r)) != NULL) r = older;
+    blockqueue_unlink(q, r);
+    return r;
+}
+
+// child'ın verisinin m'nin scatter listesine eklenince kaç yeni parça açacağı
+static uint32_t blockqueue_segments_needed(const BlockQueueMerge* m, const BlockRequest* child, uint32_t bsz)
+{
+    const BlockSegment* last = m->req.segment_count ? &m->segments[m->req.segment_count - 1] : NULL;
+    uint64_t bytes = (uint64_t)child->count * bsz;
+    uint32_t needed = 0;
+    for (uint32_t i = 0; i < child->segment_count && bytes; i++)
+    {
+        uint32_t len = child->segments[i].length;
+        if (len > bytes) len = (uint32_t)bytes;
+        bool joins = last && (uint8_t*)last->buffer + last->length == (uint8_t*)child->segments[i].buffer &&
+                     (uint64_t)last->length + len <= UINT32_MAX;
+        if (!joins) needed++;
+        last = &child->segments[i];
+        bytes -= len;
+    }
+    return needed;
+}
+
+static void blockqueue_append(BlockQueueMerge* m, const BlockRequest* child, uint32_t bsz)
+{
+    uint64_t bytes = (uint64_t)child->count * bsz;
+    for (uint32_t i = 0; i < child->segment_count && bytes; i++)
+    {
+        uint32_t len = child->segments[i].length;
+        if (len > bytes) len = (uint32_t)bytes;
+        BlockSegment* last = m->req.segment_count ? &m->segments[m->req.segment_count - 1] : NULL;
+        if (last && (uint8_t*)last->buffer + last->length == (uint8_t*)child->segments[i].buffer &&
+            (uint64_t)last->length + len <= UINT32_MAX)
+        {
+            last->length += len;
+        }
+        else
+        {
+            m->segments[m->req.segment_count].buffer = child->segments[i].buffer;
+            m->segments[m->req.segment_count].length = len;
+            m->req.segment_count++;
+        }
+        bytes -= len;
+    }
+    m->req.count += child->count;
+}
+
+static BlockRequest* blockqueue_find_at(BlockQueue* q, uint64_t lba)
+{
+    for (BlockRequest* x = q->head; x && x->lba <= lba; x = x->sched_next)
+    {
+        if (x->lba == lba) return x;
+    }
+    return NULL;
+}
+
+// r'nin arkasından bitişik, aynı yöndeki istekleri sürücü sınırları içinde
+// birleştirir. Birleşik isteği ya da (birleşme yoksa) r'yi döner.
+static BlockRequest* blockqueue_merge(BlockQueue* q, BlockRequest* r)
+{
+    BlockDevice* dev = q->device;
+    uint32_t bsz = dev->logical_block_size;
+    uint32_t max_blocks = dev->max_transfer_blocks ? dev->max_transfer_blocks : UINT32_MAX;
+    uint32_t max_segments = BLOCK_QUEUE_MERGE_SEGMENTS;
+    if (dev->max_segments && dev->max_segments < max_segments) max_segments = dev->max_segments;
+
+    BlockQueueMerge* m = NULL;
+    BlockRequest* tail = r;
+    for (;;)
+    {
+        BlockRequest* f = blockqueue_find_at(q, tail->lba + tail->count);
+        if (!f || f->op != r->op) break;
+        uint32_t blocks = m ? m->req.count : r->count;
+        if ((uint64_t)blocks + f->count > max_blocks) break;
+        if (blockqueue_older_conflict(q, f)) break; // öne geçemez
+
+        if (!m)
+        {
+            for (uint32_t i = 0; i < BLOCK_QUEUE_MERGE_SLOTS && !m; i++)
+            {
+                if (!q->merges[i].used) m = &q->merges[i];
+            }
+            if (!m) break;
+            BlockRequest_Init(&m->req, dev, r->op, r->lba, 0, NULL);
+            m->req.segments = m->segments;
+            m->req.segment_count = 0;
+            if (blockqueue_segments_needed(m, r, bsz) > max_segments) return r;
+            blockqueue_append(m, r, bsz);
+            m->req.sched_next = r;
+        }
+        if (m->req.segment_count + blockqueue_segments_needed(m, f, bsz) > max_segments) break;
+
+        blockqueue_unlink(q, f);
+        blockqueue_append(m, f, bsz);
+        tail->sched_next = f;
+        tail = f;
+        q->stats.merged++;
+    }
+
+    if (!m) return r;
+    if (tail == r) return r; // ilk aday sığmadı; yuva kullanılmadı
+    m->used = true;
+    m->req.sched_flags = BLKQ_MERGED;
+    return &m->req;
+}
+
+// Tıkaç ve derinlik izin verdikçe istekleri sürücüye verir
+static void blockqueue_dispatch(BlockQueue* q, bool force)
+{
+    BlockDevice* dev = q->device;
+    size_t flags = arch_irq_save();
+    if (q->dispatching)
+    {
+        arch_irq_restore(flags);
+        return;
+    }
+    q->dispatching = true;
+
+    for (;;)
+    {
+        uint32_t depth = dev->queue_depth ? dev->queue_depth : 1;
+        if ((s_plugged && !force) || !q->head || q->inflight >= depth) break;
+
+        BlockRequest* r = blockqueue_merge(q, blockqueue_pick(q));
+        q->position = r->lba + r->count;
+        q->inflight++;
+        q->stats.dispatched++;
+
+        r->sched_flags |= BLKQ_DISPATCHED;
+        r->device = dev;
+        r->next = NULL;
+        r->issued = 0;
+        r->inflight = 0;
+        r->driver_flags = 0;
+        r->error = false;
+        r->status = BLKREQ_STATUS_PENDING;
+        arch_irq_restore(flags);
+
+        if (!dev->ops->submit(dev, r))
+        {
+            WARN("BlockQueue: '%s' rejected a %u-block %s at LBA %llu", dev->name, r->count,
+                 r->op == BLKREQ_WRITE ? "write" : "read", (unsigned long long)r->lba);
+            BlockRequest_Complete(r, false);
+        }
+        flags = arch_irq_save();
+    }
+
+    q->dispatching = false;
+    arch_irq_restore(flags);
+}
+
+void BlockQueue_Submit(BlockDevice* dev, BlockRequest* req)
+{
+    BlockQueue* q = dev->queue;
+    size_t flags = arch_irq_save();
+    req->sched_flags = 0;
+    req->sched_seq = q->seq++;
+    req->deadline = uptimeMs + (req->op == BLKREQ_WRITE ? BLOCK_QUEUE_WRITE_EXPIRE_MS : BLOCK_QUEUE_READ_EXPIRE_MS);
+
+    BlockRequest** link = &q->head;
+    while (*link && (*link)->lba <= req->lba) link = &(*link)->sched_next;
+    req->sched_next = *link;
+    *link = req;
+
+    q->queued++;
+    q->stats.submitted++;
+    if (q->queued + q->inflight > q->stats.max_depth) q->stats.max_depth = q->queued + q->inflight;
+    arch_irq_restore(flags);
+
+    blockqueue_dispatch(q, false);
+}
+
+bool BlockQueue_Complete(BlockRequest* req)
+{
+    if (!(req->sched_flags & BLKQ_DISPATCHED)) return false;
+    BlockQueue* q = req->device->queue;
+    bool ok = req->status == BLKREQ_STATUS_OK;
+
+    size_t flags = arch_irq_save();
+    req->sched_flags &= ~BLKQ_DISPATCHED;
+    q->inflight--;
+    arch_irq_restore(flags);
+
+    if (req->sched_flags & BLKQ_MERGED)
+    {
+        BlockRequest* child = req->sched_next;
+        ((BlockQueueMerge*)req)->used = false;
+        while (child)
+        {
+            BlockRequest* next = child->sched_next;
+            child->sched_next = NULL;
+            BlockRequest_Complete(child, ok);
+            child = next;
+        }
+    }
+    else if (req->callback)
+    {
+        req->callback(req); // bundan sonra req çağıranındır
+    }
+
+    blockqueue_dispatch(q, false);
+    return true;
+}
+
+void BlockQueue_Plug(void)
+{
+    size_t flags = arch_irq_save();
+    s_plugged++;
+    arch_irq_restore(flags);
+}
+
+void BlockQueue_Unplug(void)
+{
+    size_t flags = arch_irq_save();
+    if (s_plugged) s_plugged--;
+    bool run = s_plugged == 0;
+    arch_irq_restore(flags);
+    if (!run) return;
+
+    for (BlockQueue* q = s_queues; q; q = q->next)
+    {
+        if (q->head) blockqueue_dispatch(q, false);
+    }
+}
+
+void BlockQueue_Run(BlockDevice* dev)
+{
+    if (dev && dev->queue && dev->queue->head) blockqueue_dispatch(dev->queue, true);
+}
+
+void BlockQueue_Drain(BlockDevice* dev)
+{
+    if (!dev || !dev->queue) return;
+    BlockQueue* q = dev->queue;
+    while (q->head || q->inflight)
+    {
+        BlockQueue_Run(dev);
+        BlockDevice_Poll(dev);
+        if (dev->irq_completion)
+        {
+            size_t flags = arch_irq_save();
+            if ((q->head || q->inflight) && arch_irq_wait(flags)) continue;
+            arch_irq_restore(flags);
+        }
+        asm volatile ("pause");
+    }
+}
+
+bool BlockQueue_GetStats(BlockDevice* dev, BlockQueueStats* out)
+{
+    if (!dev || !dev->queue || !out) return false;
+    size_t flags = arch_irq_save();
+    *out = dev->queue->stats;
+    out->queued = dev->queue->queued;
+    out->inflight = dev->queue->inflight;
+    arch_irq_restore(flags);
+    return true;
+}
+
+void BlockQueue_DumpStats(BlockDevice* dev)
+{
+    BlockQueueStats s;
+    if (!BlockQueue_GetStats(dev, &s)) return;
+    LOG("BlockQueue '%s': queued=%u inflight=%u/%u max_depth=%u submitted=%llu dispatched=%llu merged=%llu expired=%llu",
+        dev->name, s.queued, s.inflight, dev->queue_depth ? dev->queue_depth : 1u, s.max_depth,
+        (unsigned long long)s.submitted, (unsigned long long)s.dispatched,
+        (unsigned long long)s.merged, (unsigned long long)s.expired);
+}
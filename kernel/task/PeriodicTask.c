@@ -2,10 +2,13 @@
 #include <list.h>
 #include <time/timer.h>
 #include <memory/memory.h>
+#include <memory/objpool.h>
 #include <util/string.h>
 
 List* periodicTasks = NULL;
 
+static ObjectPool periodic_task_pool = OBJECT_POOL_STATIC(PeriodicTask, 16, true);
+
 PeriodicTask* periodic_task_create(const char* name, void(*taskFunction)(void* task, void* arg), void* arg, size_t intervalMs)
 {
     if (!periodicTasks)
@@ -13,8 +16,14 @@ PeriodicTask* periodic_task_create(const char* name, void(*taskFunction)(void* t
         periodicTasks = List_Create();
     }
 
-    PeriodicTask* task = (PeriodicTask*)malloc(sizeof(PeriodicTask));
+    PeriodicTask* task = OBJECT_POOL_NEW(&periodic_task_pool, PeriodicTask);
+    if (!task) return NULL;
     task->name = (char*)malloc(strlen(name) + 1);
+    if (!task->name)
+    {
+        object_pool_free(&periodic_task_pool, task);
+        return NULL;
+    }
     strcpy(task->name, name);
     task->taskFunction = taskFunction;
     task->arg = arg;
@@ -53,7 +62,7 @@ void periodic_task_destroy(PeriodicTask* task)
             List_Remove(periodicTasks, task);
         }
         free(task->name);
-        free(task);
+        object_pool_free(&periodic_task_pool, task);
     }
 }
 
@@ -0,0 +1,77 @@
+#include <graphics/gfx.h>
+#include <graphics/screen.h>
+#include <debug/debug.h>
+#include <time/timer.h>
+#include <arch.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Boot sırasında gfx_draw_bpp32'nin tam ekran kopyalama süresini ölçer: önce
+// framebuffer firmware'in bıraktığı tiple (PAT girdisi WB, tip MTRR'dan gelir),
+// sonra screen_init'in kurduğu write-combining tiple.
+
+#define FB_BENCH_WINDOW_MS 250
+
+extern void gfx_draw_task();
+extern gfx_buffer* hardware_buffer;
+
+static uint64_t fb_bench_pass(uint32_t* frames)
+{
+    // Tick sınırına hizalan
+    uint64_t start = uptimeMs;
+    while (uptimeMs == start) asm volatile ("pause");
+    start = uptimeMs;
+
+    uint32_t count = 0;
+    do
+    {
+        gfx_draw_task();
+        count++;
+    } while (uptimeMs - start < FB_BENCH_WINDOW_MS);
+
+    *frames = count;
+    return uptimeMs - start;
+}
+
+static void fb_bench_report(const char* label, uint64_t ms, uint32_t frames, size_t frame_bytes)
+{
+    uint64_t us_per_frame = ms * 1000 / frames;
+    uint64_t mb_per_s = (uint64_t)frame_bytes * frames / 1024 / 1024 * 1000 / (ms ? ms : 1);
+    LOG("fb bench: %s %u frames in %llu ms (%llu us/frame, %llu MiB/s)",
+        label, frames, ms, us_per_frame, mb_per_s);
+}
+
+void fb_bench_run(void)
+{
+    ScreenVideoModeInfo* mode = main_screen.mode;
+    if (!mode || !hardware_buffer || mode->bpp != 32)
+    {
+        LOG("fb bench: skipped (needs a 32bpp framebuffer)");
+        return;
+    }
+
+    uintptr_t fb = (uintptr_t)mode->framebuffer;
+    size_t frame_bytes = mode->width * mode->height * sizeof(uint32_t);
+    uint32_t frames;
+
+    LOG("fb bench: full-frame copy %zux%zu (%zu KiB)", mode->width, mode->height, frame_bytes / 1024);
+
+    arch_paging_memtype_t current = arch_paging_get_memtype(fb);
+
+#ifdef ARCH_AMD
+    // PAT ile kurulduysa geçici olarak eski tipe dönülüp ölçülebilir
+    if (current == ARCH_PAGING_MT_WC && arch_paging_set_memtype(fb, mode->pitch * mode->height, ARCH_PAGING_MT_WB))
+    {
+        uint64_t ms = fb_bench_pass(&frames);
+        fb_bench_report("firmware type:", ms, frames, frame_bytes);
+        arch_paging_set_memtype(fb, mode->pitch * mode->height, ARCH_PAGING_MT_WC);
+    }
+    else
+#endif
+    {
+        LOG("fb bench: framebuffer type not set through PAT, firmware type not measured");
+    }
+
+    uint64_t ms = fb_bench_pass(&frames);
+    fb_bench_report(current == ARCH_PAGING_MT_WC ? "write-combining:" : "current type:  ", ms, frames, frame_bytes);
+}
@@ -0,0 +1,69 @@
+#include <memory/memory.h>
+#include <memory/slab.h>
+#include <debug/debug.h>
+#include <time/timer.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Boot sırasında küçük nesne alloc/free hızını ölçer: önce slab kapalıyken
+// (first-fit), sonra slab açıkken. Sonuçlar saniyedeki allocation sayısı olarak basılır.
+
+#define HEAP_BENCH_LIVE 256
+#define HEAP_BENCH_OPS  20000
+
+static uint32_t heap_bench_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint64_t heap_bench_pass(void)
+{
+    void* live[HEAP_BENCH_LIVE];
+    for (size_t i = 0; i < HEAP_BENCH_LIVE; i++) live[i] = NULL;
+
+    uint32_t seed = 0x12345678u;
+
+    // Tick sınırına hizalan, böylece ölçüm yarım milisaniye kaybetmez
+    uint64_t start = uptimeMs;
+    while (uptimeMs == start) asm volatile ("pause");
+    start = uptimeMs;
+
+    for (size_t op = 0; op < HEAP_BENCH_OPS; op++)
+    {
+        uint32_t r = heap_bench_rand(&seed);
+        size_t slot = r % HEAP_BENCH_LIVE;
+        if (live[slot]) free(live[slot]);
+        // ListNode/BufferNode/VFSCacheEntry gibi 16..512 baytlık istekler
+        live[slot] = malloc(16 + ((r >> 8) % 497));
+    }
+
+    uint64_t elapsed = uptimeMs - start;
+
+    for (size_t i = 0; i < HEAP_BENCH_LIVE; i++)
+        if (live[i]) free(live[i]);
+
+    return elapsed ? elapsed : 1;
+}
+
+void heap_bench_run(void)
+{
+    bool was_enabled = slab_is_enabled();
+
+    slab_set_enabled(false);
+    uint64_t ff_ms = heap_bench_pass();
+
+    slab_set_enabled(true);
+    uint64_t slab_ms = heap_bench_pass();
+
+    slab_set_enabled(was_enabled);
+
+    LOG("heap bench: first-fit %u ops in %llu ms (%llu alloc/s)",
+        HEAP_BENCH_OPS, ff_ms, (uint64_t)HEAP_BENCH_OPS * 1000 / ff_ms);
+    LOG("heap bench: slab      %u ops in %llu ms (%llu alloc/s)",
+        HEAP_BENCH_OPS, slab_ms, (uint64_t)HEAP_BENCH_OPS * 1000 / slab_ms);
+}
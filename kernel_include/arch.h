@@ -142,6 +142,21 @@ extern void arch_cpuid(uint32_t leaf, size_t* regA, size_t* regB, size_t* regC,
 
 extern void arch_bios_int(uint8_t int_no, arch_processor_regs_t* in, arch_processor_regs_t* out);
 
+/* Disable interrupts on the local CPU and return the previous flags register. */
+size_t arch_irq_save(void);
+
+/* Restore the interrupt flag saved by arch_irq_save. */
+void arch_irq_restore(size_t flags);
+
+/* Sleep until the next interrupt, atomically re-enabling interrupts first.
+ * Call with interrupts disabled by arch_irq_save after checking the wake-up
+ * condition. Returns false without halting if flags had interrupts disabled;
+ * interrupts are enabled afterwards only when it returns true. */
+bool arch_irq_wait(size_t flags);
+
+/* Index of the executing CPU (0 .. n-1). Always 0 until APs are brought up. */
+uint32_t arch_cpu_index(void);
+
 /* -------------------------------------------------------------------------- */
 /* Paging Memory Type / Attribute Control (architecture-level interface)      */
 /* -------------------------------------------------------------------------- */
@@ -172,11 +187,18 @@ bool arch_mtrr_set_range(uintptr_t phys_start, size_t length, arch_paging_memtyp
 bool arch_paging_set_memtype(uintptr_t phys_start, size_t length, arch_paging_memtype_t type);
 
 /* Map a physical range to a virtual range with desired base flags + memory type.
- * If the mapping already exists, attributes are updated.
+ * If the mapping already exists, attributes are updated. Missing page-table
+ * levels are allocated on demand, so ranges above 4 GiB can be mapped (amd64).
  */
 bool arch_paging_map_with_type(uintptr_t phys_start, uintptr_t virt_start, size_t length,
                                uint64_t base_flags, arch_paging_memtype_t type);
 
+/* Remove mappings for a virtual range (large pages are split when only partly covered). */
+bool arch_paging_unmap(uintptr_t virt_start, size_t length);
+
+/* Translate a mapped virtual address to its physical address (0 if unmapped). */
+uintptr_t arch_paging_virt_to_phys(uintptr_t virt_addr);
+
 /* Query the memory type for a given virtual address (best-effort). */
 arch_paging_memtype_t arch_paging_get_memtype(uintptr_t virt_addr);
 
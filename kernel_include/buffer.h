@@ -7,10 +7,12 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <memory/objpool.h>
 
 // Buffer node structure - her node'un arkasında data_size kadar alan var
 typedef struct BufferNode {
     struct BufferNode* next;
+    ObjectPool* pool;        // Node'un geri verileceği havuz (sahibi olan Buffer'ın)
     size_t data_size;        // Bu node'da saklanan verinin boyutu
     // Buradan sonra data_size kadar alan var (flexible array member kullanımı)
     uint8_t data[];         // Gerçek veri buraya yazılır
@@ -23,6 +25,7 @@ typedef struct Buffer {
     size_t count;           // Buffer'daki eleman sayısı
     size_t total_size;      // Buffer'daki toplam veri boyutu
     size_t default_data_size; // Varsayılan veri boyutu
+    ObjectPool node_pool;   // sizeof(BufferNode) + default_data_size boyutlu node'lar
 } Buffer;
 
 // Buffer creation and destruction
@@ -47,6 +50,10 @@ int buffer_push_copy(Buffer* buffer, const void* data);
 BufferNode* buffer_pop_node(Buffer* buffer);
 void buffer_free_node(BufferNode* node);
 
+// buffer_pop'un döndürdüğü veri işaretçisinin node'unu havuza geri verir.
+// Pop edilmiş tüm node'lar buffer_destroy'dan önce serbest bırakılmalıdır.
+void buffer_free_data(void* data);
+
 // Iterator functions
 BufferNode* buffer_iterator_begin(Buffer* buffer);
 BufferNode* buffer_iterator_next(BufferNode* current);
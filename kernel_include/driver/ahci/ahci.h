@@ -61,6 +61,11 @@ typedef volatile struct {
 #define  HBA_DET_NO_DEVICE 0x0u
 #define  HBA_DET_PRESENT   0x3u // device present, Phy communication established
 
+// CAP bits
+#define HBA_CAP_S64A   (1u << 31)  // 64-bit addressing
+#define HBA_CAP_SNCQ   (1u << 30)  // Native Command Queuing
+#define HBA_CAP_NCS(x) ((((x) >> 8) & 0x1Fu) + 1u) // Number of Command Slots
+
 // PxCMD bits
 #define HBA_PxCMD_ST   (1u << 0)
 #define HBA_PxCMD_SUD  (1u << 1)  // Spin-Up Device
@@ -89,6 +94,14 @@ typedef volatile struct {
 #define HBA_SSTS_SPD(x)   (((x) >> 4) & 0x0F)
 #define HBA_SSTS_IPM(x)   (((x) >> 8) & 0x0F)
 
+// Tek PRD girdisinin taşıyabileceği en büyük bayt sayısı (dbc 22 bit)
+#define AHCI_PRD_MAX_BYTES 0x400000u
+// Komut tablosu başına PRD girdisi: tablo tam 1 KiB olur. Sayfa sayfa dağınık
+// tamponda bir komut en az 224 KiB taşır; bitişik tamponda 65536 sektörün tamamını.
+#define AHCI_PRDT_MAX      56u
+// Tek komutta ATA sektör sayısı sınırı (count alanı 0 = 65536)
+#define AHCI_MAX_SECTORS   65536u
+
 // AHCI command structures
 typedef struct {
     // DW0
@@ -122,9 +135,12 @@ typedef struct {
     uint8_t  cfis[64];   // Command FIS
     uint8_t  acmd[16];   // ATAPI command (not used for ATA)
     uint8_t  rsv[48];
-    hba_prdt_entry_t prdt[1]; // We use a single PRDT for simple transfers
+    hba_prdt_entry_t prdt[AHCI_PRDT_MAX]; // scatter-gather list
 } __attribute__((packed)) hba_cmd_table_t;
 
+// Slot başına komut tabloları tek tamponda bu aralıkla dizilir (CTBA 128B hizalı)
+#define AHCI_CMD_TABLE_STRIDE ((sizeof(hba_cmd_table_t) + 127u) & ~(size_t)127u)
+
 // FIS types and structures
 #define FIS_TYPE_REG_H2D 0x27
 
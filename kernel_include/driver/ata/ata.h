@@ -58,6 +58,13 @@ extern "C" {
 #define ATA_CMD_READ_DMA_EXT       0x25
 #define ATA_CMD_WRITE_DMA          0xCA
 #define ATA_CMD_WRITE_DMA_EXT      0x35
+#define ATA_CMD_SET_FEATURES       0xEF
+
+// SET FEATURES: aktarım kipi alt komutu; kip sector count'ta verilir
+#define ATA_FEATURE_SET_XFER_MODE  0x03
+#define ATA_XFER_MODE_MWDMA        0x20 // | n: Multiword DMA n
+#define ATA_XFER_MODE_UDMA         0x40 // | n: Ultra DMA n
+#define ATA_DMA_MODE_NONE          0x00 // DMA kullanılmaz (PIO)
 
 // PCI IDE Bus Master (BMIDE) I/O registers (BAR4)
 #define ATA_BM_REG_CMD        0x00  // Command register (per channel)
@@ -74,6 +81,8 @@ extern "C" {
 #define ATA_BM_ST_ACTIVE      0x01
 #define ATA_BM_ST_ERR         0x02
 #define ATA_BM_ST_IRQ         0x04
+#define ATA_BM_ST_DRV0_DMA    0x20  // Sürücü 0 DMA'ya hazır (yazılım/BIOS ayarlar)
+#define ATA_BM_ST_DRV1_DMA    0x40
 
 // Physical Region Descriptor (PRD) entry
 typedef struct __attribute__((packed)) {
@@ -82,6 +91,14 @@ typedef struct __attribute__((packed)) {
     uint16_t flags;      // bit15=1 -> end of table
 } ata_prd_t;
 
+// Bir DMA komutu en fazla ATA_DMA_MAX_BYTES taşır. Kanal başına PRD tablosu
+// bunu sayfa sayfa dağınık ve birden çok parçalı bir scatter listesinden de
+// karşılayacak kadar girdi içerir; sığmayan kısım sonraki komuta kalır.
+#define ATA_PRD_MAX          64
+#define ATA_DMA_MAX_BYTES    (128u * 1024u)
+#define ATA_DMA_MAX_SECTORS  (ATA_DMA_MAX_BYTES / 512u)
+#define ATA_DMA_TIMEOUT_MS   5000u
+
 // ATAPI SCSI packet opcodes
 #define ATAPI_CMD_INQUIRY          0x12
 #define ATAPI_CMD_REQUEST_SENSE    0x03
@@ -111,6 +128,7 @@ typedef struct {
     uint64_t total_sectors; // derived from IDENTIFY (LBA28 or LBA48)
     uint32_t sector_size;   // logical sector size (default 512)
     bool     lba48_supported; // IDENTIFY word 83 bit 10
+    uint8_t  dma_mode;        // SET FEATURES ile seçilen kip (ATA_XFER_MODE_*); NONE: PIO
 } ata_device_t;
 
 // Exported driver instance
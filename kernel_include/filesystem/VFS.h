@@ -11,6 +11,15 @@ extern "C" {
 #define VFS_NAME_MAX 255
 #define VFS_PATH_MAX 1024
 
+// Ardışık okumada ön okuma penceresi VFS_READAHEAD_MIN'den başlar, her tetiklenişte
+// iki katına çıkar ve VFS_READAHEAD_MAX'ta durur (bayt)
+#ifndef VFS_READAHEAD_MIN
+#define VFS_READAHEAD_MIN (16u * 1024u)
+#endif
+#ifndef VFS_READAHEAD_MAX
+#define VFS_READAHEAD_MAX (256u * 1024u)
+#endif
+
 struct VFSNode;
 struct VFSHandle;
 struct VFSFileSystem;
@@ -109,6 +118,8 @@ typedef struct VFSNodeOps {
     VFSResult (*create)(VFSNode* node, const char* name, VFSNodeType type, VFSNode** out_node);
     VFSResult (*remove)(VFSNode* node, const char* name);
     VFSResult (*stat)(VFSNode* node, VFSNodeInfo* out_info);
+    // [offset, offset + length) aralığını blok önbelleğine okumaya başlar; beklemez
+    void      (*readahead)(VFSNode* node, void* handle, uint64_t offset, uint64_t length);
 } VFSNodeOps;
 
 typedef struct VFSFileSystemOps {
@@ -134,11 +145,18 @@ struct VFSNode {
     void* internal_data; // Filesystem-private payload
 };
 
+typedef struct VFSReadAhead {
+    uint64_t next_offset; // ardışık sayılacak sonraki okumanın başı
+    uint64_t ahead_end;   // ön okuması istenmiş son bayt
+    uint32_t window;      // 0: erişim ardışık değil
+} VFSReadAhead;
+
 struct VFSHandle {
     VFSNode* node;
     void* driver_handle;
     uint32_t mode;
     uint64_t offset;
+    VFSReadAhead readahead;
 };
 
 typedef struct VFSCacheStats {
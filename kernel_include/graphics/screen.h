@@ -9,6 +9,7 @@ extern "C" {
 #include <stdbool.h>
 #include <list.h>
 #include <event/event.h>
+#include <arch.h>
 
 typedef struct {
     uint32_t mode_number;
@@ -39,6 +40,13 @@ extern Event* screen_modeChangeEvent;
 
 extern void screen_changeVideoMode(ScreenInfo* screen, ScreenVideoModeInfo* mode);
 
+/*
+    Applies the given memory type to the mode's framebuffer (pitch * height bytes).
+    PAT is tried first; if it is unavailable an MTRR range is programmed instead.
+    screen_init and screen_changeVideoMode call this with ARCH_PAGING_MT_WC.
+*/
+extern bool screen_set_framebuffer_memtype(ScreenVideoModeInfo* mode, arch_paging_memtype_t type);
+
 #ifdef __cplusplus
 }
 #endif
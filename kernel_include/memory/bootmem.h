@@ -0,0 +1,25 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Erken açılış için bump ayırıcı. Açılışta bir kez ayrılıp hiç geri verilmeyen
+// veriler (EFI bellek haritası, ACPI tablo kopyaları) heap'i parçalamasın diye
+// kernel imajındaki sabit bir arenadan sırayla kesilir. free yoktur; arena
+// dolarsa istek heap'e düşer.
+
+#define BOOTMEM_SIZE (256 * 1024)
+
+void* bootmem_alloc(size_t size, size_t align);
+
+// Arenanın ne kadarının kullanıldığı ve heap'e düşen bayt sayısı
+void bootmem_get_usage(size_t* used, size_t* spilled);
+
+#ifdef __cplusplus
+}
+#endif
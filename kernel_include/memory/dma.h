@@ -0,0 +1,68 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Depolama sürücüleri için fiziksel olarak bitişik DMA tamponları.
+// Küçük yapılar (komut listesi, FIS, PRDT) heap'ten hizalı oyulur; büyükler
+// doğrudan PMM sayfalarıdır. Her iki durumda fiziksel adres çeviriyle bulunur,
+// sürücüler artık virt == phys varsaymaz.
+
+#define DMA_ADDR_32BIT   0xFFFFFFFFull  // 32-bit bus master'lar (BMIDE, S64A'sız AHCI)
+#define DMA_ADDR_ANY     UINT64_MAX
+#define DMA_BOUNDARY_64K 0x10000u       // PRD girdileri bu sınırı geçemez
+
+#define DMA_BOUNCE_SIZE  (64 * 1024)
+#define DMA_BOUNCE_COUNT 4
+
+typedef struct DmaBuffer
+{
+    void* virt;
+    uint64_t phys;
+    size_t size;
+    // dma.c'ye ait: nereden ayrıldığı
+    uint8_t kind;
+    uint8_t order;
+    size_t pages;
+} DmaBuffer;
+
+typedef struct DmaSegment
+{
+    uint64_t phys;
+    uint32_t length;
+} DmaSegment;
+
+// Bounce havuzunu ayırır; PMM hazır olduktan sonra bir kez çağrılır.
+void dma_init(void);
+
+// size baytlık sıfırlanmış tampon. align ve boundary 2'nin kuvveti olmalıdır;
+// boundary 0 değilse tampon hiçbir boundary katını geçmez (size <= boundary).
+// Son baytın fiziksel adresi max_phys'i aşmaz.
+bool dma_alloc(DmaBuffer* buf, size_t size, size_t align, size_t boundary, uint64_t max_phys);
+void dma_free(DmaBuffer* buf);
+
+// [virt, virt + len) aralığını fiziksel olarak bitişik parçalara böler. Parçalar
+// max_segment'ten uzun olmaz ve boundary katlarını geçmez. Aralığın bir kısmı
+// eşlenmemişse, max_phys'i aşıyorsa ya da max_out yetmezse 0 döner.
+size_t dma_map_segments(const void* virt, size_t len, size_t boundary, size_t max_segment,
+                        uint64_t max_phys, DmaSegment* out, size_t max_out);
+
+// dma_map_segments gibi, ama aralığın eşlenebilen başını verir: eşlenmemiş ya da
+// max_phys üstü bir sayfada veya out dolunca durur, *mapped'e kapsanan baytı yazar.
+size_t dma_map_partial(const void* virt, size_t len, size_t boundary, size_t max_segment,
+                       uint64_t max_phys, DmaSegment* out, size_t max_out, size_t* mapped);
+
+// 32-bit adreslenebilir, 64 KiB hizalı DMA_BOUNCE_SIZE'lık önceden ayrılmış
+// tampon. Doğrudan eşlenemeyen kullanıcı tamponları için; havuz boşsa false.
+// Kesme bağlamından da çağrılabilir.
+bool dma_bounce_acquire(DmaBuffer* buf);
+void dma_bounce_release(DmaBuffer* buf);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,36 @@ typedef struct HeapRegion
     struct HeapRegion* next;
 } HeapRegion;
 
+typedef struct HeapStats
+{
+    size_t bytes_in_use;        // Tahsisli first-fit blokların toplamı (slab sayfaları dahil)
+    size_t bytes_free;
+    size_t largest_free_block;
+    size_t node_count;          // Tüm bölgelerdeki blok sayısı
+    size_t free_node_count;
+    size_t region_count;
+    size_t expanded_regions;    // heap_alloc'un genişleme yolunun eklediği bölgeler
+    size_t slab_bytes_in_use;   // Slab sınıflarında canlı nesnelerin toplamı
+    size_t large_blocks;        // Doğrudan PMM sayfalarından verilmiş büyük bloklar
+    size_t large_bytes;         // Bu blokların kapladığı sayfa baytları
+} HeapStats;
+
+// HEAP_TRACE_CALLSITES ile derlendiğinde her blok onu ayıran çağrı noktasını taşır
+// (bu modda slab devre dışıdır). make HEAP_TRACE=1 ile açılır.
+typedef struct HeapCallSite
+{
+    void* site;
+    size_t live_blocks;
+    size_t live_bytes;
+    size_t total_allocs;
+} HeapCallSite;
+
+#ifdef HEAP_TRACE_CALLSITES
+#define HEAP_CALLER() __builtin_return_address(0)
+#else
+#define HEAP_CALLER() NULL
+#endif
+
 void heap_init();
 
 void* heap_alloc(size_t size);
@@ -23,6 +53,24 @@ void* heap_realloc(void* ptr, size_t size);
 void* heap_calloc(size_t count, size_t size);
 void* heap_aligned_alloc(size_t alignment, size_t size);
 
+// site: çağrı noktası etiketi (malloc ve benzerleri HEAP_CALLER() geçirir)
+void* heap_alloc_from(size_t size, void* site);
+void* heap_realloc_from(void* ptr, size_t size, void* site);
+void* heap_calloc_from(size_t count, size_t size, void* site);
+void* heap_aligned_alloc_from(size_t alignment, size_t size, void* site);
+
+// Bölgeleri gezerek anlık görüntü alır. Bir alloc/free sürerken (ör. kesme
+// bağlamından) çağrılırsa false döner.
+bool heap_get_stats(HeapStats* stats);
+
+// live_bytes'a göre en büyük max çağrı noktası; izleme kapalıysa 0.
+size_t heap_get_callsites(HeapCallSite* out, size_t max);
+
+void heap_dump_stats(void);
+
+// heap_dump_stats'ı interval_ms'de bir çalıştıran periyodik görevi başlatır.
+void heap_stats_dump_start(size_t interval_ms);
+
 #ifdef __cplusplus
 }
 #endif
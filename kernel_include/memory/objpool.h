@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sabit boyutlu nesne havuzu. Nesneler chunk'lar halinde heap'ten alınır ve
+// boş listeye dizilir; alloc/free bu listeden O(1) çalışır. Chunk'lar yalnızca
+// object_pool_destroy ile geri verilir. Kesme bağlamından da çağrılabilir.
+
+struct ObjectPoolChunk;
+
+typedef struct ObjectPool
+{
+    const char* name;
+    size_t object_size;             // Hizalanmış nesne boyutu
+    size_t grow_count;              // İlk ayırma ve her büyümede eklenen nesne sayısı
+    bool growable;                  // false: grow_count dolunca alloc NULL döner
+    bool initialized;
+    void* free_list;
+    struct ObjectPoolChunk* chunks;
+    size_t total_objects;
+    size_t in_use;
+} ObjectPool;
+
+// Statik havuz tanımı; ilk alloc'ta grow_count kadar nesne ayrılır.
+//   static ObjectPool node_pool = OBJECT_POOL_STATIC(ListNode, 64, true);
+#define OBJECT_POOL_STATIC(type, count, grow) \
+    { #type, sizeof(type), (count), (grow), false, NULL, NULL, 0, 0 }
+
+// Tipli yardımcı: OBJECT_POOL_NEW(&node_pool, ListNode)
+#define OBJECT_POOL_NEW(pool, type) ((type*)object_pool_alloc(pool))
+
+// Havuzu kurar ve initial_count nesneyi önceden ayırır (0 ise ilk alloc'a kadar bekler).
+bool object_pool_init(ObjectPool* pool, const char* name, size_t object_size, size_t initial_count, bool growable);
+
+// Tüm chunk'ları heap'e geri verir. Havuzdan alınmış nesneler geçersiz olur.
+void object_pool_destroy(ObjectPool* pool);
+
+// En az count boş nesne olacak şekilde havuzu büyütür (growable olmasa da).
+bool object_pool_reserve(ObjectPool* pool, size_t count);
+
+void* object_pool_alloc(ObjectPool* pool);
+void object_pool_free(ObjectPool* pool, void* obj);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,15 +32,57 @@ typedef struct MemoryRegion {
     MemoryRegionType type; // Type of the memory region
 } MemoryRegion;
 
-// Ard arda gelen USABLE blokları birleştir 
+#define PMM_PAGE_SIZE 4096
+#define PMM_MAX_ORDER 18 // En büyük buddy bloğu: 2^18 sayfa = 1 GiB
+
+typedef struct PmmStats {
+    size_t total_pages;                     // Buddy'ye verilmiş toplam sayfa
+    size_t free_pages;                      // Şu an boş olan sayfa
+    size_t cached_pages;                    // Per-CPU önbelleklerde bekleyen sayfa
+    size_t free_blocks[PMM_MAX_ORDER + 1];  // Order başına boş blok sayısı
+} PmmStats;
+
+// Ard arda gelen USABLE blokları birleştir (yalnızca bellek haritası listesi)
 void pmm_maintain();
 
-// Fiziksel bellekten blok tahsis et
+// Fiziksel bellekten blok tahsis et (2^order sayfaya yuvarlanır)
 void* pmm_alloc(size_t sizeInKB);
 
 // Fiziksel bellekteki bloğu serbest bırak
 void pmm_free(void* ptr);
 
+// 2^order adet ardışık, 2^order sayfaya hizalı fiziksel sayfa
+void* pmm_alloc_pages(uint32_t order);
+void pmm_free_pages(void* ptr, uint32_t order);
+
+// Tam olarak pages sayfa; 2'nin kuvvetine yuvarlanan bloğun artan kuyruğu buddy'ye
+// geri verilir. Blok yine 2^ceil(log2(pages)) sayfaya hizalıdır.
+void* pmm_alloc_pages_exact(size_t pages);
+void pmm_free_pages_exact(void* ptr, size_t pages);
+
+// Global buddy kilidini tek kez alarak birden çok blok al/ver
+size_t pmm_alloc_pages_bulk(uint32_t order, void** out, size_t count);
+void pmm_free_pages_bulk(uint32_t order, void* const* pages, size_t count);
+
+// Per-CPU sayfa önbelleği (magazine). PMM_PCP_MAX_ORDER'a kadar olan bloklar
+// global buddy'ye uğramadan yerel CPU'nun magazine'inden verilir.
+#define PMM_PCP_MAX_ORDER 3
+
+void* pmm_pcp_alloc(uint32_t order);
+void pmm_pcp_free(void* ptr, uint32_t order);
+void pmm_pcp_drain(uint32_t cpu);
+void pmm_pcp_drain_all(void);
+size_t pmm_pcp_cached_pages(void);
+
+// Sonradan kullanılabilir hale gelen aralığı buddy'ye ekle (ör. ExitBootServices sonrası)
+void pmm_add_free_range(size_t base, size_t size);
+
+// type türündeki tüm bölgeleri USABLE yapıp buddy'ye verir; kazanılan bayt sayısını döner.
+// Bölgedeki veriye artık ihtiyaç kalmadığında çağrılır (EFI boot services, ACPI kopyası).
+size_t pmm_reclaim_regions(MemoryRegionType type);
+
+void pmm_get_stats(PmmStats* stats);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Küçük nesneler için boyut sınıflı (size-class) slab katmanı.
+// heap_alloc, SLAB_MAX_SIZE ve altındaki istekleri buraya yönlendirir;
+// daha büyük bloklar first-fit yolunda kalır.
+#define SLAB_MIN_SIZE 16
+#define SLAB_MAX_SIZE 2048
+
+void* slab_alloc(size_t size);
+
+// ptr bir slab nesnesine aitse serbest bırakır ve true döner.
+bool slab_free(void* ptr);
+
+// ptr bir slab nesnesinin başıysa nesnenin boyutu, değilse 0.
+size_t slab_object_size(const void* ptr);
+
+// Slab sınıflarındaki canlı nesnelerin toplam boyutu.
+size_t slab_bytes_in_use(void);
+
+// Benchmark ve hata ayıklama için: kapatıldığında yeni istekler first-fit'e gider,
+// mevcut slab nesneleri yine doğru şekilde serbest bırakılır.
+void slab_set_enabled(bool enabled);
+bool slab_is_enabled(void);
+
+#ifdef __cplusplus
+}
+#endif
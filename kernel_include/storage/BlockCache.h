@@ -0,0 +1,91 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <storage/BlockDevice.h>
+
+// Tüm blok aygıtlarının ortak blok önbelleği. Girdiler (aygıt, LBA) ile
+// hash tablosunda bulunur; bütçe dolunca CLOCK (ikinci şans) ile çıkarılır.
+// BlockDevice_Read/Write buradan geçer; dosya sistemleri ayrıca bir şey yapmaz.
+// Yazmalar önbellekte kirli kalır (write-back); periyodik bir flusher bitişik kirli
+// blokları birleştirip yazar. BlockDevice_Flush önce BlockCache_Sync çağırır.
+// Görev bağlamından çağrılır.
+
+#ifndef BLOCK_CACHE_DEFAULT_BUDGET
+#define BLOCK_CACHE_DEFAULT_BUDGET (4u * 1024u * 1024u)
+#endif
+
+// Kirli veri bu sınırı (ve bütçenin yarısını) aşınca yazan, hepsi diske inene kadar
+// bekler. 0 ile derlenirse önbellek write-through çalışır.
+#ifndef BLOCK_CACHE_DEFAULT_DIRTY_LIMIT
+#define BLOCK_CACHE_DEFAULT_DIRTY_LIMIT (1024u * 1024u)
+#endif
+
+// Flusher bu aralıkla çalışır; kirli bir blok en fazla bu kadar bekler
+#ifndef BLOCK_CACHE_DEFAULT_FLUSH_MS
+#define BLOCK_CACHE_DEFAULT_FLUSH_MS 1000u
+#endif
+
+// Bundan büyük okumalar/yazmalar önbelleği doldurmaz (akış okumaları metaveriyi
+// dışarı atmasın); yalnızca önbellekteki kopyalar güncel tutulur.
+#define BLOCK_CACHE_BYPASS_BYTES (64u * 1024u)
+
+typedef struct BlockCacheStats {
+    uint64_t hits;       // önbellekten verilen bloklar
+    uint64_t misses;     // aygıttan okunup önbelleğe alınan bloklar
+    uint64_t prefetched; // ön okumayla istenen bloklar (sonraki isabetler hits'e sayılır)
+    uint64_t bypassed;   // BLOCK_CACHE_BYPASS_BYTES'ı aşan isteklerdeki bloklar
+    uint64_t evictions;
+    uint64_t written_back;       // geri yazılan bloklar
+    uint64_t writeback_requests; // written_back / writeback_requests: birleştirme oranı
+    uint64_t throttled;          // kirli sınırında bekletilen yazmalar
+    uint64_t write_errors;       // geri yazılamayan bloklar
+    size_t entries;
+    size_t bytes;        // girdiler ve verileri dahil kullanılan bellek
+    size_t dirty;        // aygıta yazılmamış veri baytı
+    size_t budget;
+    size_t dirty_limit;  // etkin sınır (bütçenin yarısıyla kırpılmış)
+    uint32_t flush_interval_ms;
+} BlockCacheStats;
+
+// Kirli veri sınırı ve flusher aralığı. dirty_limit 0 ise tüm kirli bloklar yazılır
+// ve önbellek write-through'a döner; flush_interval_ms 0 ise varsayılan kullanılır.
+void BlockCache_SetWriteBack(size_t dirty_limit, uint32_t flush_interval_ms);
+
+// dev'in (NULL: tüm aygıtlar) kirli bloklarını yazar ve bitmelerini bekler. Son
+// çağrıdan beri bir geri yazma başarısız olduysa false.
+bool BlockCache_Sync(BlockDevice* dev);
+
+// Bütçeyi değiştirir; küçülürse fazlası hemen çıkarılır. 0 önbelleği kapatır.
+void BlockCache_SetBudget(size_t bytes);
+size_t BlockCache_GetBudget(void);
+
+bool BlockCache_Read(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer);
+bool BlockCache_Write(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer);
+
+// lba'dan itibaren offset baytı atlayıp len bayt okur; blok sınırını geçebilir.
+// FAT girdisi gibi küçük metaveri okumaları için tam blok tamponu gerektirmez.
+bool BlockCache_ReadBytes(BlockDevice* dev, uint64_t lba, uint64_t offset, void* out, size_t len);
+
+// [lba, lba + count) içinde önbellekte olmayan blokları okumaya başlar ve hemen
+// döner (sürücüde submit yoksa istek eşzamanlı çalışır). Okuması süren bloğa
+// gelen okuma tamamlanmasını bekler. Bütçenin dörtte birinden fazlasını istemez.
+void BlockCache_Prefetch(BlockDevice* dev, uint64_t lba, uint32_t count);
+
+// Önbelleği atlayan yazmalardan (BlockDevice_Submit) ve ortam değişiminden sonra.
+// Aralıktaki kirli bloklar yazılmadan atılır.
+void BlockCache_Invalidate(BlockDevice* dev, uint64_t lba, uint64_t count);
+void BlockCache_InvalidateDevice(BlockDevice* dev);
+
+void BlockCache_GetStats(BlockCacheStats* out);
+void BlockCache_DumpStats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,11 +15,64 @@ typedef enum {
 } BlockDeviceType;
 
 struct BlockDevice;
+struct BlockRequest;
+struct BlockQueue;
+
+typedef enum {
+    BLKREQ_READ = 0,
+    BLKREQ_WRITE = 1
+} BlockRequestOp;
+
+typedef enum {
+    BLKREQ_STATUS_PENDING = 0,
+    BLKREQ_STATUS_OK = 1,
+    BLKREQ_STATUS_ERROR = 2
+} BlockRequestStatus;
+
+// Scatter listesindeki bir parça; length blok boyutunun katıdır
+typedef struct BlockSegment {
+    void* buffer;
+    uint32_t length;
+} BlockSegment;
+
+// Tamamlanınca çağrılır; kesme bağlamında ve kesmeler kapalıyken gelebilir
+typedef void (*BlockRequestCallback)(struct BlockRequest* req);
+
+// Asenkron blok isteği. Çağıran tamamlanana kadar isteği (ve tamponları) canlı tutar.
+typedef struct BlockRequest {
+    BlockRequestOp op;
+    uint64_t lba;
+    uint32_t count;                 // logical blocks
+    BlockSegment* segments;         // toplam uzunluk count * logical_block_size
+    uint32_t segment_count;
+    BlockRequestCallback callback;  // NULL olabilir
+    void* callback_arg;
+    volatile BlockRequestStatus status;
+
+    // BlockDevice_Submit ve sürücüye ait
+    struct BlockDevice* device;
+    struct BlockRequest* next;      // sürücü kuyruğu
+    uint32_t issued;                // donanıma verilmiş blok sayısı
+    uint32_t inflight;              // tamamlanmamış komut sayısı
+    uint32_t driver_flags;
+    bool error;
+    BlockSegment single;            // BlockRequest_Init'in tek parçalık listesi
+
+    // BlockQueue'ya ait
+    struct BlockRequest* sched_next; // sıralı kuyruk; birleşik istekte parçaların listesi
+    uint64_t deadline;               // uptimeMs; geçince sırası beklenmeden verilir
+    uint32_t sched_seq;              // geliş sırası; çakışan istekler bu sırayla verilir
+    uint32_t sched_flags;
+} BlockRequest;
 
 typedef struct BlockDeviceOps {
     bool (*read)(struct BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer);
     bool (*write)(struct BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer);
     bool (*flush)(struct BlockDevice* dev);
+    // İsteği kuyruğa alır; false dönerse istek kabul edilmemiştir ve callback çağrılmaz
+    bool (*submit)(struct BlockDevice* dev, BlockRequest* req);
+    // Biten istekleri toplar; kesmesiz tamamlanan sürücüler için beklerken çağrılır
+    void (*poll)(struct BlockDevice* dev);
 } BlockDeviceOps;
 
 typedef struct BlockDevice {
@@ -29,6 +82,14 @@ typedef struct BlockDevice {
     uint64_t total_blocks;       // total logical blocks
     const BlockDeviceOps* ops;   // function table
     void* driver_ctx;            // driver-private context
+    bool irq_completion;         // İstekler kesmeyle tamamlanır; bekleyenler yoklamak yerine hlt ile uyur
+    bool async_submit;           // submit aktarımı beklemeden döner; kesme bağlamından istek verilebilir
+
+    // Sürücü sınırları; BlockQueue birleştirirken aşmaz. Kayıttan sonra sürücü kurar.
+    uint32_t max_transfer_blocks; // bir komutun taşıdığı en fazla blok (0: sınır yok)
+    uint16_t max_segments;        // bir komutun scatter listesi (0: sınır yok)
+    uint16_t queue_depth;         // sürücüye aynı anda verilen istek sayısı (varsayılan 1)
+    struct BlockQueue* queue;     // submit'i olan aygıtlarda istek zamanlayıcısı
 } BlockDevice;
 
 // Registry API
@@ -43,11 +104,38 @@ BlockDevice* BlockDevice_Register(const char* name,
 size_t BlockDevice_Count(void);
 BlockDevice* BlockDevice_GetAt(size_t index);
 
-// Convenience shims
+// Convenience shims; okuma ve yazmalar ortak blok önbelleğinden geçer (BlockCache.h)
 bool BlockDevice_Read(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer);
 bool BlockDevice_Write(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer);
+// Önbelleği atlayarak doğrudan ops->read/write
+bool BlockDevice_ReadDirect(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer);
+bool BlockDevice_WriteDirect(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer);
+// Önbellekteki kirli blokları ve aygıtın yazma önbelleğini diske indirir
 bool BlockDevice_Flush(BlockDevice* dev);
 
+// ---- Asynchronous requests ----
+// Tek tamponlu istek kurar (segments = &req->single); tampon boyu dev'in blok boyundan
+void BlockRequest_Init(BlockRequest* req, BlockDevice* dev, BlockRequestOp op, uint64_t lba, uint32_t count, void* buffer);
+
+// block'uncu bloğun tampondaki adresi; contiguous o parçada kalan blok sayısı
+void* BlockRequest_BufferAt(const BlockRequest* req, uint32_t block, uint32_t* contiguous);
+
+// Sürücüler bitirdiğinde çağırır: durumu yazar ve callback'i çalıştırır
+void BlockRequest_Complete(BlockRequest* req, bool ok);
+
+// submit'i olmayan sürücülerde istek read/write ile hemen tamamlanır; olanlarda
+// BlockQueue'ya girer, sürücünün reddettiği istek hatayla tamamlanır.
+// İstekler önbelleği atlar; submit ile yazan BlockCache_Invalidate çağırmalıdır.
+bool BlockDevice_Submit(BlockDevice* dev, BlockRequest* req);
+// İstek bitene kadar bekler (gerekirse ops->poll ile); irq_completion aygıtlarda
+// kesmeler arasında uyur. Sonuç status == OK
+bool BlockDevice_Wait(BlockDevice* dev, BlockRequest* req);
+void BlockDevice_Poll(BlockDevice* dev);
+
+// submit üzerinden çalışan senkron read/write; sürücüler ops tablosunda kullanır
+bool BlockDevice_SyncRead(BlockDevice* dev, uint64_t lba, uint32_t count, void* buffer);
+bool BlockDevice_SyncWrite(BlockDevice* dev, uint64_t lba, uint32_t count, const void* buffer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <storage/BlockDevice.h>
+
+// Aygıt başına istek zamanlayıcısı. submit'i olan aygıtlarda BlockDevice_Submit
+// istekleri burada LBA'ya göre sıralı bekletir ve sürücüye en fazla
+// dev->queue_depth tanesini verir. Sıra tek yönlü asansördür (C-SCAN); süresi
+// dolan istek sırası beklenmeden verilir. Verilirken arkasındaki bitişik ve aynı
+// yöndeki istekler sürücü sınırlarını aşmadan tek isteğe birleştirilir.
+// Çakışan isteklerden (biri yazma) önce gelen önce verilir.
+// Kesme bağlamından da çağrılabilir; bellek ayırmaz.
+
+#define BLOCK_QUEUE_READ_EXPIRE_MS  50u
+#define BLOCK_QUEUE_WRITE_EXPIRE_MS 500u
+
+#define BLOCK_QUEUE_MERGE_SLOTS    8u  // aynı anda sürücüde olabilecek birleşik istek
+#define BLOCK_QUEUE_MERGE_SEGMENTS 64u // birleşik isteğin scatter listesi
+
+typedef struct BlockQueueStats {
+    uint64_t submitted;
+    uint64_t dispatched;  // sürücüye verilen istekler (birleşikler bir sayılır)
+    uint64_t merged;      // başka bir isteğe katılarak verilen istekler
+    uint64_t expired;     // süresi dolduğu için sırası beklenmeden verilenler
+    uint32_t queued;      // zamanlayıcıda bekleyen
+    uint32_t inflight;    // sürücüde
+    uint32_t max_depth;   // queued + inflight'ın gördüğü en yüksek değer
+} BlockQueueStats;
+
+// BlockDevice_Register çağırır; submit'i olmayan aygıtların kuyruğu yoktur
+bool BlockQueue_Attach(BlockDevice* dev);
+
+// BlockDevice_Submit doğruladıktan sonra çağırır; istek sonra sürücüye verilir
+void BlockQueue_Submit(BlockDevice* dev, BlockRequest* req);
+
+// BlockRequest_Complete çağırır: zamanlayıcının verdiği isteği bitirir (birleşikse
+// parçalarını tamamlar) ve kuyruğu ilerletir. İstek kuyruktan gelmediyse false.
+bool BlockQueue_Complete(BlockRequest* req);
+
+// Tıkaç tüm kuyruklar içindir: açılana kadar istekler bekletilir, art arda
+// gönderilenler sıralanıp birleşebilir. İç içe çağrılabilir. Tıkaçlı bölgede
+// beklenen istek BlockDevice_Wait'te BlockQueue_Run ile yine de verilir.
+void BlockQueue_Plug(void);
+void BlockQueue_Unplug(void);
+
+// Tıkaca bakmadan dev'in bekleyen isteklerini sürücüye verir
+void BlockQueue_Run(BlockDevice* dev);
+
+// Kuyruk ve sürücüdeki tüm istekler bitene kadar bekler (görev bağlamı)
+void BlockQueue_Drain(BlockDevice* dev);
+
+bool BlockQueue_GetStats(BlockDevice* dev, BlockQueueStats* out);
+void BlockQueue_DumpStats(BlockDevice* dev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -51,6 +51,12 @@ else
     CFLAGS_64 += -O2 -DNDEBUG
 endif
 
+# Heap çağrı noktası izleme (heap_get_callsites / heap_dump_stats)
+ifdef HEAP_TRACE
+	CFLAGS_32 += -DHEAP_TRACE_CALLSITES
+	CFLAGS_64 += -DHEAP_TRACE_CALLSITES
+endif
+
 # Toolchain verification
 define verify_toolchain
 	@echo "Verifying cross-compilation toolchain..."
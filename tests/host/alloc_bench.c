@@ -0,0 +1,274 @@
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory/heap.h>
+#include <memory/pmm.h>
+#include <list.h>
+
+// Çekirdek ayırıcılarının host üzerinde ölçümü. Her senaryo işlem sayısını ve
+// saniyedeki işlem sayısını, heap senaryoları ayrıca parçalanmayı raporlar:
+//   frag = 1 - en büyük boş blok / toplam boş bayt (0: tek parça)
+
+#define BENCH_PHYS_MB 256
+
+typedef struct BenchResult
+{
+    const char* name;
+    size_t ops;
+    double seconds;
+} BenchResult;
+
+static void bench_report(const BenchResult* r, const char* extra)
+{
+    double rate = r->seconds > 0 ? (double)r->ops / r->seconds : 0;
+    printf("%-22s %10zu ops %8.3f s %10.2f Mops/s  %s\n",
+           r->name, r->ops, r->seconds, rate / 1e6, extra ? extra : "");
+}
+
+static double heap_fragmentation(const HeapStats* st)
+{
+    if (st->bytes_free == 0) return 0;
+    return 1.0 - (double)st->largest_free_block / (double)st->bytes_free;
+}
+
+static void heap_extra(char* buf, size_t len)
+{
+    HeapStats st;
+    if (!heap_get_stats(&st)) { snprintf(buf, len, "stats busy"); return; }
+    snprintf(buf, len, "in_use %zu KiB free %zu KiB frag %.3f regions %zu large %zu",
+             st.bytes_in_use / 1024, st.bytes_free / 1024, heap_fragmentation(&st),
+             st.region_count, st.large_blocks);
+}
+
+// Sabit boyutlu nesnelerin sürekli alınıp verilmesi (ListNode, BufferNode...)
+static void bench_fixed_churn(void)
+{
+    enum { LIVE = 1024, OPS = 4000000 };
+    void** live = calloc(LIVE, sizeof(void*));
+    uint32_t seed = 0x1234u;
+
+    double start = host_now();
+    for (size_t op = 0; op < OPS; op++)
+    {
+        size_t slot = host_rand(&seed) % LIVE;
+        if (live[slot]) heap_free(live[slot]);
+        live[slot] = heap_alloc(64);
+    }
+    BenchResult r = { "fixed-64 churn", OPS, host_now() - start };
+
+    char extra[128];
+    heap_extra(extra, sizeof(extra));
+    for (size_t i = 0; i < LIVE; i++) heap_free(live[i]);
+    free(live);
+    bench_report(&r, extra);
+}
+
+static size_t mixed_size(uint32_t r)
+{
+    uint32_t pick = r % 100;
+    if (pick < 70) return 16 + (r >> 8) % 241;        // küçük nesneler
+    if (pick < 95) return 256 + (r >> 8) % 3841;      // tamponlar
+    return 4096 + (r >> 8) % (124 * 1024);            // büyük bloklar (PMM yolu dahil)
+}
+
+static void bench_mixed(void)
+{
+    enum { LIVE = 4096, OPS = 1000000 };
+    void** live = calloc(LIVE, sizeof(void*));
+    uint32_t seed = 0xBEEFu;
+
+    double start = host_now();
+    for (size_t op = 0; op < OPS; op++)
+    {
+        uint32_t r = host_rand(&seed);
+        size_t slot = r % LIVE;
+        if (live[slot]) heap_free(live[slot]);
+        live[slot] = heap_alloc(mixed_size(host_rand(&seed)));
+    }
+    BenchResult r = { "mixed sizes", OPS, host_now() - start };
+
+    char extra[128];
+    heap_extra(extra, sizeof(extra));
+    for (size_t i = 0; i < LIVE; i++) heap_free(live[i]);
+    free(live);
+    bench_report(&r, extra);
+}
+
+// Vektör benzeri büyüme; arada küçük ayırmalar komşu bloğu kapatır
+static void bench_realloc_growth(void)
+{
+    enum { BUFFERS = 64, LIMIT = 1024 * 1024 };
+    void* bufs[BUFFERS] = { 0 };
+    size_t sizes[BUFFERS] = { 0 };
+    void* noise[BUFFERS] = { 0 };
+    size_t ops = 0, moved = 0;
+    uint32_t seed = 0xC0FFEEu;
+
+    double start = host_now();
+    for (int round = 0; round < 8; round++)
+    {
+        for (size_t i = 0; i < BUFFERS; i++) { sizes[i] = 16; bufs[i] = heap_alloc(16); }
+
+        bool growing = true;
+        while (growing)
+        {
+            growing = false;
+            for (size_t i = 0; i < BUFFERS; i++)
+            {
+                if (sizes[i] >= LIMIT) continue;
+                growing = true;
+                size_t next = sizes[i] + sizes[i] / 2 + 16;
+                void* p = heap_realloc(bufs[i], next);
+                if (p != bufs[i]) moved++;
+                bufs[i] = p;
+                sizes[i] = next;
+                ops++;
+
+                size_t n = host_rand(&seed) % BUFFERS;
+                if (noise[n]) heap_free(noise[n]);
+                noise[n] = heap_alloc(32 + host_rand(&seed) % 224);
+            }
+        }
+        for (size_t i = 0; i < BUFFERS; i++) heap_free(bufs[i]);
+    }
+    BenchResult r = { "realloc growth", ops, host_now() - start };
+
+    char extra[160];
+    snprintf(extra, sizeof(extra), "moved %.1f%%", ops ? 100.0 * (double)moved / (double)ops : 0);
+    for (size_t i = 0; i < BUFFERS; i++) heap_free(noise[i]);
+    bench_report(&r, extra);
+}
+
+// Çok sayıda küçük blok, rastgele yarısını bırak, sonra daha büyük istekler:
+// boşlukların ne kadarının tekrar kullanılabildiğini ölçer
+static void bench_fragmentation_replay(void)
+{
+    enum { SMALL = 40000, BIG = 4000 };
+    void** small = calloc(SMALL, sizeof(void*));
+    void** big = calloc(BIG, sizeof(void*));
+    uint32_t seed = 0xF00Du;
+    HeapStats before, holes, after;
+
+    heap_get_stats(&before);
+    double start = host_now();
+    for (size_t i = 0; i < SMALL; i++) small[i] = heap_alloc(16 + host_rand(&seed) % 2033);
+    for (size_t i = 0; i < SMALL; i++)
+    {
+        if (host_rand(&seed) & 1) { heap_free(small[i]); small[i] = NULL; }
+    }
+    heap_get_stats(&holes);
+    for (size_t i = 0; i < BIG; i++) big[i] = heap_alloc(2048 + host_rand(&seed) % 6145);
+    BenchResult r = { "fragmentation replay", SMALL + SMALL / 2 + BIG, host_now() - start };
+    heap_get_stats(&after);
+
+    char extra[200];
+    snprintf(extra, sizeof(extra), "holes frag %.3f (%zu free nodes) -> after big %.3f, regions +%zu",
+             heap_fragmentation(&holes), holes.free_node_count, heap_fragmentation(&after),
+             after.region_count - before.region_count);
+
+    for (size_t i = 0; i < SMALL; i++) if (small[i]) heap_free(small[i]);
+    for (size_t i = 0; i < BIG; i++) heap_free(big[i]);
+    free(small);
+    free(big);
+    bench_report(&r, extra);
+}
+
+// PMM: 64 KiB ve üstü bloklarda duran boş sayfa oranı
+static double pmm_fragmentation(void)
+{
+    PmmStats st;
+    pmm_get_stats(&st);
+    if (st.free_pages == 0) return 0;
+    size_t high = 0;
+    for (uint32_t order = 4; order <= PMM_MAX_ORDER; order++)
+        high += st.free_blocks[order] << order;
+    return 1.0 - (double)high / (double)st.free_pages;
+}
+
+static void bench_pmm(void)
+{
+    enum { LIVE = 2048, OPS = 2000000 };
+    void** live = calloc(LIVE, sizeof(void*));
+    uint32_t* orders = calloc(LIVE, sizeof(uint32_t));
+    uint32_t seed = 0xABCDu;
+    char extra[128];
+
+    double start = host_now();
+    for (size_t op = 0; op < OPS; op++)
+    {
+        size_t slot = host_rand(&seed) % LIVE;
+        if (live[slot]) pmm_pcp_free(live[slot], 0);
+        live[slot] = pmm_pcp_alloc(0);
+    }
+    BenchResult r = { "pmm order-0 (pcp)", OPS, host_now() - start };
+    for (size_t i = 0; i < LIVE; i++) if (live[i]) { pmm_pcp_free(live[i], 0); live[i] = NULL; }
+    bench_report(&r, NULL);
+
+    start = host_now();
+    for (size_t op = 0; op < OPS / 4; op++)
+    {
+        uint32_t rnd = host_rand(&seed);
+        size_t slot = rnd % LIVE;
+        if (live[slot]) pmm_free_pages(live[slot], orders[slot]);
+        orders[slot] = (rnd >> 16) % 6;
+        live[slot] = pmm_alloc_pages(orders[slot]);
+    }
+    r = (BenchResult){ "pmm orders 0-5", OPS / 4, host_now() - start };
+    snprintf(extra, sizeof(extra), "frag(<64K) %.3f", pmm_fragmentation());
+    for (size_t i = 0; i < LIVE; i++) if (live[i]) { pmm_free_pages(live[i], orders[i]); live[i] = NULL; }
+    bench_report(&r, extra);
+
+    start = host_now();
+    for (size_t op = 0; op < OPS / 4; op++)
+    {
+        uint32_t rnd = host_rand(&seed);
+        size_t slot = rnd % LIVE;
+        if (live[slot]) pmm_free_pages_exact(live[slot], orders[slot]);
+        orders[slot] = 1 + (rnd >> 16) % 40;
+        live[slot] = pmm_alloc_pages_exact(orders[slot]);
+    }
+    r = (BenchResult){ "pmm exact 1-40 pages", OPS / 4, host_now() - start };
+    snprintf(extra, sizeof(extra), "frag(<64K) %.3f", pmm_fragmentation());
+    for (size_t i = 0; i < LIVE; i++) if (live[i]) pmm_free_pages_exact(live[i], orders[i]);
+    pmm_pcp_drain_all();
+    bench_report(&r, extra);
+
+    free(live);
+    free(orders);
+}
+
+static void bench_list(void)
+{
+    enum { OPS = 2000000, DEPTH = 256 };
+    List* list = List_Create();
+    uint32_t seed = 0x5151u;
+
+    double start = host_now();
+    for (size_t op = 0; op < OPS; op++)
+    {
+        if (List_Size(list) < DEPTH || (host_rand(&seed) & 1))
+            List_Add(list, (void*)(uintptr_t)(op + 1));
+        else
+            List_RemoveAt(list, 0);
+    }
+    BenchResult r = { "list add/remove", OPS, host_now() - start };
+    List_Destroy(list, false);
+    bench_report(&r, NULL);
+}
+
+int main(void)
+{
+    if (!host_shim_init(BENCH_PHYS_MB, false)) return 1;
+
+    printf("AtomOS allocator benchmarks (host, %d MiB physical)\n", BENCH_PHYS_MB);
+    bench_fixed_churn();
+    bench_mixed();
+    bench_realloc_growth();
+    bench_fragmentation_replay();
+    bench_pmm();
+    bench_list();
+    return 0;
+}
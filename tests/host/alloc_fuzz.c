@@ -0,0 +1,380 @@
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <memory/heap.h>
+#include <memory/pmm.h>
+#include <list.h>
+
+// Çekirdek ayırıcılarına rastgele işlem dizileri uygular ve her adımda
+// değişmezleri kontrol eder. Canlı her blok kimliğinden türetilen bir desenle
+// doldurulur; başka bir blokla çakışma ya da bozulma deseni bozar.
+//   alloc_fuzz [iterasyon] [seed]
+
+#define FUZZ_PHYS_MB 128
+#define FUZZ_SLOTS 2048
+
+static uint32_t fuzz_seed;
+static size_t fuzz_failures = 0;
+
+#define FUZZ_CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fputc('\n', stderr); \
+            if (++fuzz_failures >= 10) exit(1); \
+        } \
+    } while (0)
+
+static inline uint8_t fuzz_pattern(uint32_t tag, size_t i)
+{
+    return (uint8_t)(tag * 31u + i * 7u + (i >> 8));
+}
+
+static void fuzz_fill(void* p, size_t len, uint32_t tag)
+{
+    uint8_t* b = (uint8_t*)p;
+    for (size_t i = 0; i < len; i++) b[i] = fuzz_pattern(tag, i);
+}
+
+static bool fuzz_verify(const void* p, size_t len, uint32_t tag)
+{
+    const uint8_t* b = (const uint8_t*)p;
+    for (size_t i = 0; i < len; i++)
+        if (b[i] != fuzz_pattern(tag, i)) return false;
+    return true;
+}
+
+typedef struct HeapSlot
+{
+    void* ptr;
+    size_t size;
+    size_t align;   // 0: heap_alloc/realloc/calloc
+    uint32_t tag;
+} HeapSlot;
+
+static size_t fuzz_heap_size(uint32_t r)
+{
+    switch (r % 8)
+    {
+        case 0: return 1 + (r >> 8) % 16;
+        case 1: case 2: case 3: return 16 + (r >> 8) % 497;
+        case 4: case 5: return 512 + (r >> 8) % 7681;
+        case 6: return 8192 + (r >> 8) % (56 * 1024);
+        default: return 64 * 1024 + (r >> 8) % (448 * 1024); // büyük blok yolu
+    }
+}
+
+static void fuzz_heap_check_stats(const HeapSlot* slots)
+{
+    HeapStats st;
+    FUZZ_CHECK(heap_get_stats(&st), "heap_get_stats busy with no allocation in flight");
+
+    size_t live = 0;
+    for (size_t i = 0; i < FUZZ_SLOTS; i++) live += slots[i].ptr ? slots[i].size : 0;
+
+    FUZZ_CHECK(st.largest_free_block <= st.bytes_free, "largest free %zu > free %zu",
+               st.largest_free_block, st.bytes_free);
+    FUZZ_CHECK(st.free_node_count <= st.node_count, "free nodes %zu > nodes %zu",
+               st.free_node_count, st.node_count);
+    FUZZ_CHECK(st.bytes_in_use + st.large_bytes >= live, "in use %zu + large %zu < live %zu",
+               st.bytes_in_use, st.large_bytes, live);
+}
+
+static void fuzz_heap(size_t iters)
+{
+    HeapSlot* slots = calloc(FUZZ_SLOTS, sizeof(HeapSlot));
+    uint32_t next_tag = 1;
+
+    for (size_t it = 0; it < iters; it++)
+    {
+        uint32_t r = host_rand(&fuzz_seed);
+        HeapSlot* s = &slots[r % FUZZ_SLOTS];
+        uint32_t op = (r >> 12) % 10;
+
+        if (s->ptr)
+        {
+            FUZZ_CHECK(fuzz_verify(s->ptr, s->size, s->tag), "heap block %p (%zu bytes, tag %u) corrupted",
+                       s->ptr, s->size, s->tag);
+
+            if (op < 3 && s->align == 0)
+            {
+                // realloc: önek korunmalı
+                size_t size = fuzz_heap_size(host_rand(&fuzz_seed));
+                void* p = heap_realloc(s->ptr, size);
+                FUZZ_CHECK(p != NULL, "heap_realloc(%zu) failed", size);
+                if (!p) continue;
+                size_t keep = size < s->size ? size : s->size;
+                FUZZ_CHECK(fuzz_verify(p, keep, s->tag), "heap_realloc lost data (%zu -> %zu)", s->size, size);
+                s->ptr = p;
+                s->size = size;
+                s->tag = next_tag++;
+                fuzz_fill(p, size, s->tag);
+            }
+            else
+            {
+                heap_free(s->ptr);
+                s->ptr = NULL;
+            }
+            continue;
+        }
+
+        size_t size = fuzz_heap_size(host_rand(&fuzz_seed));
+        s->align = 0;
+        if (op < 2)
+        {
+            s->align = (size_t)16 << ((r >> 20) % 9); // 16 .. 4096
+            s->ptr = heap_aligned_alloc(s->align, size);
+            FUZZ_CHECK(!s->ptr || ((uintptr_t)s->ptr & (s->align - 1)) == 0,
+                       "heap_aligned_alloc(%zu) returned %p", s->align, s->ptr);
+        }
+        else if (op < 3)
+        {
+            s->ptr = heap_calloc(1, size);
+            if (s->ptr)
+            {
+                const uint8_t* b = (const uint8_t*)s->ptr;
+                size_t nonzero = 0;
+                for (size_t i = 0; i < size; i++) nonzero += b[i] != 0;
+                FUZZ_CHECK(nonzero == 0, "heap_calloc(%zu) returned %zu non-zero bytes", size, nonzero);
+            }
+        }
+        else
+        {
+            s->ptr = heap_alloc(size);
+        }
+
+        FUZZ_CHECK(s->ptr != NULL, "allocation of %zu bytes failed", size);
+        if (!s->ptr) continue;
+        FUZZ_CHECK(((uintptr_t)s->ptr & 15) == 0, "block %p is not 16-byte aligned", s->ptr);
+        s->size = size;
+        s->tag = next_tag++;
+        fuzz_fill(s->ptr, size, s->tag);
+
+        if (it % 4096 == 0) fuzz_heap_check_stats(slots);
+    }
+
+    for (size_t i = 0; i < FUZZ_SLOTS; i++)
+    {
+        if (!slots[i].ptr) continue;
+        FUZZ_CHECK(fuzz_verify(slots[i].ptr, slots[i].size, slots[i].tag), "heap block corrupted at teardown");
+        heap_free(slots[i].ptr);
+        slots[i].ptr = NULL;
+    }
+
+    HeapStats st;
+    heap_get_stats(&st);
+    FUZZ_CHECK(st.large_blocks == 0 && st.large_bytes == 0, "%zu large blocks (%zu bytes) leaked",
+               st.large_blocks, st.large_bytes);
+    printf("heap: %zu iterations ok, %zu regions, %zu free nodes, largest free %zu KiB\n",
+           iters, st.region_count, st.free_node_count, st.largest_free_block / 1024);
+    free(slots);
+}
+
+typedef struct PageSlot
+{
+    void* ptr;
+    size_t pages;
+    uint32_t order;   // exact değilse
+    uint8_t kind;     // 0 boş, 1 pages(order), 2 pcp(order), 3 exact(pages)
+    uint32_t tag;
+} PageSlot;
+
+static size_t fuzz_page_bytes(const PageSlot* s)
+{
+    return s->kind == 3 ? s->pages * PMM_PAGE_SIZE : (size_t)PMM_PAGE_SIZE << s->order;
+}
+
+static void fuzz_pmm(size_t iters)
+{
+    PageSlot* slots = calloc(FUZZ_SLOTS, sizeof(PageSlot));
+    uint32_t next_tag = 1;
+    PmmStats st;
+
+    pmm_pcp_drain_all();
+    pmm_get_stats(&st);
+    size_t baseline = st.free_pages;
+
+    for (size_t it = 0; it < iters; it++)
+    {
+        uint32_t r = host_rand(&fuzz_seed);
+        PageSlot* s = &slots[r % FUZZ_SLOTS];
+
+        if (s->kind)
+        {
+            // Desen tüm blok yerine ilk ve son sayfada tutulur; hız için yeterli
+            size_t bytes = fuzz_page_bytes(s);
+            uint8_t* last = (uint8_t*)s->ptr + bytes - PMM_PAGE_SIZE;
+            FUZZ_CHECK(fuzz_verify(s->ptr, PMM_PAGE_SIZE, s->tag) && fuzz_verify(last, PMM_PAGE_SIZE, s->tag),
+                       "pmm block %p (%zu bytes) corrupted", s->ptr, bytes);
+            if (s->kind == 1) pmm_free_pages(s->ptr, s->order);
+            else if (s->kind == 2) pmm_pcp_free(s->ptr, s->order);
+            else pmm_free_pages_exact(s->ptr, s->pages);
+            s->kind = 0;
+            s->ptr = NULL;
+            continue;
+        }
+
+        uint32_t op = (r >> 12) % 3;
+        if (op == 0)
+        {
+            s->order = (r >> 16) % 7;
+            s->ptr = pmm_alloc_pages(s->order);
+            s->kind = 1;
+        }
+        else if (op == 1)
+        {
+            s->order = (r >> 16) % (PMM_PCP_MAX_ORDER + 1);
+            s->ptr = pmm_pcp_alloc(s->order);
+            s->kind = 2;
+        }
+        else
+        {
+            s->pages = 1 + (r >> 16) % 64;
+            s->ptr = pmm_alloc_pages_exact(s->pages);
+            s->kind = 3;
+            s->order = 0;
+            while (((size_t)1 << s->order) < s->pages) s->order++;
+        }
+
+        if (!s->ptr)
+        {
+            s->kind = 0; // Bellek dolabilir; hata değil
+            continue;
+        }
+
+        size_t bytes = fuzz_page_bytes(s);
+        uintptr_t p = (uintptr_t)s->ptr;
+        FUZZ_CHECK((p & (((uintptr_t)PMM_PAGE_SIZE << s->order) - 1)) == 0,
+                   "pmm block %p not aligned to order %u", s->ptr, s->order);
+        FUZZ_CHECK(p >= host_phys_start() && p + bytes <= host_phys_end(),
+                   "pmm block %p (%zu bytes) outside physical memory", s->ptr, bytes);
+        s->tag = next_tag++;
+        fuzz_fill(s->ptr, PMM_PAGE_SIZE, s->tag);
+        fuzz_fill((uint8_t*)s->ptr + bytes - PMM_PAGE_SIZE, PMM_PAGE_SIZE, s->tag);
+
+        if (it % 4096 == 0)
+        {
+            // Boş + önbellekte + canlı sayfalar başlangıçtaki boş sayfaya eşit olmalı
+            size_t used = 0;
+            for (size_t i = 0; i < FUZZ_SLOTS; i++)
+                if (slots[i].kind) used += fuzz_page_bytes(&slots[i]) / PMM_PAGE_SIZE;
+            pmm_get_stats(&st);
+            FUZZ_CHECK(st.free_pages + st.cached_pages + used == baseline,
+                       "pmm accounting: free %zu + cached %zu + used %zu != %zu",
+                       st.free_pages, st.cached_pages, used, baseline);
+        }
+    }
+
+    for (size_t i = 0; i < FUZZ_SLOTS; i++)
+    {
+        PageSlot* s = &slots[i];
+        if (s->kind == 1) pmm_free_pages(s->ptr, s->order);
+        else if (s->kind == 2) pmm_pcp_free(s->ptr, s->order);
+        else if (s->kind == 3) pmm_free_pages_exact(s->ptr, s->pages);
+    }
+    pmm_pcp_drain_all();
+    pmm_get_stats(&st);
+    FUZZ_CHECK(st.free_pages == baseline, "pmm leaked %zd pages", (ssize_t)baseline - (ssize_t)st.free_pages);
+
+    // Her şey geri döndüyse buddy'ler yeniden birleşmiş olmalı
+    size_t small = 0;
+    for (uint32_t order = 0; order < 4; order++) small += st.free_blocks[order] << order;
+    printf("pmm: %zu iterations ok, %zu pages free, %zu pages in blocks below 64 KiB\n",
+           iters, st.free_pages, small);
+    free(slots);
+}
+
+static void fuzz_list(size_t iters)
+{
+    enum { MAX = 512 };
+    List* list = List_Create();
+    uintptr_t* shadow = calloc(MAX, sizeof(uintptr_t));
+    size_t count = 0;
+
+    for (size_t it = 0; it < iters; it++)
+    {
+        uint32_t r = host_rand(&fuzz_seed);
+        uintptr_t value = it + 1;
+        switch (r % 5)
+        {
+            case 0:
+            case 1:
+                if (count == MAX) break;
+                List_Add(list, (void*)value);
+                shadow[count++] = value;
+                break;
+            case 2:
+            {
+                if (count == MAX) break;
+                size_t at = (r >> 8) % (count + 1);
+                FUZZ_CHECK(List_InsertAt(list, at, (void*)value), "List_InsertAt(%zu) failed with %zu items", at, count);
+                memmove(&shadow[at + 1], &shadow[at], (count - at) * sizeof(uintptr_t));
+                shadow[at] = value;
+                count++;
+                break;
+            }
+            case 3:
+            {
+                if (count == 0) break;
+                size_t at = (r >> 8) % count;
+                FUZZ_CHECK(List_RemoveAt(list, at), "List_RemoveAt(%zu) failed with %zu items", at, count);
+                memmove(&shadow[at], &shadow[at + 1], (count - at - 1) * sizeof(uintptr_t));
+                count--;
+                break;
+            }
+            default:
+            {
+                if (count == 0) break;
+                size_t at = (r >> 8) % count;
+                FUZZ_CHECK(List_Remove(list, (void*)shadow[at]), "List_Remove of present item failed");
+                memmove(&shadow[at], &shadow[at + 1], (count - at - 1) * sizeof(uintptr_t));
+                count--;
+                break;
+            }
+        }
+
+        if (it % 1024 == 0)
+        {
+            FUZZ_CHECK(List_Size(list) == count, "List_Size %zu != %zu", List_Size(list), count);
+            size_t i = 0;
+            ListNode* last = NULL;
+            LIST_FOR_EACH(list, node)
+            {
+                FUZZ_CHECK(i < count && (uintptr_t)node->data == shadow[i], "list item %zu differs", i);
+                last = node;
+                i++;
+            }
+            FUZZ_CHECK(list->tail == last, "list tail does not point at the last node");
+        }
+    }
+
+    List_Destroy(list, false);
+    free(shadow);
+    printf("list: %zu iterations ok\n", iters);
+}
+
+int main(int argc, char** argv)
+{
+    size_t iters = argc > 1 ? strtoull(argv[1], NULL, 0) : 200000;
+    fuzz_seed = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 1;
+    if (fuzz_seed == 0) fuzz_seed = 1;
+
+    if (!host_shim_init(FUZZ_PHYS_MB, false)) return 1;
+
+    printf("AtomOS allocator fuzz: %zu iterations, seed %u\n", iters, fuzz_seed);
+    fuzz_pmm(iters);
+    fuzz_heap(iters);
+    fuzz_list(iters);
+
+    if (fuzz_failures)
+    {
+        printf("%zu invariant failures\n", fuzz_failures);
+        return 1;
+    }
+    printf("all invariants held\n");
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include <debug/debug.h>
+#include <efi/efi.h>
+#include <boot/multiboot2.h>
+#include <graphics/screen.h>
+#include <task/PeriodicTask.h>
+#include <memory/heap.h>
+#include <memory/pmm.h>
+
+// Linker script'in verdiği semboller: kernel imajı HOST_PHYS_BASE'de biter,
+// yerel heap penceresi kernel'deki gibi 8 MiB'tır.
+asm(".globl __kernel_start\n.set __kernel_start, 0x100000\n"
+    ".globl __kernel_end\n.set __kernel_end, 0x10000000\n"
+    ".globl __kernel_size\n.set __kernel_size, 0x0ff00000\n"
+    ".bss\n.balign 4096\n"
+    ".globl __local_heap_start\n__local_heap_start:\n.skip 0x800000\n"
+    ".globl __local_heap_end\n__local_heap_end:\n"
+    ".text\n");
+
+extern void pmm_init(void);
+
+uint64_t uptimeMs = 0;
+
+static bool shim_verbose = false;
+
+static void shim_printf(const char* format, ...)
+{
+    if (!shim_verbose) return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+static DebugStream shim_debug_stream = { .printf = shim_printf };
+DebugStream* debugStream = &shim_debug_stream;
+
+static void shim_assert(const char* condition, const char* file, int line, const char* message)
+{
+    fprintf(stderr, "ASSERT %s at %s:%d: %s\n", condition, file, line, message);
+    abort();
+}
+void (*___assert_func)(const char*, const char*, int, const char*) = shim_assert;
+
+// Multiboot2 / ekran durumu: yalnızca pmm_init'in okuduğu alanlar
+ScreenInfo main_screen;
+static ScreenVideoModeInfo shim_mode;
+struct multiboot_tag_mmap* mb2_mmap = NULL;
+struct multiboot_tag_efi_mmap* mb2_efi_mmap = NULL;
+struct multiboot_tag_module* mb2_module = NULL;
+bool mb2_is_efi_boot = false;
+uint32_t mb2_tagptr = 0;
+EFI_SYSTEM_TABLE* efi_system_table = NULL;
+
+static struct {
+    struct multiboot_tag_mmap tag;
+    struct multiboot_mmap_entry entries[2];
+} shim_mmap;
+
+static uintptr_t shim_phys_end = HOST_PHYS_BASE;
+
+// Tek çekirdek, kesme yok
+size_t arch_irq_save(void) { return 0; }
+void arch_irq_restore(size_t flags) { (void)flags; }
+uint32_t arch_cpu_index(void) { return 0; }
+
+PeriodicTask* periodic_task_create(const char* name, void (*taskFunction)(void* task, void* arg), void* arg, size_t intervalMs)
+{
+    (void)name; (void)taskFunction; (void)arg; (void)intervalMs;
+    return NULL;
+}
+void periodic_task_start(PeriodicTask* task) { (void)task; }
+
+// kernel/memory/memory.c'nin karşılıkları; çekirdek nesneleri bunları çağırır
+void* kernel_malloc(size_t size) { return heap_alloc(size); }
+void kernel_free(void* ptr) { heap_free(ptr); }
+void* kernel_realloc(void* ptr, size_t size) { return heap_realloc(ptr, size); }
+void* kernel_calloc(size_t count, size_t size) { return heap_calloc(count, size); }
+void* kernel_malloc_aligned(size_t alignment, size_t size) { return heap_aligned_alloc(alignment, size); }
+void kernel_memcpy(void* dest, const void* src, size_t n) { memcpy(dest, src, n); }
+void kernel_memset(void* ptr, char value, size_t num) { memset(ptr, value, num); }
+void kernel_memmove(void* dest, const void* src, size_t n) { memmove(dest, src, n); }
+int kernel_memcmp(const void* a, const void* b, size_t n) { return memcmp(a, b, n); }
+
+bool host_shim_init(size_t phys_mb, bool verbose)
+{
+    shim_verbose = verbose;
+
+    size_t bytes = phys_mb << 20;
+    void* mem = mmap((void*)HOST_PHYS_BASE, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (mem != (void*)HOST_PHYS_BASE)
+    {
+        fprintf(stderr, "host_shim: cannot map %zu MiB at %#lx\n", phys_mb, HOST_PHYS_BASE);
+        return false;
+    }
+    shim_phys_end = HOST_PHYS_BASE + bytes;
+
+    // 0..HOST_PHYS_BASE kernel imajı gibi ayrılmış; kalanı USABLE
+    shim_mmap.tag.type = MULTIBOOT_TAG_TYPE_MMAP;
+    shim_mmap.tag.size = sizeof(shim_mmap);
+    shim_mmap.tag.entry_size = sizeof(struct multiboot_mmap_entry);
+    shim_mmap.tag.entry_version = 0;
+    shim_mmap.entries[0].addr = 0;
+    shim_mmap.entries[0].len = HOST_PHYS_BASE;
+    shim_mmap.entries[0].type = MULTIBOOT_MEMORY_RESERVED;
+    shim_mmap.entries[1].addr = HOST_PHYS_BASE;
+    shim_mmap.entries[1].len = bytes;
+    shim_mmap.entries[1].type = MULTIBOOT_MEMORY_AVAILABLE;
+    mb2_mmap = &shim_mmap.tag;
+
+    main_screen.mode = &shim_mode;
+
+    heap_init();
+    pmm_init();
+    return true;
+}
+
+uintptr_t host_phys_start(void) { return HOST_PHYS_BASE; }
+uintptr_t host_phys_end(void) { return shim_phys_end; }
+
+double host_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+uint32_t host_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
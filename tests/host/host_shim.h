@@ -0,0 +1,27 @@
+#pragma once
+
+// Çekirdek bellek modüllerini (heap, slab, pmm, list, objpool) Linux üzerinde
+// çalıştırmak için ortam. Çekirdek nesneleri malloc/free/memcpy... isimleri
+// kernel_* olarak yeniden adlandırılıp derlenir (bkz. build-host.mk), böylece
+// host libc ile çakışmazlar.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// PMM'e verilen "fiziksel" bellek bu adrese sabit olarak eşlenir; çekirdekteki
+// gibi sanal == fiziksel olur ve __kernel_end buraya işaret eder.
+#define HOST_PHYS_BASE 0x10000000UL
+
+// phys_mb MiB'lık sahte bellek haritası kurar ve heap_init/pmm_init çağırır.
+// verbose false ise çekirdek LOG çıktısı bastırılır.
+bool host_shim_init(size_t phys_mb, bool verbose);
+
+// Sahte fiziksel bellek aralığı
+uintptr_t host_phys_start(void);
+uintptr_t host_phys_end(void);
+
+// Monoton saat, saniye
+double host_now(void);
+
+uint32_t host_rand(uint32_t* state);